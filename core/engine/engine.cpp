@@ -6,6 +6,12 @@
 
 #include <string.h>
 
+#if   (defined RT_WIN32) /* Win32, MSVC -------- for older versions --------- */
+
+#include <intrin.h>
+
+#endif /* ------------- OS specific ----------------------------------------- */
+
 #include "engine.h"
 #include "rtimag.h"
 
@@ -26,10 +32,10 @@
  * to the rendering backend once all data structures have been prepared.
  *
  * Update in turn consists of five phases:
- * 0.5 phase (sequential) - hierarchical update of arrays' transform matrices
+ * 0.5 phase (multi-tasked) - hierarchical update of arrays' transform matrices
  * 1st phase (multi-threaded) - update surfaces' transform matrices, data fields
  * 2nd phase (multi-threaded) - update surfaces' clip lists, bounds, tile lists
- * 2.5 phase (sequential) - hierarchical update of arrays' bounds from surfaces
+ * 2.5 phase (multi-tasked) - hierarchical update of array bounds from surfaces
  * 3rd phase (multi-threaded) - build updated cross-surface lists
  *
  * Some parts of the update are handled by the object hierarchy (object.cpp),
@@ -38,6 +44,25 @@
  *
  * Both update and render support multi-threading and use array of SceneThread
  * objects to separate working datasets and therefore avoid thread locking.
+ * Surfaces are split between threads in update phases 2 and 3 as contiguous
+ * runs of about the same cost, estimated from list lengths of the last frame.
+ * Screen tiling merges surfaces' tile lists into the tilebuffer in parallel,
+ * with each thread owning a band of tile rows (order within tiles is kept).
+ *
+ * Hierarchical phases 0.5 and 2.5 are split into disjoint subtrees (tasks)
+ * updated in parallel, while the part of the hierarchy above the tasks
+ * (as well as animators) is updated sequentially. Bounds of the task are
+ * only updated in parallel if its contributions stay within its subtree.
+ *
+ * Static frames can be cached (RT_OPTS_STATIC) by keeping per-frame lists
+ * across frames if nothing has changed in the hierarchy during phase 0.5,
+ * which makes update phases 1 through 3 (as well as screen tiling) free.
+ * Changes are not tracked per surface, any change rebuilds all lists, thus
+ * the cache is not a part of RT_OPTS_FULL and needs to be requested explicitly.
+ *
+ * Multiple scenes of the same platform can be rendered as a batch, where each
+ * scene is updated on the whole thread-pool in turn, while render of all scenes
+ * is done in a single run of the thread-pool without waiting between scenes.
  */
 
 /******************************************************************************/
@@ -505,6 +530,24 @@ rt_void render_scene(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
     }
 }
 
+/*
+ * Atomically add "val" to the counter at "ptr", return its previous value.
+ * Used to hand out bands of rows to threads when rows stealing is enabled.
+ */
+static
+rt_si32 fetch_add(volatile rt_si32 *ptr, rt_si32 val)
+{
+#if   (defined RT_WIN32) /* Win32, MSVC -------- for older versions --------- */
+
+    return _InterlockedExchangeAdd((volatile long *)ptr, val);
+
+#else /* --- Win64, GCC --- Linux, GCC -------------------------------------- */
+
+    return __sync_fetch_and_add(ptr, val);
+
+#endif /* ------------- OS specific ----------------------------------------- */
+}
+
 /*
  * Instantiate platform.
  * Can only be called from single (main) thread.
@@ -523,6 +566,19 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
     /* init scene list variables */
     head = tail = cur = RT_NULL;
 
+    /* init scene batch variables */
+    bat_arr = RT_NULL;
+    bat_num = 0;
+
+    /* init frame capture variables */
+    capt_tex = RT_NULL;
+    capt_str = RT_NULL;
+    capt_num = 0;
+    capt_max = 0;
+    capt_head = 0;
+    capt_tail = 0;
+    capt_buf = RT_NULL;
+
     /* allocate root SIMD structure */
     s_inf = (rt_SIMD_INFOX *)
             alloc(sizeof(rt_SIMD_INFOX),
@@ -565,9 +621,7 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
     this->thnum = thnum < 0 ? -thnum : thnum; /* always > 0 upon feedback */
 
     /* init tile dimensions */
-    tile_w = RT_MAX(RT_TILE_W, 1);
-    tile_h = RT_MAX(RT_TILE_H, 1);
-    tile_w = ((tile_w + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
+    set_tile(RT_TILE_W, RT_TILE_H);
 
     /* init rendering backend,
      * default SIMD runtime target will be chosen */
@@ -706,6 +760,104 @@ rt_si32 rt_Platform::get_tile_w()
     return tile_w;
 }
 
+/*
+ * Return tile height in pixels.
+ */
+rt_si32 rt_Platform::get_tile_h()
+{
+    return tile_h;
+}
+
+/*
+ * Set tile dimensions in pixels, width is rounded up to SIMD width,
+ * scenes update their tilebuffer's layout in the next frame.
+ */
+rt_void rt_Platform::set_tile(rt_si32 tile_w, rt_si32 tile_h)
+{
+    tile_w = RT_MAX(tile_w, 1);
+    tile_h = RT_MAX(tile_h, 1);
+    tile_w = ((tile_w + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
+
+    this->tile_w = tile_w;
+    this->tile_h = tile_h;
+}
+
+/*
+ * Candidate tile dimensions for autotuning (width, height),
+ * width is rounded up to SIMD width, thus some may coincide.
+ */
+static
+rt_si32 tl_tune[][2] =
+{
+    {  8,  8 },
+    { 16,  8 },
+    { 16, 16 },
+    { 32, 16 },
+    { 32, 32 },
+    { 64, 32 },
+};
+
+/*
+ * Select tile dimensions by timing given "scn" rendered at given "time"
+ * with each candidate, "f_time" returns current time in milliseconds.
+ */
+rt_void rt_Platform::tune_tile(rt_Scene *scn, rt_time time,
+                               rt_FUNC_TIME f_time)
+{
+    rt_si32 i, j, n = RT_ARR_SIZE(tl_tune);
+    rt_si32 last_w = 0, last_h = 0;
+    rt_si32 best_w = tile_w, best_h = tile_h;
+    rt_time best_t = -1;
+
+    /* start with current dimensions as a reference */
+    for (i = -1; i < n; i++)
+    {
+        if (i >= 0)
+        {
+            set_tile(tl_tune[i][0], tl_tune[i][1]);
+        }
+
+        /* skip candidates coinciding after rounding */
+        if (i >= 0 && ((tile_w == last_w && tile_h == last_h)
+        ||  (tile_w == best_w && tile_h == best_h)))
+        {
+            continue;
+        }
+
+        last_w = tile_w;
+        last_h = tile_h;
+
+        /* first frame also rebuilds lists for the new layout */
+        rt_time t = f_time();
+
+        for (j = 0; j < RT_TILE_TUNE_FRAMES; j++)
+        {
+            scn->render(time);
+        }
+
+        t = f_time() - t;
+
+        if (best_t < 0 || t < best_t)
+        {
+            best_t = t;
+            best_w = tile_w;
+            best_h = tile_h;
+        }
+    }
+
+    set_tile(best_w, best_h);
+
+    /* restart path-tracer's accumulation
+     * discarding samples of timed frames */
+    rt_si32 pton = scn->get_pton();
+
+    if (pton != 0)
+    {
+        scn->set_pton(0);
+        scn->set_pton(pton);
+    }
+}
+
 /*
  * Add given "scn" to platform's scene list.
  */
@@ -799,6 +951,361 @@ rt_void rt_Platform::next_scene()
     }
 }
 
+/*
+ * Update and render given array of "num" scenes "scn" for a given "time",
+ * scenes are updated one after another using the whole thread-pool,
+ * then rendered together in a single run of the thread-pool
+ * with each thread going through the rows of all scenes in turn.
+ */
+rt_void rt_Platform::render_batch(rt_Scene **scn, rt_si32 num, rt_time time)
+{
+    rt_Scene *cur = this->cur;
+    rt_si32 i, n = 0;
+
+    for (i = 0; i < num; i++)
+    {
+        if (scn[i]->pfm != this)
+        {
+            throw rt_Exception("scene in the batch is from another platform");
+        }
+    }
+
+    /* update scenes, each scene becomes current
+     * for its own multi-threaded update */
+    for (i = 0; i < num; i++)
+    {
+        this->cur = scn[i];
+
+        scn[i]->render_init(time);
+
+        /* checkerboard history isn't kept in batch render */
+        scn[i]->cb_val = RT_FALSE;
+
+        /* reset rows stealing counter,
+         * not used if rows are interleaved */
+        scn[i]->rband = 0;
+        scn[i]->bat_on = 0;
+
+#if RT_OPTS_RENDER_EXT0 != 0
+        if ((scn[i]->opts & RT_OPTS_RENDER_EXT0) != 0)
+        {
+            continue;
+        }
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+#if RT_OPTS_THREAD != 0
+        if ((scn[i]->opts & RT_OPTS_THREAD) != 0 && !g_print
+#if RT_OPTS_RENDER_EXT1 != 0
+        &&  (scn[i]->opts & RT_OPTS_RENDER_EXT1) == 0
+#endif /* RT_OPTS_RENDER_EXT1 */
+           )
+        {
+            scn[i]->bat_on = 1;
+            n++;
+        }
+        else
+#endif /* RT_OPTS_THREAD */
+        {
+            render_scene(scn[i], -scn[i]->thnum, 1);
+        }
+    }
+
+    /* render scenes tasked to the pool
+     * together in a single run */
+    if (n > 0)
+    {
+        bat_arr = scn;
+        bat_num = num;
+
+        this->cur = scn[0];
+        this->f_render(tdata, thnum, 2);
+
+        bat_arr = RT_NULL;
+        bat_num = 0;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+#if RT_OPTS_RENDER_EXT0 != 0
+        if ((scn[i]->opts & RT_OPTS_RENDER_EXT0) == 0)
+#endif /* RT_OPTS_RENDER_EXT0 */
+        {
+            scn[i]->pts_c = scn[i]->tharr[0]->s_inf->pts_c[0];
+        }
+
+        scn[i]->bat_on = 0;
+        scn[i]->render_done();
+    }
+
+    this->cur = cur;
+}
+
+/*
+ * Render frame of scene "scn" updated in the previous call, while updating
+ * the scene for a given "time" to be rendered in the next call (the first
+ * call only updates). Per-frame state (pools with lists, SIMD structures,
+ * tilebuffer and camera) is double-buffered within the scene, so that
+ * bands of rows of the pending frame are tasked to the pool's threads as
+ * they finish their slices of each update run, the rest of the bands is
+ * rendered in a separate run once the update is done.
+ * Frames keeping state across frames or taking extra passes (path-tracer,
+ * checkerboard, variable-rate, adaptive antialiasing, regions of interest,
+ * heatmap, timers), printed frames and extended update/render options
+ * are rendered in place as in "render", dropping the pending frame.
+ */
+rt_void rt_Platform::render_pipe(rt_Scene *scn, rt_time time)
+{
+    rt_Scene *cur = this->cur;
+    rt_si32 i, k;
+
+    if (scn->pfm != this)
+    {
+        throw rt_Exception("scene in the pipeline is from another platform");
+    }
+
+    this->cur = scn;
+
+    if (scn->pt_on || scn->cb_on || scn->vr_on || scn->ad_on || scn->hm_on
+    ||  scn->rects_num != 0 || scn->tmr_num > 0 || g_print
+#if RT_OPTS_UPDATE_EXT0 != 0
+    ||  (scn->opts & RT_OPTS_UPDATE_EXT0) != 0
+#endif /* RT_OPTS_UPDATE_EXT0 */
+#if RT_OPTS_RENDER_EXT0 != 0
+    ||  (scn->opts & RT_OPTS_RENDER_EXT0) != 0
+#endif /* RT_OPTS_RENDER_EXT0 */
+       )
+    {
+        scn->render(time);
+
+        this->cur = cur;
+
+        return;
+    }
+
+    /* pending frame's lists and SIMD structures
+     * are bound to the SIMD target, AA mode
+     * and tile layout of their update */
+    if (scn->pip_val && (scn->pip_smd != simd || scn->fsaa != fsaa
+    ||  scn->tile_w != tile_w || scn->tile_h != tile_h))
+    {
+        scn->reset_pipe();
+    }
+
+    /* abandon progressive frame in progress */
+    if (scn->pstate != 0)
+    {
+        scn->pstate = 0;
+        scn->render_done();
+    }
+
+    /* release lists retained from previous frame
+     * before persistent allocs (if any) below */
+    if (scn->pending)
+    {
+        scn->pending = 0;
+
+        for (i = 0; i < scn->thnum; i++)
+        {
+            scn->tharr[i]->release(scn->tharr[i]->mpool);
+        }
+
+        scn->release(scn->mpool);
+    }
+
+    if (scn->tile_w != tile_w || scn->tile_h != tile_h)
+    {
+        scn->reset_tiles();
+    }
+
+    /* grow pending frame's tilebuffer
+     * along with the scene's own */
+    if (scn->pip_max < scn->tiles_max)
+    {
+        scn->pip_max = scn->tiles_max;
+
+        scn->pip_tls = (rt_ELEM **)
+                scn->alloc(scn->pip_max * sizeof(rt_ELEM *), RT_ALIGN);
+    }
+
+    /* keep SIMD structures of the pending frame
+     * intact while the scene is updated */
+    scn->swap_simd();
+
+    /* reset rows stealing counters,
+     * always used in pipelined render */
+    scn->rband = 0;
+    scn->pip_cnt = 0;
+
+    for (i = 0; i < scn->thnum; i++)
+    {
+        scn->tharr[i]->pip_end = 0;
+    }
+
+    if (scn->pip_val)
+    {
+        scn->reset_stats();
+
+        /* render bands are tasked to the pool
+         * only if the scene is updated by it */
+#if RT_OPTS_THREAD != 0
+        if ((scn->opts & RT_OPTS_THREAD) != 0
+#if RT_OPTS_RENDER_EXT1 != 0
+        &&  (scn->opts & RT_OPTS_RENDER_EXT1) == 0
+#endif /* RT_OPTS_RENDER_EXT1 */
+           )
+        {
+            scn->pip_run = RT_TRUE;
+        }
+#endif /* RT_OPTS_THREAD */
+    }
+
+    /* update next frame in its own pools,
+     * render bands are taken in its update runs */
+    k = scn->pip_par;
+
+    scn->pip_act = RT_TRUE;
+
+    scn->swap_pools(k);
+    scn->render_init(time);
+    scn->swap_pools(k);
+
+    for (i = 0; i < scn->thnum; i++)
+    {
+        scn->tharr[i]->pip_end = 0;
+    }
+
+    if (scn->pip_val)
+    {
+        /* render the rest of the bands */
+        if (scn->pip_run)
+        {
+            this->f_render(tdata, thnum, 11);
+        }
+        else
+        {
+            render_scene(scn, -scn->thnum, 11);
+        }
+
+        scn->pip_run = RT_FALSE;
+
+        scn->pts_c = scn->tharr[0]->s_inf->pts_c[0];
+
+        /* release pending frame's pools */
+        scn->swap_pools(k ^ 1);
+        scn->render_done();
+        scn->swap_pools(k ^ 1);
+    }
+
+    scn->pip_act = RT_FALSE;
+
+    /* updated frame becomes pending,
+     * its tilebuffer and camera are kept
+     * apart from the next frame's update */
+    rt_ELEM **tls = scn->tiles;
+    scn->tiles = scn->pip_tls;
+    scn->pip_tls = tls;
+
+    scn->pip_lst = scn->clist;
+
+    RT_VEC3_SET(scn->pip_pos, scn->pos);
+    RT_VEC3_SET(scn->pip_dir, scn->dir);
+    RT_VEC3_SET(scn->pip_hor, scn->hor);
+    RT_VEC3_SET(scn->pip_ver, scn->ver);
+    RT_VEC3_SET(scn->pip_amb, scn->amb);
+    scn->pip_amb[RT_A] = scn->amb[RT_A];
+
+    scn->pip_pov = scn->cam->pov;
+    scn->pip_smd = simd;
+
+    scn->pip_val = RT_TRUE;
+    scn->pip_par = k ^ 1;
+
+    this->cur = cur;
+}
+
+/*
+ * Allocate ring of "num" frames of up to "x_res" by "y_res" pixels
+ * captured by scenes for platform's I/O thread, buffers are allocated
+ * once, so that capture doesn't allocate memory while rendering.
+ * Return number of frames in the ring.
+ */
+rt_si32 rt_Platform::set_capt(rt_si32 num, rt_si32 x_res, rt_si32 y_res)
+{
+    rt_si32 i, n = x_res * y_res;
+
+    if (capt_num != 0)
+    {
+        throw rt_Exception("capture ring is already set in platform");
+    }
+
+    if (num <= 0 || x_res <= 0 || y_res <= 0)
+    {
+        throw rt_Exception("capture ring's dimensions are out of range");
+    }
+
+    rt_TEX tex;
+    tex.tex_num = x_res;
+    tex.x_dim = +x_res;
+    tex.y_dim = -y_res;
+
+    capt_tex = (rt_TEX *)alloc(num * sizeof(rt_TEX), RT_ALIGN);
+    capt_str = (rt_char *)alloc(num * (strlen(RT_PATH_DUMP) + RT_CAPT_NAME),
+                                                                        0);
+    capt_buf = alloc(pack_image(&tex, RT_NULL), RT_ALIGN);
+
+    memset(capt_tex, 0, num * sizeof(rt_TEX));
+
+    for (i = 0; i < num; i++)
+    {
+        capt_tex[i].ptex = alloc(n * sizeof(rt_ui32), RT_SIMD_ALIGN);
+    }
+
+    capt_max = n;
+    capt_num = num;
+
+    return capt_num;
+}
+
+/*
+ * Return number of frames in the capture ring yet to be written.
+ */
+rt_si32 rt_Platform::get_capt()
+{
+    return capt_head - capt_tail;
+}
+
+/*
+ * Write the oldest frame in the capture ring to file,
+ * called from platform's I/O thread while scenes capture new frames.
+ * Return number of frames left in the ring, -1 if it was empty.
+ */
+rt_si32 rt_Platform::write_capt()
+{
+    rt_si32 k = capt_tail, n = capt_num;
+
+    /* frame's contents are complete once it's counted */
+    if (n == 0 || fetch_add(&capt_head, 0) == k)
+    {
+        return -1;
+    }
+
+    rt_TEX *tx = &capt_tex[k % n];
+    rt_pstr name = capt_str + (k % n) * (strlen(RT_PATH_DUMP) + RT_CAPT_NAME);
+
+    /* pack the whole image for a single write */
+    rt_size size = pack_image(tx, capt_buf);
+
+    if (dump_image(name, capt_buf, size) == 0)
+    {
+        RT_LOGE("Failed to save captured image %s\n", name);
+    }
+
+    /* frame's slot is reused once it's counted */
+    fetch_add(&capt_tail, 1);
+
+    return capt_head - capt_tail;
+}
+
 /*
  * Deinitialize platform.
  */
@@ -863,8 +1370,8 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     s_inf->frame   = scene->frame;
 
     /* init tilebuffer's dimensions and pointer */
-    s_inf->tile_w  = scene->pfm->tile_w;
-    s_inf->tile_h  = scene->pfm->tile_h;
+    s_inf->tile_w  = scene->tile_w;
+    s_inf->tile_h  = scene->tile_h;
     s_inf->tls_row = scene->tiles_in_row;
     s_inf->tiles   = scene->tiles;
 
@@ -935,6 +1442,15 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
 
     memset(s_cam, 0, sizeof(rt_SIMD_CAMERA));
 
+    /* allocate flt SIMD structure */
+    s_flt = (rt_SIMD_FILTER *)
+            alloc(sizeof(rt_SIMD_FILTER),
+                            RT_SIMD_ALIGN);
+
+    memset(s_flt, 0, sizeof(rt_SIMD_FILTER));
+
+    s_inf->flt = s_flt;
+
     /* allocate ctx SIMD structure */
     s_ctx = (rt_SIMD_CONTEXT *)
             alloc(sizeof(rt_SIMD_CONTEXT) + /* +1 context step for shadows */
@@ -947,10 +1463,20 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     mpool = RT_NULL;
     /* estimates are done in Scene once all counters have been initialized */
     msize = 0;
+    mused = 0;
+    mpeak = 0;
 
-    /* allocate misc arrays for tiling */
-    txmin = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
-    txmax = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
+    pip_end = 0;
+    pip_chn[0] = pip_chn[1] = RT_NULL;
+    pip_mpl[0] = pip_mpl[1] = RT_NULL;
+
+    bp_cur = 0;
+
+    /* allocate misc arrays for tiling,
+     * sized for tiles of 1 pixel height
+     * as tile dimensions may change */
+    txmin = (rt_si32 *)alloc(sizeof(rt_si32) * scene->y_res, RT_ALIGN);
+    txmax = (rt_si32 *)alloc(sizeof(rt_si32) * scene->y_res, RT_ALIGN);
     verts = (rt_VERT *)alloc(sizeof(rt_VERT) * 
                              (2 * RT_VERTS_LIMIT + RT_EDGES_LIMIT), RT_ALIGN);
 }
@@ -2004,6 +2530,7 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
     rt_real dot;
     rt_si32 ndx[2];
     rt_real tag[2], zed[2];
+    rt_real dmin = RT_INF;
 
     /* "verts_num" may grow, use "srf->verts_num" if original is needed */
     rt_si32 verts_num = srf->bvbox->verts_num;
@@ -2028,6 +2555,8 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
 
             dot = RT_VEC3_DOT(vec, scene->nrm);
 
+            dmin = RT_MIN(dmin, dot);
+
             verts[k].pos[RT_Z] = dot;
             verts[k].pos[RT_W] = -1.0f; /* tag: behind screen plane */
 
@@ -2124,9 +2653,15 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
                 tiling(verts[i].pos, verts[j].pos); 
             }
         }
+
+        /* nearest bbox depth as primary ray's parameter,
+         * screen plane (at "org") is at the distance of "pov" */
+        srf->tmin = (dmin + scene->cam->pov) / scene->cam->pov;
     }
     else
     {
+        srf->tmin = -RT_INF;
+
         /* mark all tiles in the entire tilbuffer */
         for (i = 0; i < scene->tiles_in_col; i++)
         {
@@ -2136,20 +2671,40 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
     }
 
     rt_ELEM **ptr = RT_GET_ADR(srf->tls);
+    rt_si32 *spn = scene->spans, n = 0, m = 1, jmin, jmax;
 
-    /* fill marked tiles with surface data */
+    /* fill marked tiles with surface data,
+     * only within spans of regions of interest (if any) */
     for (i = 0; i < scene->tiles_in_col; i++)
     {
-        for (j = txmin[i]; j <= txmax[i]; j++)
+        if (scene->rects_num != 0)
         {
-            /* alloc new element for each tile of "srf" */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = i << 16 | j;
-            elm->simd = srf->s_srf;
-            elm->temp = srf->bvbox;
-            /* insert element as list's tail */
-           *ptr = elm;
-            ptr = &elm->next;
+            n = scene->srows[i];
+            m = scene->srows[i + 1];
+        }
+
+        for (k = n; k < m; k++)
+        {
+            jmin = txmin[i];
+            jmax = txmax[i];
+
+            if (scene->rects_num != 0)
+            {
+                jmin = RT_MAX(jmin, spn[k * 3 + 1]);
+                jmax = RT_MIN(jmax, spn[k * 3 + 2]);
+            }
+
+            for (j = jmin; j <= jmax; j++)
+            {
+                /* alloc new element for each tile of "srf" */
+                elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                elm->data = i << 16 | j;
+                elm->simd = srf->s_srf;
+                elm->temp = srf->bvbox;
+                /* insert element as list's tail */
+               *ptr = elm;
+                ptr = &elm->next;
+            }
         }
     }
 
@@ -2157,7 +2712,127 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
 }
 
 /*
- * Build surface list for a given object "obj".
+ * Split surface's tile list into bands of tile rows (one band per thread),
+ * retaining elements order within each band.
+ */
+rt_void rt_SceneThread::sband(rt_Surface *srf)
+{
+    rt_si32 thnum = scene->thnum;
+    rt_ELEM **ptr = srf->tlb, **end = srf->tlb + thnum;
+
+    if (thnum == 1)
+    {
+        ptr[0] = srf->tls;
+        return;
+    }
+
+    rt_si32 k;
+
+    for (k = 0; k < thnum; k++)
+    {
+        ptr[k] = RT_NULL;
+        end[k] = RT_NULL;
+    }
+
+    rt_ELEM *tls, *nxt;
+
+    for (tls = srf->tls; tls != RT_NULL; tls = nxt)
+    {
+        k = ((rt_word)tls->data >> 16) * thnum / scene->tiles_in_col;
+
+        nxt = tls->next;
+
+        /* insert element as band's tail */
+        tls->next = RT_NULL;
+
+        if (end[k] != RT_NULL)
+        {
+            end[k]->next = tls;
+        }
+        else
+        {
+            ptr[k] = tls;
+        }
+
+        end[k] = tls;
+    }
+}
+
+/*
+ * Merge given tile list "tls" of surface "srf" into scene's tilebuffer,
+ * trnode elements are allocated in thread's memory pool.
+ */
+rt_void rt_SceneThread::smerge(rt_Surface *srf, rt_ELEM *tls)
+{
+    rt_si32 i, j, tline;
+    rt_ELEM **tiles = scene->tiles, *nxt, *trn;
+
+    if (srf->trnode != RT_NULL && srf->trnode != srf)
+    {
+        for (; tls != RT_NULL; tls = nxt)
+        {
+            i = (rt_word)tls->data >> 16;
+            j = (rt_word)tls->data & 0xFFFF;
+
+            nxt = tls->next;
+
+            tls->data = 0;
+
+            tline = i * scene->tiles_in_row;
+
+            /* check matching existing trnode for insertion,
+             * only tile list's head needs to be checked as elements
+             * grouping for cached transform is retained from "clist" */
+            trn = tiles[tline + j];
+
+            rt_Array *arr = (rt_Array *)srf->trnode;
+            rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+
+            if (trn != RT_NULL && trn->temp == trb)
+            {
+                /* insert element under existing trnode */
+                tls->next = trn->next;
+                trn->next = tls;
+            }
+            else
+            {
+                /* insert element as list's head */
+                tls->next = tiles[tline + j];
+                tiles[tline + j] = tls;
+
+                /* alloc new trnode element as none has been found */
+                trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                trn->data = (rt_cell)tls; /* trnode's last element */
+                trn->simd = arr->s_srf;
+                trn->temp = trb;
+                /* insert element as list's head */
+                trn->next = tiles[tline + j];
+                tiles[tline + j] = trn;
+            }
+        }
+    }
+    else
+    {
+        for (; tls != RT_NULL; tls = nxt)
+        {
+            i = (rt_word)tls->data >> 16;
+            j = (rt_word)tls->data & 0xFFFF;
+
+            nxt = tls->next;
+
+            tls->data = 0;
+
+            tline = i * scene->tiles_in_row;
+
+            /* insert element as list's head */
+            tls->next = tiles[tline + j];
+            tiles[tline + j] = tls;
+        }
+    }
+}
+
+/*
+ * Build surface list for a given object "obj".
  * Surface objects have separate surface lists for each side.
  */
 rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
@@ -2585,9 +3260,22 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
         rt_ELEM *elm, *cur = RT_NULL, *prv = RT_NULL;
         rt_ELEM *cuo, *cui, *pro = RT_NULL, *pri = RT_NULL;
 
+        /* broad-phase box enclosing all segments from the surface
+         * to the light, nodes outside can't cast shadow on the surface,
+         * only candidates within the box are linked for traversal below,
+         * all nodes are traversed if the box is unbounded */
+        rt_vec4 bmin, bmax;
+        rt_si32 b = bbox_hull(lgt->bvbox, srf->bvbox, bmin, bmax);
+
+        rt_si32 e = b ? bnear(bmin, bmax) : scene->bp_fch[scene->bp_num];
+        rt_si32 *nxt = b ? bp_nxt : scene->bp_nxt;
+        rt_si32 *fch = b ? bp_fch : scene->bp_fch;
+
         /* hierarchical traversal across nodes */
-        for (elm = scene->hlist; elm != RT_NULL;)
+        while (e >= 0)
         {
+            elm = scene->bp_elm[e];
+
             rt_BOUND *box = (rt_BOUND *)elm->temp;
 
             /* only call "bbox_shad" if all arrays above in the hierarchy
@@ -2632,7 +3320,7 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
 
                 /* if array's bbox is only seen from one side of the surface
                  * so are all of array's contents, thus skip "bbox_side" call */
-                if (RT_IS_ARRAY(box) && c != 0 && s
+                if (RT_IS_ARRAY(box) && c != 0 && s && fch[e] >= 0
                 && (cuo != RT_NULL || cui != RT_NULL))
                 {
                     /* set array for skipping "bbox_side" call above */
@@ -2653,11 +3341,11 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                     }
 
                     prv = elm;
-                    elm = RT_GET_PTR(elm->simd);
+                    e = fch[e];
                 }
                 else
                 {
-                    while (elm != RT_NULL && elm->next == RT_NULL)
+                    while (e >= 0 && nxt[e] < 0)
                     {
                         if ((cur == RT_NULL || c & 2) && pso != RT_NULL)
                         {
@@ -2674,17 +3362,17 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                                   RT_GET_ADR((*pti)->data);
                         }
 
-                        elm = RT_GET_PTR(elm->data);
+                        e = scene->bp_par[e];
 
-                        if (elm == cur)
+                        if (e >= 0 && scene->bp_elm[e] == cur)
                         {
                             cur = RT_NULL;
                         }
                     }
 
-                    if (elm != RT_NULL)
+                    if (e >= 0)
                     {
-                        elm = elm->next;
+                        e = nxt[e];
                     }
 
                     prv = RT_NULL;
@@ -2702,26 +3390,26 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                     }
                 }
 
-                if (RT_IS_ARRAY(box) && cur != RT_NULL && s)
+                if (RT_IS_ARRAY(box) && cur != RT_NULL && s && fch[e] >= 0)
                 {
                     prv = cur;
                     psr = RT_GET_ADR(cur->simd);
-                    elm = RT_GET_PTR(elm->simd);
+                    e = fch[e];
                 }
                 else
                 {
-                    while (elm != RT_NULL && elm->next == RT_NULL)
+                    while (e >= 0 && nxt[e] < 0)
                     {
                         prv = prv != RT_NULL ? RT_GET_PTR(prv->data) :
                               RT_NULL;
                         psr = prv != RT_NULL ? RT_GET_ADR(prv->simd) :
                               RT_GET_ADR((*ptr)->data);
-                        elm = RT_GET_PTR(elm->data);
+                        e = scene->bp_par[e];
                     }
 
-                    if (elm != RT_NULL)
+                    if (e >= 0)
                     {
-                        elm = elm->next;
+                        e = nxt[e];
                     }
                 }
             }
@@ -2782,545 +3470,851 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
 }
 
 /*
- * Deinitialize scene thread.
+ * Sort array "arr" of "num" indices by their keys "key" in ascending order
+ * (by indices themselves if "key" is NULL) using temporary array "tmp",
+ * merge sort is stable, thus indices with equal keys retain their order.
  */
-rt_SceneThread::~rt_SceneThread()
+static
+rt_void isort(rt_si32 *arr, rt_si32 *tmp, rt_si32 num, rt_real *key)
 {
-    ASM_DONE(s_inf)
-}
+    if (num < 2)
+    {
+        return;
+    }
 
-/******************************************************************************/
-/**********************************   SCENE   *********************************/
-/******************************************************************************/
+    rt_si32 h = num / 2, i = 0, j = h, k = 0;
 
-/*
- * Allocate scene in custom heap.
- * Heap "hp" must be the same object as platform "pfm" in constructor.
- */
-rt_pntr rt_Scene::operator new(size_t size, rt_Heap *hp)
-{
-    return hp->obj_alloc(size, RT_ALIGN);
-}
+    isort(arr, tmp, h, key);
+    isort(arr + h, tmp, num - h, key);
 
-/*
- * Delete scene from custom heap.
- */
-rt_void rt_Scene::operator delete(rt_pntr ptr)
-{
-    ((rt_Scene *)ptr)->pfm->obj_free(ptr);
+    /* merge sorted halves */
+    while (i < h && j < num)
+    {
+        if (key != RT_NULL ? key[arr[i]] <= key[arr[j]] : arr[i] <= arr[j])
+        {
+            tmp[k++] = arr[i++];
+        }
+        else
+        {
+            tmp[k++] = arr[j++];
+        }
+    }
+    while (i < h)
+    {
+        tmp[k++] = arr[i++];
+    }
+
+    memcpy(arr, tmp, k * sizeof(rt_si32));
 }
 
 /*
- * Instantiate scene.
- * Can only be called from single (main) thread.
- * Platform "pfm" must be the same object as heap "hp" in custom "new".
+ * Build broad-phase for shadow lists from global "hlist", its elements
+ * are indexed in pre-order to be traversed via indices, bounded elements
+ * are sorted by lower bounds of their spheres along the axis with
+ * the largest spread of centers (sweep-and-prune), elements much larger
+ * than average (or unbounded) are kept apart and checked in every query.
  */
-rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
-                   rt_si32 x_res, rt_si32 y_res, rt_si32 x_row, rt_ui32 *frame,
-                   rt_Platform *pfm) :
-
-    rt_Registry(pfm->f_alloc, pfm->f_free),
-    rt_List<rt_Scene>(RT_NULL)
+rt_void rt_SceneThread::bsort()
 {
-    this->pfm = pfm;
-
-    pfm->add_scene(this);
-
-    thnum = pfm->thnum;
-    tdata = pfm->tdata;
+    rt_ELEM *elm;
+    rt_BOUND *box;
+    rt_si32 i, k, n, p;
 
-    thr_num = thnum; /* for registry of object hierarchy */
+    /* count elements of the hierarchy */
+    for (n = 0, elm = scene->hlist; elm != RT_NULL; n++)
+    {
+        if (RT_IS_ARRAY((rt_BOUND *)elm->temp)
+        &&  RT_GET_PTR(elm->simd) != RT_NULL)
+        {
+            elm = RT_GET_PTR(elm->simd);
+            continue;
+        }
+        while (elm != RT_NULL && elm->next == RT_NULL)
+        {
+            elm = RT_GET_PTR(elm->data);
+        }
+        if (elm != RT_NULL)
+        {
+            elm = elm->next;
+        }
+    }
 
-    f_update = pfm->f_update;
-    f_render = pfm->f_render;
+    scene->bp_num = n;
+    scene->bp_elm = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * n, RT_ALIGN);
+    scene->bp_par = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    scene->bp_nxt = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    scene->bp_fch = (rt_si32 *)alloc(sizeof(rt_si32) * (n + 1), RT_ALIGN);
+    scene->bp_srt = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    scene->bp_key = (rt_real *)alloc(sizeof(rt_real) * n, RT_ALIGN);
+    scene->bp_big = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
 
-    this->scn = scn;
+    rt_si32 *lst = (rt_si32 *)alloc(sizeof(rt_si32) * (n + 1), RT_ALIGN);
+    rt_real *key = (rt_real *)alloc(sizeof(rt_real) * n, RT_ALIGN);
 
-    /* check for locked scene data, not thread safe! (it's ok, not a bug) */
-    if (scn->lock != RT_NULL)
+    /* index elements in pre-order, parents
+     * of top level elements are set to -1 */
+    for (i = 0, p = -1, elm = scene->hlist; elm != RT_NULL; i++)
     {
-        throw rt_Exception("scene data is locked by another instance");
+        scene->bp_elm[i] = elm;
+        scene->bp_par[i] = p;
+
+        if (RT_IS_ARRAY((rt_BOUND *)elm->temp)
+        &&  RT_GET_PTR(elm->simd) != RT_NULL)
+        {
+            p = i;
+            elm = RT_GET_PTR(elm->simd);
+            continue;
+        }
+        while (elm != RT_NULL && elm->next == RT_NULL)
+        {
+            elm = RT_GET_PTR(elm->data);
+            p = p >= 0 ? scene->bp_par[p] : -1;
+        }
+        if (elm != RT_NULL)
+        {
+            elm = elm->next;
+        }
     }
 
-    /* "x_row", frame's stride (in 32-bit pixels, not bytes!),
-     * can be greater than "x_res", in which case the frame
-     * occupies only a portion (rectangle) of the framebuffer,
-     * or negative, in which case frame starts at the last line
-     * and consecutive lines are located backwards in memory,
-     * "x_row" must contain the whole number of SIMD widths */
-    if (x_res == 0 || y_res == 0 || RT_ABS32(x_row) < x_res)
+    /* link next siblings and first children */
+    for (i = 0; i <= n; i++)
     {
-        throw rt_Exception("frambuffer's dimensions are not valid");
+        lst[i] = -1;
+        scene->bp_fch[i] = -1;
     }
+    for (i = 0; i < n; i++)
+    {
+        p = scene->bp_par[i] >= 0 ? scene->bp_par[i] : n;
 
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    /* always reallocate frame in custom heap for 64-bit
-     * if 32-bit address range is enabled in makefiles */
-    frame = RT_NULL;
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
+        if (lst[p] < 0)
+        {
+            scene->bp_fch[p] = i;
+        }
+        else
+        {
+            scene->bp_nxt[lst[p]] = i;
+        }
 
-    if (((rt_word)frame & (RT_SIMD_ALIGN - 1)) != 0 || frame == RT_NULL
-    || (RT_ABS32(x_row) & (RT_SIMD_WIDTH - 1)) != 0)
-    {
-        rt_si32 y_sgn = RT_SIGN(x_row);
+        lst[p] = i;
+        scene->bp_nxt[i] = -1;
+    }
 
-        x_row = RT_ABS32(x_row);
-        x_row = ((x_row + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
+    /* average size and spread of centers of bounded elements */
+    rt_vec4 cmin, cmax;
+    RT_VEC3_SET_VAL1(cmin, +RT_INF);
+    RT_VEC3_SET_VAL1(cmax, -RT_INF);
 
-        frame = (rt_ui32 *)
-                alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
+    rt_real avg = 0.0f;
 
-        x_row *= y_sgn;
+    for (i = 0, k = 0; i < n; i++)
+    {
+        box = (rt_BOUND *)scene->bp_elm[i]->temp;
 
-        if (x_row < 0)
+        if (box->rad == RT_INF)
         {
-            frame += RT_ABS32(x_row) * (y_res - 1);
+            continue;
         }
-    }
-
-    memset(frame, 0, x_row * y_res * sizeof(rt_ui32));
 
-    /* init framebuffer's dimensions and pointer */
-    this->x_res = x_res;
-    this->y_res = y_res;
-    this->x_row = x_row;
-    this->frame = frame;
+        RT_VEC3_MIN(cmin, cmin, box->mid);
+        RT_VEC3_MAX(cmax, cmax, box->mid);
 
-    /* init tilebuffer's dimensions and pointer */
-    tiles_in_row = (x_res + pfm->tile_w - 1) / pfm->tile_w;
-    tiles_in_col = (y_res + pfm->tile_h - 1) / pfm->tile_h;
+        avg += box->rad;
+        k++;
+    }
 
-    tiles = (rt_ELEM **)
-            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ELEM *), RT_ALIGN);
+    avg = k > 0 ? avg / k : 0.0f;
 
-    memset(tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+    rt_si32 a = 0;
 
-    /* init pixel-width, aspect-ratio, ray-depth */
-    factor = 1.0f / (rt_real)x_res;
-    aspect = (rt_real)y_res * factor;
-    depth = RT_MAX(RT_STACK_DEPTH, 0);
-    opts &= ~scn->opts;
+    for (i = 1; i < 3 && k > 0; i++)
+    {
+        a = cmax[i] - cmin[i] > cmax[a] - cmin[a] ? i : a;
+    }
 
-    pseed = RT_NULL;
-    ptr_r = RT_NULL;
-    ptr_g = RT_NULL;
-    ptr_b = RT_NULL;
+    scene->bp_axs = a;
+    scene->bp_ext = 0.0f;
+    scene->bp_snm = 0;
+    scene->bp_bnm = 0;
 
-    if ((opts & RT_OPTS_PT) == 0 || (opts & RT_OPTS_BUFFERS) == 0)
+    /* split elements into sorted and larger ones */
+    for (i = 0; i < n; i++)
     {
-        /* alloc framebuffer's color-planes for path-tracer */
-        ptr_r = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
-        ptr_g = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
-        ptr_b = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+        box = (rt_BOUND *)scene->bp_elm[i]->temp;
 
-                /* ptr_* is initialized in reset_color() */
+        if (box->rad == RT_INF || box->rad > avg * 4.0f)
+        {
+            scene->bp_big[scene->bp_bnm++] = i;
+            continue;
+        }
+
+        key[i] = box->mid[a] - box->rad;
+        scene->bp_srt[scene->bp_snm++] = i;
+        scene->bp_ext = RT_MAX(scene->bp_ext, box->rad * 2.0f);
     }
-    if ((opts & RT_OPTS_BUFFERS) == 0)
+
+    isort(scene->bp_srt, lst, scene->bp_snm, key);
+
+    for (i = 0; i < scene->bp_snm; i++)
     {
-        reset_color();
+        scene->bp_key[i] = key[scene->bp_srt[i]];
     }
-    if ((opts & RT_OPTS_PT) == 0)
+
+    /* alloc per-thread arrays for broad-phase queries,
+     * sized for one extra element for the top level */
+    for (i = 0; i < scene->thnum; i++)
     {
-        /* alloc framebuffer's seed-plane for path-tracer */
-        pseed = (rt_elem *)
-                alloc(4 * x_row * y_res * sizeof(rt_elem), RT_SIMD_ALIGN);
+        rt_SceneThread *thr = scene->tharr[i];
 
-                /* pseed is initialized in reset_pseed() */
+        thr->bp_cnd = (rt_si32 *)thr->alloc(sizeof(rt_si32) * n, RT_ALIGN);
+        thr->bp_tmp = (rt_si32 *)thr->alloc(sizeof(rt_si32) * n, RT_ALIGN);
+        thr->bp_nxt = (rt_si32 *)thr->alloc(sizeof(rt_si32) * n, RT_ALIGN);
+        thr->bp_fch = (rt_si32 *)
+                      thr->alloc(sizeof(rt_si32) * (n + 1), RT_ALIGN);
+        thr->bp_lst = (rt_si32 *)
+                      thr->alloc(sizeof(rt_si32) * (n + 1), RT_ALIGN);
+        thr->bp_lsm = (rt_si32 *)
+                      thr->alloc(sizeof(rt_si32) * (n + 1), RT_ALIGN);
+
+        memset(thr->bp_lsm, 0, sizeof(rt_si32) * (n + 1));
+        thr->bp_cur = 0;
     }
+}
 
-    pts_c = 0.0f;
-    pt_on = RT_FALSE;
+/*
+ * Find broad-phase candidates for shadow query with axis-aligned box
+ * "bmin", "bmax" computed by "bbox_hull", only candidates whose parents
+ * are candidates are linked (in "hlist's" order) as arrays rejected
+ * by "bbox_near" skip their contents. Return first top level candidate.
+ */
+rt_si32 rt_SceneThread::bnear(rt_vec4 bmin, rt_vec4 bmax)
+{
+    rt_si32 a = scene->bp_axs, n = scene->bp_num;
+    rt_si32 i, k = 0, c, p, l, r, m;
 
-    fsaa = pfm->fsaa;
+    /* larger elements are checked in every query */
+    for (i = 0; i < scene->bp_bnm; i++)
+    {
+        c = scene->bp_big[i];
 
-    /* instantiate object hierarchy */
-    memset(&rootobj, 0, sizeof(rt_OBJECT));
+        if (bbox_near((rt_BOUND *)scene->bp_elm[c]->temp, bmin, bmax))
+        {
+            bp_cnd[k++] = c;
+        }
+    }
 
-    rootobj.trm.scl[RT_I] = 1.0f;
-    rootobj.trm.scl[RT_J] = 1.0f;
-    rootobj.trm.scl[RT_K] = 1.0f;
-    rootobj.obj = scn->root;
+    /* find first sorted element
+     * within reach of the box */
+    rt_real lim = bmin[a] - scene->bp_ext;
 
-    if (!RT_IS_ARRAY(&scn->root))
+    for (l = 0, r = scene->bp_snm; l < r;)
     {
-        throw rt_Exception("scene's root is not an array");
-    }
+        m = (l + r) / 2;
 
-    root = new(this) rt_Array(this, RT_NULL, &rootobj); /* also init "*_num" */
+        if (scene->bp_key[m] < lim)
+        {
+            l = m + 1;
+        }
+        else
+        {
+            r = m;
+        }
+    }
 
-    if (cam_head == RT_NULL)
+    /* sweep until lower bounds are past the box */
+    for (i = l; i < scene->bp_snm && scene->bp_key[i] <= bmax[a]; i++)
     {
-        throw rt_Exception("scene doesn't contain camera");
-    }
+        c = scene->bp_srt[i];
 
-    cam = cam_head;
-    cam_idx = 0;
+        if (bbox_near((rt_BOUND *)scene->bp_elm[c]->temp, bmin, bmax))
+        {
+            bp_cnd[k++] = c;
+        }
+    }
 
-    /* lock scene data, when scene's constructor can no longer fail */
-    scn->lock = this;
+    /* restore "hlist's" order */
+    isort(bp_cnd, bp_tmp, k, RT_NULL);
 
-    /* create scene threads array */
-    tharr = (rt_SceneThread **)
-            alloc(sizeof(rt_SceneThread *) * thnum, RT_ALIGN);
+    /* new stamp invalidates links of the previous query */
+    bp_cur++;
 
-    rt_si32 i;
+    bp_lsm[n] = bp_cur;
+    bp_lst[n] = -1;
+    bp_fch[n] = -1;
 
-    for (i = 0; i < thnum; i++)
+    /* link candidates whose parents are linked,
+     * parents precede their children in pre-order */
+    for (i = 0; i < k; i++)
     {
-        tharr[i] = new(this) rt_SceneThread(this, i);
+        c = bp_cnd[i];
+        p = scene->bp_par[c] >= 0 ? scene->bp_par[c] : n;
 
-        /* estimate per-frame allocs to reduce system calls per thread */
-        tharr[i]->msize =  /* upper bound per surface for tiling */
-            (tiles_in_row * tiles_in_col + /* plus array nodes list */
-             (arr_num + 2) +     /* plus reflections/refractions */
-             (srf_num + arr_num * 2 + /* plus lights and shadows */
-             (srf_num + arr_num * 2 + 1) * lgt_num) * 2) * /* for both sides */
-            sizeof(rt_ELEM) * (srf_num + thnum - 1) / thnum; /* per thread */
+        if (bp_lsm[p] != bp_cur)
+        {
+            continue;
+        }
+
+        if (bp_lst[p] < 0)
+        {
+            bp_fch[p] = c;
+        }
+        else
+        {
+            bp_nxt[bp_lst[p]] = c;
+        }
+
+        bp_lst[p] = c;
+
+        bp_lsm[c] = bp_cur;
+        bp_lst[c] = -1;
+        bp_fch[c] = -1;
+        bp_nxt[c] = -1;
     }
 
-    pending = 0;
+    return bp_fch[n];
+}
 
-    /* init memory pool in the heap for temporary per-frame allocs */
-    mpool = RT_NULL; /* rough estimate for surface relations/templates */
-    msize = ((srf_num + 1) * (srf_num + 1) * 2 + /* plus two surface lists */
-             (srf_num + arr_num * 1) * 2 + /* plus lights and shadows list */
-             (srf_num + arr_num * 2 + 1) * lgt_num + /* plus array nodes */
-             tiles_in_row * tiles_in_col * arr_num) *  /* for tiling */
-            sizeof(rt_ELEM);                        /* for main thread */
+/*
+ * Deinitialize scene thread.
+ */
+rt_SceneThread::~rt_SceneThread()
+{
+    unchain(pip_chn[0]);
+    unchain(pip_chn[1]);
 
-    /* in the estimates above ("arr_num" * x) depends on whether both
-     * trnode/bvnode are allowed in the list or just one of them,
-     * if the estimates are not accurate the engine should still work,
-     * though not as efficient due to unnecessary allocations per frame
-     * or unused extra memory reservation resulting in larger footprint */
+    ASM_DONE(s_inf)
 }
 
+/******************************************************************************/
+/**********************************   SCENE   *********************************/
+/******************************************************************************/
+
 /*
- * Update current camera with given "action" for a given "time".
+ * Allocate scene in custom heap.
+ * Heap "hp" must be the same object as platform "pfm" in constructor.
  */
-rt_void rt_Scene::update(rt_time time, rt_si32 action)
+rt_pntr rt_Scene::operator new(size_t size, rt_Heap *hp)
 {
-    cam->update_action(time, action);
+    return hp->obj_alloc(size, RT_ALIGN);
 }
 
 /*
- * Update backend data structures and render frame for a given "time".
+ * Delete scene from custom heap.
  */
-rt_void rt_Scene::render(rt_time time)
+rt_void rt_Scene::operator delete(rt_pntr ptr)
 {
-    rt_si32 i;
+    ((rt_Scene *)ptr)->pfm->obj_free(ptr);
+}
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    if ((opts & RT_OPTS_UPDATE_EXT0) == 0 || rootobj.time == -1)
-    { /* -->---->-- skip update1 -->---->-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
+/*
+ * Collect sub-arrays of given array "arr" into given list "lst" descending
+ * down to given "depth", arrays without sub-arrays are collected as is.
+ * Return the number of collected sub-arrays (disjoint subtrees).
+ */
+static
+rt_si32 collect(rt_Array *arr, rt_Array **lst, rt_si32 depth)
+{
+    rt_si32 i, n = 0, k;
 
-    if (pending)
+    for (i = 0; i < arr->obj_num; i++)
     {
-        pending = 0;
+        if (!RT_IS_ARRAY(arr->obj_arr[i]))
+        {
+            continue;
+        }
 
-        /* release memory for temporary per-frame allocs */
-        for (i = 0; i < thnum; i++)
+        rt_Array *sub = (rt_Array *)arr->obj_arr[i];
+
+        k = depth > 1 ? collect(sub, lst + n, depth - 1) : 0;
+
+        if (k == 0)
         {
-            tharr[i]->release(tharr[i]->mpool);
+            lst[n] = sub;
+            k = 1;
         }
 
-        release(mpool);
+        n += k;
     }
 
-    /* reserve memory for temporary per-frame allocs */
-    mpool = reserve(msize, RT_QUAD_ALIGN);
+    return n;
+}
 
-    for (i = 0; i < thnum; i++)
+/*
+ * Count elements in given list "lst" (top level only).
+ */
+static
+rt_si32 count(rt_ELEM *lst)
+{
+    rt_si32 n = 0;
+
+    for (lst = RT_GET_PTR(lst); lst != RT_NULL; lst = RT_GET_PTR(lst->next))
     {
-        tharr[i]->mpool = tharr[i]->reserve(tharr[i]->msize, RT_QUAD_ALIGN);
+        n++;
     }
 
-    /* print state init */
-    if (g_print)
+    return n;
+}
+
+/*
+ * Return depth of the surface from given list element "elm" for sorting,
+ * surfaces under trnode share trnode's depth to keep transform caching,
+ * trnode elements are skipped in tiling, thus their depth is irrelevant.
+ */
+static
+rt_real tdepth(rt_ELEM *elm)
+{
+    rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+    if (RT_IS_ARRAY(nd))
     {
-        RT_PRINT_STATE_INIT();
-        RT_PRINT_TIME(time);
+        return -RT_INF;
     }
 
-    /* phase 0.5, hierarchical update of arrays' transform matrices */
-    root->update_object(time, 0, RT_NULL, iden4);
+    rt_Surface *srf = (rt_Surface *)nd;
 
-    if (pt_on && (root->scn_changed || pfm->fsaa != fsaa))
+    rt_real tmin = srf->trnode != RT_NULL && srf->trnode != srf ?
+                   ((rt_Node *)srf->trnode)->tmin : srf->tmin;
+
+    /* boundless surfaces are sorted behind the rest as background */
+    return tmin == -RT_INF ? RT_INF : tmin;
+}
+
+/*
+ * Sort given list "lst" by surfaces' depth in descending order (far-to-near),
+ * merge sort is stable, thus elements of equal depth retain their order.
+ */
+static
+rt_ELEM* dsort(rt_ELEM *lst)
+{
+    if (lst == RT_NULL || lst->next == RT_NULL)
     {
-        reset_color();
+        return lst;
     }
 
-    /* update current antialiasing mode per scene */
-    fsaa = pfm->fsaa;
+    rt_ELEM *slw = lst, *fst = lst->next;
 
-    /* 1st phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT1 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT1) == 0
-#endif /* RT_OPTS_UPDATE_EXT1 */
-       )
+    /* split the list in the middle */
+    while (fst != RT_NULL && fst->next != RT_NULL)
     {
-        this->f_update(tdata, thnum, 1);
+        slw = slw->next;
+        fst = fst->next->next;
     }
-    else
-#endif /* RT_OPTS_THREAD */
+
+    fst = slw->next;
+    slw->next = RT_NULL;
+
+    slw = dsort(lst);
+    fst = dsort(fst);
+
+    rt_ELEM **ptr = &lst;
+
+    /* merge sorted halves */
+    while (slw != RT_NULL && fst != RT_NULL)
     {
-        update_scene(this, -thnum, 1);
+        if (tdepth(slw) >= tdepth(fst))
+        {
+           *ptr = slw;
+            slw = slw->next;
+        }
+        else
+        {
+           *ptr = fst;
+            fst = fst->next;
+        }
+        ptr = &(*ptr)->next;
     }
 
-    /* update ray positioning and steppers */
-    rt_real h, v;
+   *ptr = slw != RT_NULL ? slw : fst;
 
-    RT_VEC3_SET(pos, cam->pos);
-    RT_VEC3_SET(hor, cam->hor);
-    RT_VEC3_SET(ver, cam->ver);
-    RT_VEC3_SET(nrm, cam->nrm);
+    return lst;
+}
 
-    h = -0.5f * 1.0f;
-    v = -0.5f * aspect;
+/*
+ * Instantiate scene.
+ * Can only be called from single (main) thread.
+ * Platform "pfm" must be the same object as heap "hp" in custom "new".
+ */
+rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
+                   rt_si32 x_res, rt_si32 y_res, rt_si32 x_row, rt_ui32 *frame,
+                   rt_Platform *pfm) :
 
-    /* aim rays at camera's top-left corner */
-    RT_VEC3_MUL_VAL1(dir, nrm, cam->pov);
-    RT_VEC3_MAD_VAL1(dir, hor, h);
-    RT_VEC3_MAD_VAL1(dir, ver, v);
+    rt_Registry(pfm->f_alloc, pfm->f_free),
+    rt_List<rt_Scene>(RT_NULL)
+{
+    this->pfm = pfm;
 
-    /* update tile positioning and steppers */
-    RT_VEC3_ADD(org, pos, dir);
+    pfm->add_scene(this);
 
-    h = 1.0f / (factor * pfm->tile_w); /* x_res / tile_w */
-    v = 1.0f / (factor * pfm->tile_h); /* x_res / tile_h */
+    thnum = pfm->thnum;
+    tdata = pfm->tdata;
 
-    RT_VEC3_MUL_VAL1(htl, hor, h);
-    RT_VEC3_MUL_VAL1(vtl, ver, v);
+    thr_num = thnum; /* for registry of object hierarchy */
 
-    /* 2nd phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT2 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
-#endif /* RT_OPTS_UPDATE_EXT2 */
-       )
+    f_update = pfm->f_update;
+    f_render = pfm->f_render;
+
+    this->scn = scn;
+
+    /* check for locked scene data, not thread safe! (it's ok, not a bug) */
+    if (scn->lock != RT_NULL)
     {
-        this->f_update(tdata, thnum, 2);
+        throw rt_Exception("scene data is locked by another instance");
     }
-    else
-#endif /* RT_OPTS_THREAD */
+
+    /* "x_row", frame's stride (in 32-bit pixels, not bytes!),
+     * can be greater than "x_res", in which case the frame
+     * occupies only a portion (rectangle) of the framebuffer,
+     * or negative, in which case frame starts at the last line
+     * and consecutive lines are located backwards in memory,
+     * "x_row" must contain the whole number of SIMD widths */
+    if (x_res == 0 || y_res == 0 || RT_ABS32(x_row) < x_res)
     {
-        update_scene(this, -thnum, 2);
+        throw rt_Exception("frambuffer's dimensions are not valid");
     }
 
-    /* phase 2.5, hierarchical update of arrays' bounds from surfaces */
-    root->update_bounds();
+#if (RT_POINTER - RT_ADDRESS) != 0
 
-    rt_Surface *srf;
+    /* always reallocate frame in custom heap for 64-bit
+     * if 32-bit address range is enabled in makefiles */
+    frame = RT_NULL;
 
-    /* update surfaces' node lists */
-    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
-    {
-        /* rebuild surface's node list (per-surface)
-         * based on transform flags and arrays' bounds */
-        tharr[0]->snode(srf);
-    }
+#endif /* (RT_POINTER - RT_ADDRESS) */
 
-    /* rebuild global hierarchical list */
-    hlist = tharr[0]->ssort(RT_NULL);
+    frm_ext = 1;
 
-    /* rebuild global surface/node list */
-    slist = tharr[0]->ssort(RT_NULL);
-    tharr[0]->filter(RT_NULL, &slist);
+    if (((rt_word)frame & (RT_SIMD_ALIGN - 1)) != 0 || frame == RT_NULL
+    || (RT_ABS32(x_row) & (RT_SIMD_WIDTH - 1)) != 0)
+    {
+        rt_si32 y_sgn = RT_SIGN(x_row);
 
-    /* rebuild global light/shadow list,
-     * "slist" is needed inside */
-    llist = tharr[0]->lsort(RT_NULL);
+        frm_ext = 0;
 
-    /* rebuild camera's surface/node list,
-     * "slist" is needed inside */
-    clist = tharr[0]->ssort(cam);
+        x_row = RT_ABS32(x_row);
+        x_row = ((x_row + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
 
-    if (g_print)
-    {
-        RT_PRINT_GLB();
-        RT_PRINT_SRF_LST(slist);
-        RT_PRINT_LGT_LST(llist);
-        RT_PRINT_CAM(cam);
-        RT_PRINT_SRF_LST(clist);
-    }
+        frame = (rt_ui32 *)
+                alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
 
-    /* 3rd phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT3 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT3) == 0
-#endif /* RT_OPTS_UPDATE_EXT3 */
-       )
+        x_row *= y_sgn;
+
+        if (x_row < 0)
+        {
+            frame += RT_ABS32(x_row) * (y_res - 1);
+        }
+    }
+
+    memset(frame, 0, x_row * y_res * sizeof(rt_ui32));
+
+    /* init framebuffer's dimensions and pointer */
+    this->x_res = x_res;
+    this->y_res = y_res;
+    this->x_row = x_row;
+    this->frame = frame;
+
+    /* init tilebuffer's dimensions and pointer */
+    tile_w = pfm->tile_w;
+    tile_h = pfm->tile_h;
+
+    tiles_in_row = (x_res + tile_w - 1) / tile_w;
+    tiles_in_col = (y_res + tile_h - 1) / tile_h;
+    tiles_max = tiles_in_row * tiles_in_col;
+
+    tiles = (rt_ELEM **)
+            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ELEM *), RT_ALIGN);
+
+    memset(tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+
+    /* init regions of interest (none), spans buffers
+     * are sized for the largest number of tiles */
+    rects = RT_NULL;
+    rects_num = 0;
+    rects_max = 0;
+
+    spans = (rt_si32 *)
+            alloc(tiles_max * 3 * sizeof(rt_si32), RT_ALIGN);
+    spans_num = 0;
+
+    srows = (rt_si32 *)
+            alloc((y_res + 1) * sizeof(rt_si32), RT_ALIGN);
+
+    /* init variable-rate render (off), its buffers
+     * are sized for the largest number of tiles */
+    vr_map = (rt_si32 *)
+            alloc(tiles_max * sizeof(rt_si32), RT_ALIGN);
+    vr_itm = (rt_si32 *)
+            alloc(tiles_max * 4 * sizeof(rt_si32), RT_ALIGN);
+    vr_num = 0;
+
+    /* init path-tracer's adaptive sampling (off),
+     * its per-tile buffers are sized as above */
+    pt_cnt = (rt_real *)
+            alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+    pt_upd = (rt_si32 *)
+            alloc(tiles_max * sizeof(rt_si32), RT_ALIGN);
+    pt_err = (rt_real *)
+            alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+    pt_itm = (rt_si32 *)
+            alloc(tiles_max * 4 * sizeof(rt_si32), RT_ALIGN);
+    pt_num = 0;
+
+    /* init per-tile render cost heatmap (off),
+     * its per-tile buffers are sized as above */
+    hm_acc = (rt_time *)
+            alloc(tiles_max * sizeof(rt_time), RT_ALIGN);
+    hm_buf = (rt_real *)
+            alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+
+    memset(hm_acc, 0, tiles_max * sizeof(rt_time));
+    memset(hm_buf, 0, tiles_max * sizeof(rt_real));
+
+    hm_on = 0;
+    hm_img = RT_NULL;
+    f_cost = RT_NULL;
+
+    pt_tol = 0.0f;
+    pt_act = RT_FALSE;
+    pt_sep = RT_FALSE;
+    pt_left = 0;
+
+    /* init path-tracer's denoiser (off) */
+    dn_on = 0;
+    dn_act = RT_FALSE;
+    dn_val = RT_FALSE;
+    dn_pas = 0;
+    dn_pln = RT_NULL;
+    dn_alb = RT_NULL;
+    dn_stg = RT_NULL;
+
+    /* init pixel-width, aspect-ratio, ray-depth */
+    factor = 1.0f / (rt_real)x_res;
+    aspect = (rt_real)y_res * factor;
+    depth = RT_MAX(RT_STACK_DEPTH, 0);
+    opts &= ~scn->opts;
+
+    pseed = RT_NULL;
+    ptr_r = RT_NULL;
+    ptr_g = RT_NULL;
+    ptr_b = RT_NULL;
+    ptr_l = RT_NULL;
+    ptr_v = RT_NULL;
+
+    if ((opts & RT_OPTS_PT) == 0 || (opts & RT_OPTS_BUFFERS) == 0)
     {
-        this->f_update(tdata, thnum, 3);
+        /* alloc framebuffer's color-planes for path-tracer */
+        ptr_r = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+        ptr_g = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+        ptr_b = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+
+                /* ptr_* is initialized in reset_color() */
     }
-    else
-#endif /* RT_OPTS_THREAD */
+    if ((opts & RT_OPTS_BUFFERS) == 0)
     {
-        update_scene(this, -thnum, 3);
+        reset_color();
     }
+    if ((opts & RT_OPTS_PT) == 0)
+    {
+        /* alloc framebuffer's seed-plane for path-tracer */
+        pseed = (rt_elem *)
+                alloc(4 * x_row * y_res * sizeof(rt_elem), RT_SIMD_ALIGN);
 
-    /* screen tiling */
-    rt_si32 tline, j;
+                /* pseed is initialized in reset_pseed() */
+    }
 
-#if RT_OPTS_TILING != 0
-    if ((opts & RT_OPTS_TILING) != 0)
-    {
-        memset(tiles, 0, sizeof(rt_ELEM *) * tiles_in_row * tiles_in_col);
+    pts_c = 0.0f;
+    pt_on = RT_FALSE;
 
-        rt_ELEM *elm, *nxt, *ctail = RT_NULL, **ptr = &ctail;
+    cb_on = RT_FALSE;
+    cb_act = RT_FALSE;
+    cb_par = 0;
+    cb_val = RT_FALSE;
+    cb_hlf = RT_NULL;
+    cb_hst[0] = RT_NULL;
+    cb_hst[1] = RT_NULL;
+    cb_dep = RT_NULL;
+    cb_stg = RT_NULL;
+
+    vr_on = 0;
+    vr_act = RT_FALSE;
+    vr_buf = RT_NULL;
+    vr_wgt = RT_NULL;
+    vr_stg = RT_NULL;
+
+    ad_on = RT_FSAA_NO;
+    ad_act = RT_FALSE;
+    ad_msk = RT_NULL;
+    ad_buf = RT_NULL;
+    ad_acc = RT_NULL;
 
-        /* build exact copy of reversed "clist" (should be cheap),
-         * trnode elements become tailing rather than heading,
-         * elements grouping for cached transform is retained */
-        for (nxt = clist; nxt != RT_NULL; nxt = nxt->next)
-        {
-            /* alloc new element as "nxt's" copy */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = nxt->data;
-            elm->simd = nxt->simd;
-            elm->temp = nxt->temp;
-            /* insert element as list's head */
-            elm->next = *ptr;
-           *ptr = elm;
-        }
+    fsaa = pfm->fsaa;
 
-        /* traverse reversed "clist" to keep original "clist's" order
-         * and optimize trnode handling for each tile */
-        for (elm = ctail; elm != RT_NULL; elm = elm->next)
-        {
-            rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+    /* instantiate object hierarchy */
+    memset(&rootobj, 0, sizeof(rt_OBJECT));
 
-            /* skip trnode elements from reversed "clist"
-             * as they are handled separately for each tile */
-            if (RT_IS_ARRAY(nd))
-            {
-                continue;
-            }
+    rootobj.trm.scl[RT_I] = 1.0f;
+    rootobj.trm.scl[RT_J] = 1.0f;
+    rootobj.trm.scl[RT_K] = 1.0f;
+    rootobj.obj = scn->root;
 
-            rt_Surface *srf = (rt_Surface *)nd;
+    if (!RT_IS_ARRAY(&scn->root))
+    {
+        throw rt_Exception("scene's root is not an array");
+    }
 
-            rt_ELEM *tls = srf->tls, *trn;
+    root = new(this) rt_Array(this, RT_NULL, &rootobj); /* also init "*_num" */
 
-            if (srf->trnode != RT_NULL && srf->trnode != srf)
-            {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
+    if (cam_head == RT_NULL)
+    {
+        throw rt_Exception("scene doesn't contain camera");
+    }
 
-                    nxt = tls->next;
+    cam = cam_head;
+    cam_idx = 0;
+    rcam = RT_NULL;
+    bat_on = 0;
+
+    pip_val = RT_FALSE;
+    pip_act = RT_FALSE;
+    pip_run = RT_FALSE;
+    pip_cnt = 0;
+    pip_par = 0;
+    pip_chn[0] = pip_chn[1] = RT_NULL;
+    pip_mpl[0] = pip_mpl[1] = RT_NULL;
+    pip_tls = RT_NULL;
+    pip_max = 0;
+    pip_lst = RT_NULL;
+
+    pstate = 0;
+    pdone = 0;
+    ptime = 0;
+    f_time = RT_NULL;
+
+    tmr_arr = RT_NULL;
+    tmr_num = 0;
+    tmr_max = 0;
+    tmr_cnt = 0;
+    tmr_cur = RT_NULL;
+    tmr_last = 0;
+    f_tick = RT_NULL;
+
+    memset(st_arr, 0, sizeof(st_arr));
 
-                    tls->data = 0;
+    /* lock scene data, when scene's constructor can no longer fail */
+    scn->lock = this;
 
-                    tline = i * tiles_in_row;
+    /* create scene threads array */
+    tharr = (rt_SceneThread **)
+            alloc(sizeof(rt_SceneThread *) * thnum, RT_ALIGN);
 
-                    /* check matching existing trnode for insertion,
-                     * only tile list's head needs to be checked as elements
-                     * grouping for cached transform is retained from "clist" */
-                    trn = tiles[tline + j];
+    rt_si32 i;
 
-                    rt_Array *arr = (rt_Array *)srf->trnode;
-                    rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i] = new(this) rt_SceneThread(this, i);
 
-                    if (trn != RT_NULL && trn->temp == trb)
-                    {
-                        /* insert element under existing trnode */
-                        tls->next = trn->next;
-                        trn->next = tls;
-                    }
-                    else
-                    {
-                        /* insert element as list's head */
-                        tls->next = tiles[tline + j];
-                        tiles[tline + j] = tls;
-
-                        /* alloc new trnode element as none has been found */
-                        trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-                        trn->data = (rt_cell)tls; /* trnode's last element */
-                        trn->simd = arr->s_srf;
-                        trn->temp = trb;
-                        /* insert element as list's head */
-                        trn->next = tiles[tline + j];
-                        tiles[tline + j] = trn;
-                    }
-                }
-            }
-            else
-            {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
+        /* estimate per-frame allocs to reduce system calls per thread */
+        tharr[i]->msize =  /* upper bound per surface for tiling */
+            (tiles_in_row * tiles_in_col + /* plus array nodes list */
+             (arr_num + 2) +     /* plus reflections/refractions */
+             (srf_num + arr_num * 2 + /* plus lights and shadows */
+             (srf_num + arr_num * 2 + 1) * lgt_num) * 2) * /* for both sides */
+            sizeof(rt_ELEM) * (srf_num + thnum - 1) / thnum; /* per thread */
+    }
 
-                    nxt = tls->next;
+    /* alloc tiles list bands for each surface,
+     * both heads and tails are kept for each band */
+    rt_Surface *srf;
 
-                    tls->data = 0;
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->tlb = (rt_ELEM **)
+                alloc(sizeof(rt_ELEM *) * thnum * 2, RT_ALIGN);
+    }
 
-                    tline = i * tiles_in_row;
+    rlist = RT_NULL;
 
-                    /* insert element as list's head */
-                    tls->next = tiles[tline + j];
-                    tiles[tline + j] = tls;
-                }
-            }
-        }
+    bp_num = 0;
+    bp_snm = 0;
+    bp_bnm = 0;
 
-        if (g_print)
-        {
-            rt_si32 i = 0, j = 0;
+    rband = 0;
+    pending = 0;
 
-            tline = i * tiles_in_row;
+    /* select subtrees of the hierarchy updated as separate tasks
+     * in phases 0.5 and 2.5, descend one level at a time
+     * until there are enough tasks to keep all threads busy */
+    tsk_arr = (rt_Array **)
+            alloc(sizeof(rt_Array *) * arr_num, RT_ALIGN);
+    tsk_num = 0;
 
-            RT_PRINT_TLS_LST(tiles[tline + j], i, j);
-        }
-    }
-    else
-#endif /* RT_OPTS_TILING */
+    for (i = 1; tsk_num < thnum * 2; i++)
     {
-        for (i = 0; i < tiles_in_col; i++)
-        {
-            tline = i * tiles_in_row;
+        rt_si32 n = tsk_num;
 
-            for (j = 0; j < tiles_in_row; j++)
-            {
-                tiles[tline + j] = clist;
-            }
+        tsk_num = collect(root, tsk_arr, i);
+
+        if (tsk_num == n)
+        {
+            break;
         }
     }
 
-    /* aim rays at pixel centers */
-    RT_VEC3_MUL_VAL1(hor, hor, factor);
-    RT_VEC3_MUL_VAL1(ver, ver, factor);
+    /* bounds of the task are updated separately in phase 2.5
+     * only if its contributions stay within its subtree */
+    for (i = 0; i < tsk_num; i++)
+    {
+        tsk_arr[i]->tsk_local = tsk_arr[i]->check_bvnode(tsk_arr[i]);
+    }
 
-    RT_VEC3_MAD_VAL1(dir, hor, 0.5f);
-    RT_VEC3_MAD_VAL1(dir, ver, 0.5f);
+    /* init memory pool in the heap for temporary per-frame allocs */
+    mpool = RT_NULL; /* rough estimate for surface relations/templates */
+    msize = ((srf_num + 1) * (srf_num + 1) * 2 + /* plus two surface lists */
+             (srf_num + arr_num * 1) * 2 + /* plus lights and shadows list */
+             (srf_num + arr_num * 2 + 1) * lgt_num + /* plus array nodes */
+             tiles_in_row * tiles_in_col * arr_num) *  /* for tiling */
+            sizeof(rt_ELEM);                        /* for main thread */
+    mused = 0;
+    mpeak = 0;
+    mfrms = RT_MSIZE_FRAMES;
 
-    /* accumulate ambient from camera and all light sources */
-    RT_VEC3_MUL_VAL1(amb, cam->cam->col.hdr, cam->cam->lum[0]);
-    amb[RT_A] = cam->cam->lum[0];
+    /* in the estimates above ("arr_num" * x) depends on whether both
+     * trnode/bvnode are allowed in the list or just one of them,
+     * if the estimates are not accurate the engine should still work,
+     * though not as efficient due to unnecessary allocations per frame
+     * or unused extra memory reservation resulting in larger footprint,
+     * estimates are then adjusted to actual usage after each frame */
+}
 
-    rt_Light *lgt = RT_NULL;
+/*
+ * Update current camera with given "action" for a given "time".
+ */
+rt_void rt_Scene::update(rt_time time, rt_si32 action)
+{
+    cam->update_action(time, action);
+}
 
-    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+/*
+ * Update backend data structures and render frame for a given "time".
+ */
+rt_void rt_Scene::render(rt_time time)
+{
+    /* path-tracer's adaptive sampling renders full frames */
+    pt_act = pt_on && pt_tol > 0.0f && rects_num == 0;
+
+    /* start timing the frame in the next record */
+    if (tmr_num > 0)
     {
-        RT_VEC3_MAD_VAL1(amb, lgt->lgt->col.hdr, lgt->lgt->lum[0]);
-        amb[RT_A] += lgt->lgt->lum[0];
+        tmr_cur = &tmr_arr[tmr_cnt % tmr_num];
+        tmr_cur->time = time;
+        memset(tmr_cur->wall, 0, sizeof(tmr_cur->wall));
+        memset(tmr_cur->busy, 0, thnum * RT_TMRS_NUM * sizeof(rt_time));
+        tmr_last = f_tick();
     }
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    } /* --<----<-- skip update1 --<----<-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
+    render_init(time);
 
+    time_mark(RT_TMRS_SEQ);
 
 #if RT_OPTS_RENDER_EXT0 != 0
     if ((opts & RT_OPTS_RENDER_EXT0) == 0)
@@ -3331,6 +4325,37 @@ rt_void rt_Scene::render(rt_time time)
     reset_color();
 #endif /* enable for SIMD-buffers as a debug option if needed */
 
+    /* checkerboard traces half of the pixels given valid history,
+     * path-tracer and regions of interest render full frames,
+     * half-width tiles must hold whole SIMD steps of pixels */
+    cb_act = cb_on && cb_val && !pt_on && rects_num == 0
+          && (tile_w / 2) % (pfm->simd_width >> pfm->fsaa) == 0;
+
+    /* variable-rate render takes precedence over checkerboard,
+     * path-tracer and regions of interest render at full rate */
+    vr_act = vr_on && !pt_on && rects_num == 0;
+
+    if (vr_act)
+    {
+        cb_act = RT_FALSE;
+        reset_rates();
+    }
+
+    /* adaptive antialiasing applies to the final frame
+     * of a single sample per pixel, except for path-tracer */
+    ad_act = ad_on && pfm->fsaa == RT_FSAA_NO && !pt_on && rects_num == 0;
+
+    /* denoiser filters path-tracer's full frames */
+    dn_act = dn_on && pt_on && rects_num == 0;
+
+    if (pt_act)
+    {
+        reset_ptcv();
+    }
+
+    /* reset rows stealing counter,
+     * not used if rows are interleaved */
+    rband = 0;
     /* multi-threaded render */
 #if RT_OPTS_THREAD != 0
     if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene()
@@ -3340,486 +4365,3517 @@ rt_void rt_Scene::render(rt_time time)
        )
     {
         this->f_render(tdata, thnum, 1);
+
+        if (pt_act)
+        {
+            this->f_render(tdata, thnum, 8);
+        }
+        if (dn_act)
+        {
+            for (dn_pas = 0; dn_pas <= dn_on; dn_pas++)
+            {
+                this->f_render(tdata, thnum, 10);
+            }
+        }
+        if (cb_act)
+        {
+            this->f_render(tdata, thnum, 4);
+        }
+        if (vr_act)
+        {
+            this->f_render(tdata, thnum, 5);
+        }
+        if (ad_act)
+        {
+            this->f_render(tdata, thnum, 6);
+            rband = 0;
+            this->f_render(tdata, thnum, 7);
+        }
     }
     else
 #endif /* RT_OPTS_THREAD */
     {
         render_scene(this, -thnum, 1);
+
+        if (pt_act)
+        {
+            render_scene(this, -thnum, 8);
+        }
+        if (dn_act)
+        {
+            for (dn_pas = 0; dn_pas <= dn_on; dn_pas++)
+            {
+                render_scene(this, -thnum, 10);
+            }
+        }
+        if (cb_act)
+        {
+            render_scene(this, -thnum, 4);
+        }
+        if (vr_act)
+        {
+            render_scene(this, -thnum, 5);
+        }
+        if (ad_act)
+        {
+            render_scene(this, -thnum, 6);
+            rband = 0;
+            render_scene(this, -thnum, 7);
+        }
     }
 
-    pts_c = tharr[0]->s_inf->pts_c[0];
+    time_mark(RT_TMRS_RND);
 
-#if RT_OPTS_RENDER_EXT0 != 0
-    } /* --<----<-- skip render0 --<----<-- */
-#endif /* RT_OPTS_RENDER_EXT0 */
+    pts_c = tharr[0]->s_inf->pts_c[0];
 
+    /* guide stays valid until accumulation restarts */
+    if (dn_act)
+    {
+        dn_val = RT_TRUE;
+    }
+
+    if (pt_act)
+    {
+        rt_si32 t;
+
+        /* frame's counter holds the fewest samples of any tile,
+         * tiles are tested once enough estimates are taken */
+        pts_c = pt_cnt[0];
+        pt_left = 0;
+
+        for (t = 0; t < tiles_in_row * tiles_in_col; t++)
+        {
+            pts_c = RT_MIN(pts_c, pt_cnt[t]);
+            pt_left += pt_upd[t] < RT_PTCV_MIN || pt_err[t] >= pt_tol;
+        }
+    }
+
+    if (cb_act)
+    {
+        /* reconstructed frame becomes history,
+         * traced pixels alternate every frame */
+        rt_ui32 *hst = cb_hst[0];
+        cb_hst[0] = cb_hst[1];
+        cb_hst[1] = hst;
+
+        cb_par ^= 1;
+    }
+    else
+    if (cb_on)
+    {
+        /* full frame becomes history */
+        memcpy(cb_hst[0], frame, x_row * y_res * sizeof(rt_ui32));
+
+        cb_val = RT_TRUE;
+    }
+
+    pt_act = RT_FALSE;
+    dn_act = RT_FALSE;
+    cb_act = RT_FALSE;
+    vr_act = RT_FALSE;
+    ad_act = RT_FALSE;
+
+    RT_VEC3_SET(cb_pos, pos);
+    RT_VEC3_SET(cb_dir, dir);
+    RT_VEC3_SET(cb_hor, hor);
+    RT_VEC3_SET(cb_ver, ver);
+
+#if RT_OPTS_RENDER_EXT0 != 0
+    } /* --<----<-- skip render0 --<----<-- */
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+    render_done();
+
+    /* finish the frame's record */
+    if (tmr_cur != RT_NULL)
+    {
+        time_mark(RT_TMRS_SEQ);
+        tmr_cur = RT_NULL;
+        tmr_cnt++;
+    }
+}
+
+/*
+ * Accumulate time passed since the previous mark
+ * to "slot" of the frame being timed (if any).
+ */
+rt_void rt_Scene::time_mark(rt_si32 slot)
+{
+    if (tmr_cur == RT_NULL)
+    {
+        return;
+    }
+
+    rt_time t = f_tick();
+
+    tmr_cur->wall[slot] += t - tmr_last;
+    tmr_last = t;
+}
+
+/*
+ * Reconstruct rows of the frame with given "index" in checkerboard mode.
+ * Traced pixels are copied from the half-width buffer, untraced pixels
+ * are reprojected from the history frame by camera's position and
+ * orientation (at the nearest depth of traced neighbors, by rotation
+ * only if they all missed), history is rejected if out of the range of
+ * traced neighbors, then neighbors are interpolated along the direction
+ * of least change. Neighbors and depths of each row are staged into
+ * SIMD-aligned rows for the backend's filter (filter0).
+ */
+rt_void rt_Scene::render_cbrd(rt_si32 index)
+{
+    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+    rt_SIMD_FILTER *s_flt = tharr[index]->s_flt;
+
+    rt_elem *stg = cb_stg + 6 * x_row * index, *row;
+    rt_ui32 *hlf, *out, *nxt;
+    rt_si32 x, y, i, j, n, w = pfm->simd_width, par;
+    rt_si32 ku, kd, kl, kr, fs = 1 << pfm->fsaa;
+    rt_real *dep, *rdt = (rt_real *)(stg + 4 * x_row), t;
+    rt_vec4 vec, nrm, off;
+
+    /* history frame's screen normal, camera's offset */
+    RT_VEC3_MUL(nrm, cb_hor, cb_ver);
+    RT_VEC3_SUB(off, pos, cb_pos);
+
+    /* history pixel's indices are rounded to nearest */
+    rt_real hh = RT_VEC3_DOT(cb_hor, cb_hor);
+    rt_real vv = RT_VEC3_DOT(cb_ver, cb_ver);
+
+    RT_SIMD_SET(s_flt->s_nrm, RT_VEC3_DOT(cb_dir, nrm));
+    RT_SIMD_SET(s_flt->s_hor, RT_VEC3_DOT(cb_dir, cb_hor) - 0.5f * hh);
+    RT_SIMD_SET(s_flt->s_ver, RT_VEC3_DOT(cb_dir, cb_ver) - 0.5f * vv);
+
+    RT_SIMD_SET(s_flt->i_hor, 1.0f / hh);
+    RT_SIMD_SET(s_flt->i_ver, 1.0f / vv);
+
+    RT_SIMD_SET(s_flt->a_nrm, RT_VEC3_DOT(hor, nrm));
+    RT_SIMD_SET(s_flt->a_hor, RT_VEC3_DOT(hor, cb_hor));
+    RT_SIMD_SET(s_flt->a_ver, RT_VEC3_DOT(hor, cb_ver));
+
+    RT_SIMD_SET(s_flt->d_nrm, RT_VEC3_DOT(off, nrm));
+    RT_SIMD_SET(s_flt->d_hor, RT_VEC3_DOT(off, cb_hor));
+    RT_SIMD_SET(s_flt->d_ver, RT_VEC3_DOT(off, cb_ver));
+
+    RT_SIMD_SET(s_flt->t_max, RT_INF);
+    RT_SIMD_SET(s_flt->x_stp, (rt_real)(2 * w));
+    RT_SIMD_SET(s_flt->x_res, (rt_real)x_res);
+    RT_SIMD_SET(s_flt->y_res, (rt_real)y_res);
+    RT_SIMD_SET(s_flt->x_row, (rt_elem)x_row);
+
+    RT_SIMD_SET(s_flt->c_tol, (rt_elem)RT_CBRD_TOL);
+    RT_SIMD_SET(s_flt->c_msk, (rt_elem)0xFF);
+    RT_SIMD_SET(s_flt->c_avg, (rt_elem)0xFEFEFEFE);
+
+    s_flt->row_u[0] = stg + 0 * x_row;
+    s_flt->row_d[0] = stg + 1 * x_row;
+    s_flt->row_l[0] = stg + 2 * x_row;
+    s_flt->row_r[0] = stg + 3 * x_row;
+    s_flt->row_t[0] = stg + 4 * x_row;
+    s_flt->row_o[0] = stg + 5 * x_row;
+    s_flt->hst_p[0] = cb_hst[0];
+    s_flt->mode[0]  = RT_FILT_CBRD;
+
+    for (y = index; y < y_res; y += thnum)
+    {
+        hlf = cb_hlf + y * x_row;
+        dep = cb_dep + y * x_row * fs;
+        out = frame + y * x_row;
+        nxt = cb_hst[1] + y * x_row;
+        par = (y + cb_par) & 1;
+
+        /* untraced pixels are at "1 - par" in each pair of pixels */
+        n = (x_res + par) / 2;
+
+        for (j = 0; j < n; j++)
+        {
+            x = j * 2 + 1 - par;
+
+            /* traced neighbors: left, right, up, down */
+            kl = (x - (x > 0)) >> 1;
+            kr = x < x_res - 1 ? (x + 1) >> 1 : kl;
+            kd = y < y_res - 1 ? (x >> 1) + x_row : kl;
+            ku = y > 0 ? (x >> 1) - x_row : kd;
+            kd = y < y_res - 1 ? kd : ku;
+
+            stg[0 * x_row + j] = (rt_elem)hlf[ku];
+            stg[1 * x_row + j] = (rt_elem)hlf[kd];
+            stg[2 * x_row + j] = (rt_elem)hlf[kl];
+            stg[3 * x_row + j] = (rt_elem)hlf[kr];
+
+            /* nearest depth of neighbors' first samples */
+            t = RT_MIN(dep[kl * fs], dep[kr * fs]);
+            t = RT_MIN(t, RT_MIN(dep[ku * fs], dep[kd * fs]));
+            rdt[j] = t;
+        }
+
+        /* pad the row to whole SIMD steps */
+        for (; j % w != 0; j++)
+        {
+            for (i = 0; i < 4; i++)
+            {
+                stg[i * x_row + j] = 0;
+            }
+
+            rdt[j] = RT_INF;
+        }
+
+        s_flt->row_n[0] = j * sizeof(rt_elem);
+
+        /* ray to the first pixel of the row */
+        RT_VEC3_MUL_VAL1(vec, ver, (rt_real)y);
+        RT_VEC3_ADD(vec, vec, dir);
+
+        RT_SIMD_SET(s_flt->o_nrm, RT_VEC3_DOT(vec, nrm));
+        RT_SIMD_SET(s_flt->o_hor, RT_VEC3_DOT(vec, cb_hor));
+        RT_SIMD_SET(s_flt->o_ver, RT_VEC3_DOT(vec, cb_ver));
+
+        for (i = 0; i < w; i++)
+        {
+            s_flt->x_pos[i] = (rt_real)(i * 2 + 1 - par);
+        }
+
+        if (n > 0)
+        {
+            pfm->filter0(s_inf);
+        }
+
+        /* interleave traced and reconstructed pixels */
+        row = stg + 5 * x_row;
+
+        for (x = 0; x < x_res; x++)
+        {
+            out[x] = nxt[x] = ((x + par) & 1) == 0 ?
+                              hlf[x >> 1] : (rt_ui32)row[x >> 1];
+        }
+    }
+}
+
+/*
+ * Steps between traced pixels (horizontal, vertical) per shading rate
+ * of variable-rate render: full, 1/2, 1/4 and 1/16 of the pixels,
+ * followed by rows-only steps for 1/2, 1/4 and 1/16 (capped at 1/4)
+ * if compacted rows of tiles can't hold whole SIMD steps of pixels.
+ */
+static
+rt_si32 vr_step[7][2] =
+{
+    {1, 1}, {2, 1}, {2, 2}, {4, 4}, {1, 2}, {1, 4}, {1, 4},
+};
+
+/*
+ * Expand compacted row "src" of every "vx"-th pixel to "n" pixels
+ * of staged "row" with given "index" in variable-rate render, pixels
+ * in between are interpolated by the backend's filter (filter0) from
+ * their traced neighbors staged as operands, the last one is extended.
+ */
+rt_void rt_Scene::expand_rate(rt_si32 index, rt_elem *row,
+                              rt_ui32 *src, rt_si32 n, rt_si32 vx)
+{
+    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+    rt_SIMD_FILTER *s_flt = tharr[index]->s_flt;
+
+    rt_elem *stg = vr_stg + 5 * x_row * index;
+    rt_si32 x, i, m = (n + vx - 1) / vx - 1;
+
+    if (vx == 1)
+    {
+        for (x = 0; x < n; x++)
+        {
+            row[x] = (rt_elem)src[x];
+        }
+
+        return;
+    }
+
+    for (x = 0; x < n; x++)
+    {
+        i = x / vx;
+
+        stg[0 * x_row + x] = (rt_elem)src[i];
+        stg[1 * x_row + x] = (rt_elem)src[RT_MIN(i + 1, m)];
+    }
+
+    s_flt->row_u[0] = stg + 0 * x_row;
+    s_flt->row_d[0] = stg + 1 * x_row;
+    s_flt->row_q[0] = vr_wgt + (vx == 2 ? 4 : 5) * x_row;
+    s_flt->row_o[0] = row;
+
+    pfm->filter0(s_inf);
+}
+
+/*
+ * Upsample items below full rate with given "index" in variable-rate
+ * render, traced rows are expanded into staged rows, then rows in between
+ * are interpolated by the backend's filter (filter0), the last traced row
+ * of an item is extended to its edge. Whole SIMD steps of 32-bit elements
+ * are written to the frame in place, other rows are copied from staging.
+ */
+rt_void rt_Scene::render_rate(rt_si32 index)
+{
+    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+    rt_SIMD_FILTER *s_flt = tharr[index]->s_flt;
+
+    rt_elem *stg = vr_stg + 5 * x_row * index, *r0, *r1, *row;
+    rt_ui32 *out;
+    rt_si32 k, y, i, x, n, x0, x1, y0, y1, vx, vy, w = pfm->simd_width;
+    rt_bool drc;
+
+    RT_SIMD_SET(s_flt->c_avg, (rt_elem)0xFEFEFEFE);
+    s_flt->mode[0]  = RT_FILT_VRUP;
+
+    for (k = index; k < vr_num; k += thnum)
+    {
+        rt_si32 *itm = vr_itm + k * 4;
+
+        if (itm[3] == 0)
+        {
+            continue;
+        }
+
+        vx = vr_step[itm[3]][0];
+        vy = vr_step[itm[3]][1];
+
+        y0 = itm[0] * tile_h;
+        y1 = RT_MIN(y0 + tile_h, y_res);
+        x0 = itm[1] * tile_w;
+        x1 = RT_MIN(itm[2] * tile_w + tile_w, x_res);
+
+        /* pad staged rows to whole SIMD steps */
+        n = x1 - x0;
+        s_flt->row_n[0] = ((n + w - 1) / w) * w * sizeof(rt_elem);
+        drc = sizeof(rt_elem) == sizeof(rt_ui32) && n % w == 0;
+
+        r0 = stg + 2 * x_row;
+        r1 = stg + 3 * x_row;
+        expand_rate(index, r0, vr_buf + y0 * x_row + x0, n, vx);
+
+        for (y = y0; y < y1; y += vy, row = r0, r0 = r1, r1 = row)
+        {
+            /* traced rows above and below */
+            if (y + vy < y1)
+            {
+                expand_rate(index, r1, vr_buf + (y + vy) * x_row + x0,
+                            n, vx);
+            }
+            else
+            {
+                r1 = r0;
+            }
+
+            for (i = 0; i < vy && y + i < y1; i++)
+            {
+                out = frame + (y + i) * x_row + x0;
+                row = r0;
+
+                if (i > 0)
+                {
+                    row = drc ? (rt_elem *)out : stg + 4 * x_row;
+
+                    s_flt->row_u[0] = r0;
+                    s_flt->row_d[0] = r1;
+                    s_flt->row_q[0] = vr_wgt + (i * 4 / vy) * x_row;
+                    s_flt->row_o[0] = row;
+
+                    pfm->filter0(s_inf);
+
+                    if (drc)
+                    {
+                        continue;
+                    }
+                }
+
+                for (x = 0; x < n; x++)
+                {
+                    out[x] = (rt_ui32)row[x];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Subpixel offsets (in 1/16 of a pixel) of adaptive antialiasing's
+ * samples for 2X, 4X and 8X modes, the first one is the primary ray.
+ */
+static
+rt_si32 ad_smp[3][8][2] =
+{
+    {{0, 0}, {8, 8}},
+    {{0, 0}, {0, -6}, {5, 3}, {-5, 3}},
+    {{0, 0}, {-1, 3}, {5, 1}, {-3, -5}, {-5, 5}, {-7, -1}, {3, 7}, {7, -7}},
+};
+
+/*
+ * Check if two color channels differ above adaptive antialiasing's
+ * edge threshold.
+ */
+static
+rt_ui08 ad_dif(rt_ui08 c1, rt_ui08 c2)
+{
+    /* byte-sized math keeps vectorized loops narrow */
+    rt_ui08 d = (rt_ui08)(RT_MAX(c1, c2) - RT_MIN(c1, c2));
+
+    return d > RT_ADAA_TOL;
+}
+
+/*
+ * Mark edge blocks in rows of the frame with given "index" for adaptive
+ * antialiasing, a block (SIMD step of pixels) is an edge block if any
+ * of its pixels differs from one of its 4 neighbors above the threshold
+ * in any color channel, channels' loops are kept simple to allow
+ * compiler's vectorization.
+ */
+rt_void rt_Scene::render_edge(rt_si32 index)
+{
+    rt_ui08 *row, *up, *dn, *msk, *e;
+    rt_ui32 *edg, m;
+    rt_si32 b, k, n = x_res * 4, y, s = pfm->simd_width;
+
+    for (y = index; y < y_res; y += thnum)
+    {
+        row = (rt_ui08 *)(frame + y * x_row);
+        up = y > 0 ? row - x_row * 4 : row;
+        dn = y < y_res - 1 ? row + x_row * 4 : row;
+        msk = ad_msk + y * x_row;
+
+        /* row's flags per channel are kept in its row of sums */
+        edg = (rt_ui32 *)(ad_acc + y * x_row);
+        e = (rt_ui08 *)edg;
+
+        for (k = 0; k < n; k++)
+        {
+            e[k] = ad_dif(row[k], up[k]) | ad_dif(row[k], dn[k]);
+        }
+        for (k = 4; k < n; k++)
+        {
+            e[k] |= ad_dif(row[k], row[k - 4]);
+        }
+        for (k = 0; k < n - 4; k++)
+        {
+            e[k] |= ad_dif(row[k], row[k + 4]);
+        }
+
+        /* pixels' flags are merged per block,
+         * alpha channel's flag (per endianness) is skipped */
+        for (b = 0; b * s < x_res; b++)
+        {
+            for (k = b * s, m = 0; k < RT_MIN(b * s + s, x_res); k++)
+            {
+                m |= edg[k];
+            }
+
+            msk[b] = (m & (RT_ENDIAN ? 0xFFFFFF00 : 0x00FFFFFF)) != 0;
+        }
+    }
+}
+
+/*
+ * Spread color channels to 16-bit lanes for adaptive antialiasing's sums.
+ */
+static
+rt_ui64 ad_spr(rt_ui32 c)
+{
+    return (rt_ui64)(c & 0x00FF00FF) | (rt_ui64)(c & 0x0000FF00) << 24;
+}
+
+/*
+ * Re-trace edge blocks within stolen rows of tiles with given "index"
+ * for adaptive antialiasing, edge blocks of a row of tiles are merged
+ * into runs of columns over its rows with edges, each run is traced
+ * once per extra sample, then pixels are set to the average of samples.
+ */
+rt_void rt_Scene::render_adaa(rt_si32 index)
+{
+    rt_SIMD_CAMERA  *s_cam = tharr[index]->s_cam;
+    rt_SIMD_CONTEXT *s_ctx = tharr[index]->s_ctx;
+    rt_SIMD_INFOX   *s_inf = tharr[index]->s_inf;
+
+    rt_si32 i, k, n = 1 << ad_on, s = pfm->simd_width, m, x, y, b, e;
+    rt_si32 j0, j1, y0, y1, h0, h1, nb = (x_res + s - 1) / s;
+    rt_ui08 *msk, *row;
+    rt_ui64 *acc, v;
+
+    s_inf->frame  = ad_buf;
+    s_inf->tile_w = tile_w;
+    s_inf->tiles  = tiles;
+    s_inf->frm_u  = 1;
+
+    RT_SIMD_SET(s_cam->hor_u, (rt_real)s);
+    RT_SIMD_SET(s_cam->ver_u, (rt_real)1);
+
+    while ((k = fetch_add(&rband, 1)) < tiles_in_col)
+    {
+        y0 = k * tile_h;
+        y1 = RT_MIN(y0 + tile_h, y_res);
+
+        /* merge edge blocks of the band's rows into its first row,
+         * rows with edges are bounded by "h0", "h1" */
+        msk = ad_msk + y0 * x_row;
+        h0 = y1;
+        h1 = y0;
+
+        for (y = y0; y < y1; y++)
+        {
+            row = ad_msk + y * x_row;
+
+            for (b = 0; b < nb; b++)
+            {
+                if (row[b] != 0)
+                {
+                    msk[b] = 1;
+                    h0 = RT_MIN(h0, y);
+                    h1 = y + 1;
+                }
+            }
+        }
+
+        for (b = 0; b < nb && h0 < h1; b = e)
+        {
+            /* find next run of edge blocks */
+            for (; b < nb && msk[b] == 0; b++);
+            for (e = b; e < nb && msk[e] != 0; e++);
+
+            if (b == nb)
+            {
+                break;
+            }
+
+            j0 = b * s;
+            j1 = RT_MIN(e * s, x_res);
+
+            /* primary samples are already in the frame */
+            for (y = h0; y < h1; y++)
+            {
+                acc = ad_acc + y * x_row;
+
+                for (x = j0; x < j1; x++)
+                {
+                    acc[x] = ad_spr(frame[y * x_row + x]);
+                }
+            }
+
+            for (m = 1; m < n; m++)
+            {
+                s_inf->frm_i = h0;
+                s_inf->frm_h = h1;
+                s_inf->frm_j = j0;
+                s_inf->frm_w = j1;
+
+                for (i = 0; i < s; i++)
+                {
+                    s_cam->index[i] = i + j0;
+                    s_inf->hor_c[i] = (rt_real)(i + j0);
+
+                    s_inf->hor_i[i] = (rt_real)(i + j0);
+                    s_inf->ver_i[i] = (rt_real)h0;
+
+                    s_cam->hor_a[i] = (rt_real)ad_smp[ad_on - 1][m][0] / 16;
+                    s_cam->ver_a[i] = (rt_real)ad_smp[ad_on - 1][m][1] / 16;
+                }
+
+                s_inf->depth = depth;
+                RT_SIMD_SET(s_ctx->wmask, -1);
+
+                /* render samples based on tilebuffer */
+                pfm->render0(s_inf);
+
+                for (y = h0; y < h1; y++)
+                {
+                    acc = ad_acc + y * x_row;
+
+                    for (x = j0; x < j1; x++)
+                    {
+                        acc[x] += ad_spr(ad_buf[y * x_row + x]);
+                    }
+                }
+            }
+
+            for (y = h0; y < h1; y++)
+            {
+                acc = ad_acc + y * x_row;
+
+                for (x = j0; x < j1; x++)
+                {
+                    v = acc[x] >> ad_on;
+
+                    frame[y * x_row + x] = (frame[y * x_row + x] & 0xFF000000)
+                                         | (rt_ui32)(v >> 0x10 & 0xFF) << 0x10
+                                         | (rt_ui32)(v >> 0x20 & 0xFF) << 0x08
+                                         | (rt_ui32)(v >> 0x00 & 0xFF) << 0x00;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Update variance estimates of items with given "index" in path-tracer's
+ * adaptive sampling, pixel's mean luminance after "s" new samples of "n"
+ * is compared to the mean before them, its change scaled to the mean of
+ * the new samples "d" gives estimate of a single sample's variance as
+ * d^2 / (1/s + 1/(n-s)), tile's standard error of the mean is derived
+ * from average of its pixels' estimates (color-planes' elements).
+ */
+rt_void rt_Scene::render_ptcv(rt_si32 index)
+{
+    rt_real l, d, m, s, v, w;
+    rt_si32 k, t, j, y, x, x0, x1, y0, y1, o, u;
+
+    for (k = index; k < pt_num; k += thnum)
+    {
+        rt_si32 *itm = pt_itm + k * 4;
+
+        s = (rt_real)itm[3];
+
+        y0 = itm[0] * tile_h;
+        y1 = RT_MIN(y0 + tile_h, y_res);
+
+        for (j = itm[1]; j <= itm[2]; j++)
+        {
+            t = itm[0] * tiles_in_row + j;
+
+            /* samples before the frame and after it */
+            m = pt_cnt[t];
+            pt_cnt[t] = m + s;
+
+            u = pt_upd[t]++;
+            w = u > 0 ? (m + s) / s : 0.0f;
+            m = u > 0 ? 1.0f / (1.0f / s + 1.0f / m) : 0.0f;
+            v = 0.0f;
+
+            x0 = j * tile_w << pfm->fsaa;
+            x1 = RT_MIN(j * tile_w + tile_w, x_res) << pfm->fsaa;
+
+            for (y = y0; y < y1; y++)
+            {
+                o = y * x_row << pfm->fsaa;
+
+                for (x = x0 + o; x < x1 + o; x++)
+                {
+                    l = ptr_r[x] * 0.2126f
+                      + ptr_g[x] * 0.7152f
+                      + ptr_b[x] * 0.0722f;
+
+                    /* the first update only takes the mean */
+                    d = (l - ptr_l[x]) * w;
+                    ptr_v[x] = u > 0 ? ptr_v[x] + d * d * m : 0.0f;
+                    ptr_l[x] = l;
+
+                    v += ptr_v[x];
+                }
+            }
+
+            if (u > 0)
+            {
+                v /= (rt_real)(u * (y1 - y0) * (x1 - x0));
+                pt_err[t] = RT_SQRT(v / pt_cnt[t]);
+            }
+        }
+    }
+}
+
+/*
+ * Run denoiser's pass over rows of tiles with given "index", pass 0 gathers
+ * path-tracer's colors per pixel (clamped to limit bright samples' spread)
+ * along with the guide's colors of the first hits (once per accumulation),
+ * then each pass of the a-trous wavelet doubles its step (from 1 pixel)
+ * in the backend's filter (filter0), the last pass converts colors
+ * to the frame (to 1.0 limit). Taps' rows shifted by the step to the left
+ * and to the right are staged into SIMD-aligned rows for the filter.
+ */
+rt_void rt_Scene::render_dnse(rt_si32 index)
+{
+    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+    rt_SIMD_FILTER *s_flt = tharr[index]->s_flt;
+
+    rt_real h[3] = {0.25f, 0.5f, 0.25f}, *c, *d, *p, *t[3], *stg;
+    rt_real v[3];
+    rt_si32 n = x_row * y_res, e = 1 << pfm->fsaa, i, j, k, m, o, q, x, y;
+    rt_si32 s = 1 << RT_MAX(dn_pas - 1, 0), w = pfm->simd_width, y0, y1;
+    rt_elem *out;
+
+    /* passes alternate between the sets of color-planes,
+     * each set is followed by guide's color-planes */
+    c = dn_pln + 6 * n * ((dn_pas - 1) & 1);
+    d = dn_pln + 6 * n * (dn_pas & 1);
+
+    stg = dn_stg + 37 * x_row * index;
+    out = (rt_elem *)(stg + 36 * x_row);
+
+    if (dn_pas > 0)
+    {
+        /* luminance's sigma^2 follows noise's variance of the mean */
+        RT_SIMD_SET(s_flt->i_lum, RT_MAX(pts_c, 1.0f) / 16.0f);
+        RT_SIMD_SET(s_flt->i_gde, 255.0f * 255.0f
+                                  / (RT_DNSE_TOL * RT_DNSE_TOL));
+
+        RT_SIMD_SET(s_flt->l_red, 0.2126f);
+        RT_SIMD_SET(s_flt->l_grn, 0.7152f);
+        RT_SIMD_SET(s_flt->l_blu, 0.0722f);
+        RT_SIMD_SET(s_flt->c_clp, 255.0f);
+
+        RT_SIMD_SET(s_flt->s_stp, (rt_real)s);
+        RT_SIMD_SET(s_flt->h_sid, h[0]);
+        RT_SIMD_SET(s_flt->h_ctr, h[1]);
+        RT_SIMD_SET(s_flt->x_stp, (rt_real)w);
+        RT_SIMD_SET(s_flt->x_res, (rt_real)x_res);
+
+        s_flt->p_str[0] = n * sizeof(rt_real);
+        s_flt->s_str[0] = x_row * sizeof(rt_real);
+        s_flt->row_n[0] = x_row * sizeof(rt_real);
+        s_flt->g_sqr[0] = (opts & RT_OPTS_GAMMA) == 0;
+        s_flt->out_f[0] = dn_pas == dn_on ? out : RT_NULL;
+        s_flt->mode[0]  = RT_FILT_DNSE;
+
+        s_flt->lft_u[0] = stg + 0 * x_row;
+        s_flt->lft_c[0] = stg + 6 * x_row;
+        s_flt->lft_d[0] = stg + 12 * x_row;
+        s_flt->rgt_u[0] = stg + 18 * x_row;
+        s_flt->rgt_c[0] = stg + 24 * x_row;
+        s_flt->rgt_d[0] = stg + 30 * x_row;
+    }
+
+    for (m = index; m < tiles_in_col; m += thnum)
+    {
+        y0 = m * tile_h;
+        y1 = RT_MIN(y0 + tile_h, y_res);
+
+        for (y = y0; y < y1; y++)
+        {
+            o = y * x_row;
+
+            if (dn_pas == 0)
+            {
+                for (x = o; x < o + x_res; x++)
+                {
+                    v[0] = v[1] = v[2] = 0.0f;
+
+                    for (i = 0; i < e; i++)
+                    {
+                        v[0] += ptr_r[x * e + i];
+                        v[1] += ptr_g[x * e + i];
+                        v[2] += ptr_b[x * e + i];
+                    }
+
+                    for (i = 0; i < 3; i++)
+                    {
+                        d[i * n + x] = RT_MIN(v[i] / (rt_real)e, RT_DNSE_CAP);
+                    }
+                }
+
+                if (dn_val)
+                {
+                    continue;
+                }
+
+                /* guide's colors are kept in both sets,
+                 * captured samples are cleared for the next
+                 * accumulation (missed samples aren't stored) */
+                for (x = o; x < o + x_res; x++)
+                {
+                    for (i = 0; i < 3; i++)
+                    {
+                        p = dn_alb + i * 4 * n + x * e;
+                        v[i] = 0.0f;
+
+                        for (j = 0; j < e; j++)
+                        {
+                            v[i] += p[j];
+                            p[j] = 0.0f;
+                        }
+
+                        d[(3 + i) * n + x] = v[i] / (rt_real)e;
+                        c[(3 + i) * n + x] = v[i] / (rt_real)e;
+                    }
+                }
+
+                continue;
+            }
+
+            /* taps' rows outside of the frame have zero weight,
+             * the center tap always has non-zero weight */
+            for (j = 0; j < 3; j++)
+            {
+                q = y + (j - 1) * s;
+                v[j] = q < 0 || q >= y_res ? 0.0f : h[j];
+                q = q < 0 || q >= y_res ? y : q;
+
+                p = c + q * x_row;
+                k = RT_MAX(x_row - s, 0);
+
+                for (i = 0; i < 6; i++)
+                {
+                    memcpy(stg + (j * 6 + i) * x_row + s,
+                           p + i * n, k * sizeof(rt_real));
+                    memcpy(stg + ((3 + j) * 6 + i) * x_row,
+                           p + i * n + s, k * sizeof(rt_real));
+                }
+
+                t[j] = p;
+            }
+
+            s_flt->tap_u[0] = t[0];
+            s_flt->tap_c[0] = t[1];
+            s_flt->tap_d[0] = t[2];
+
+            RT_SIMD_SET(s_flt->h_rwu, v[0]);
+            RT_SIMD_SET(s_flt->h_rwc, v[1]);
+            RT_SIMD_SET(s_flt->h_rwd, v[2]);
+            s_flt->out_c[0] = d + o;
+
+            for (i = 0; i < w; i++)
+            {
+                s_flt->x_pos[i] = (rt_real)i;
+            }
+
+            pfm->filter0(s_inf);
+
+            if (dn_pas < dn_on)
+            {
+                continue;
+            }
+
+            for (x = 0; x < x_res; x++)
+            {
+                frame[o + x] = (frame[o + x] & 0xFF000000)
+                             | (rt_ui32)out[x];
+            }
+        }
+    }
+}
+
+/*
+ * Map "k"-th band in priority order to the row of tiles out of "n",
+ * bands are rendered from the center of the frame outwards.
+ */
+static
+rt_si32 prow(rt_si32 k, rt_si32 n)
+{
+    return (k & 1) != 0 ? n / 2 - (k + 1) / 2 : n / 2 + k / 2;
+}
+
+/*
+ * Render part of the frame for a given "time" within a time "budget"
+ * measured by "f_time" in the same units. Rows of tiles are rendered
+ * in priority order until the budget is spent (at least one per call),
+ * unfinished rows keep their previous contents. The next call resumes
+ * the same frame (its "time" is ignored) until all rows are complete.
+ * With regions of interest their spans of tiles are rendered in order.
+ * Return number of rows (spans) left, 0 when the frame is complete.
+ */
+rt_si32 rt_Scene::render_part(rt_time time, rt_time budget,
+                              rt_FUNC_TIME f_time)
+{
+    if (f_time == RT_NULL)
+    {
+        throw rt_Exception("progressive render requires timer function");
+    }
+
+    ptime = f_time() + budget;
+    this->f_time = f_time;
+
+    if (pstate == 0)
+    {
+        render_init(time);
+
+        pstate = 1;
+        pdone = 0;
+
+        /* checkerboard history isn't kept in progressive render */
+        cb_val = RT_FALSE;
+
+        /* reset rows stealing counter,
+         * also used as progressive render's cursor */
+        rband = 0;
+    }
+
+    /* number of bands in the frame (or in regions of interest) */
+    rt_si32 k = rects_num != 0 ? spans_num : tiles_in_col;
+
+#if RT_OPTS_RENDER_EXT0 != 0
+    if ((opts & RT_OPTS_RENDER_EXT0) == 0)
+    { /* -->---->-- skip render0 -->---->-- */
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+    /* multi-threaded render */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene()
+#if RT_OPTS_RENDER_EXT1 != 0
+    &&  (opts & RT_OPTS_RENDER_EXT1) == 0
+#endif /* RT_OPTS_RENDER_EXT1 */
+       )
+    {
+        this->f_render(tdata, thnum, 3);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        render_scene(this, -thnum, 3);
+    }
+
+    /* all bands handed out before the deadline are complete */
+    pdone = RT_MIN(rband, k);
+
+#if RT_OPTS_RENDER_EXT0 != 0
+    } /* --<----<-- skip render0 --<----<-- */
+    else
+    {
+        pdone = k;
+    }
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+    if (pdone < k)
+    {
+        return k - pdone;
+    }
+
+    /* each band has rendered "pt_on" samples,
+     * update path-tracer's samples counter once */
+    pts_c = pt_on ? pts_c + (rt_real)pt_on : 0.0f;
+
+    pstate = 0;
+
+    render_done();
+
+    return 0;
+}
+
+/*
+ * Update backend data structures for a given "time"
+ * before the frame is rendered.
+ */
+rt_void rt_Scene::render_init(rt_time time)
+{
+    rt_si32 i;
+
+    /* abandon progressive frame in progress,
+     * its lists are released or retained as usual */
+    if (pstate != 0)
+    {
+        pstate = 0;
+        render_done();
+    }
+
+    /* counters of the frame rendered in the pipeline
+     * are reset ahead of its update */
+    if (!pip_act)
+    {
+        /* drop frame pending in the pipeline */
+        if (pip_val)
+        {
+            reset_pipe();
+        }
+
+        reset_stats();
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    if ((opts & RT_OPTS_UPDATE_EXT0) == 0 || rootobj.time == -1)
+    { /* -->---->-- skip update1 -->---->-- */
+#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    /* print state init */
+    if (g_print)
+    {
+        RT_PRINT_STATE_INIT();
+        RT_PRINT_TIME(time);
+    }
+
+    /* update tilebuffer's layout
+     * if tile dimensions have changed */
+    if (tile_w != pfm->tile_w || tile_h != pfm->tile_h)
+    {
+        reset_tiles();
+    }
+
+    /* phase 0.5, hierarchical update of arrays' transform matrices */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT1 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT1) == 0
+#endif /* RT_OPTS_UPDATE_EXT1 */
+    &&  thnum > 1 && tsk_num > 1)
+    {
+        rt_Array   *arr;
+        rt_Camera  *cam;
+        rt_Light   *lgt;
+        rt_Surface *srf;
+
+        /* call animators ahead of the hierarchy traversal,
+         * so that no shared scene data is written by the tasks */
+        for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+        {
+            if (arr != root)
+            {
+                arr->update_anim(time);
+            }
+        }
+        for (cam = cam_head; cam != RT_NULL; cam = cam->next)
+        {
+            cam->update_anim(time);
+        }
+        for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+        {
+            lgt->update_anim(time);
+        }
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            srf->update_anim(time);
+        }
+
+        /* update the hierarchy above the tasks,
+         * saving tasks' arguments from their parents */
+        for (i = 0; i < tsk_num; i++)
+        {
+            tsk_arr[i]->tsk_mode = 1;
+        }
+
+        root->update_object(time, 0, RT_NULL, iden4);
+
+        /* phase ids 5 and 25 stand for phases 0.5 and 2.5 */
+        time_mark(RT_TMRS_SEQ);
+        this->f_update(tdata, thnum, 5);
+        time_mark(RT_TMRS_P05);
+
+        /* aggregate changed status from the tasks */
+        root->update_scnchg();
+
+        for (i = 0; i < tsk_num; i++)
+        {
+            tsk_arr[i]->tsk_mode = 0;
+        }
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        root->update_object(time, 0, RT_NULL, iden4);
+    }
+
+    if (pt_on && (root->scn_changed || pfm->fsaa != fsaa))
+    {
+        reset_color();
+    }
+
+    /* tiles' samples differ after adaptive sampling,
+     * other frames restart path-tracer's accumulation */
+    if (pt_on && pt_sep && !pt_act)
+    {
+        reset_color();
+    }
+
+    /* update current antialiasing mode per scene */
+    fsaa = pfm->fsaa;
+
+#if RT_OPTS_STATIC != 0
+    /* lists of the static frame cached from previous frame
+     * remain valid as long as nothing has changed in the hierarchy */
+    if ((opts & RT_OPTS_STATIC) == 0 || pending == 0 || g_print
+    ||  root->obj_changed || root->scn_changed || rcam != cam)
+    { /* -->---->-- static frame -->---->-- */
+#endif /* RT_OPTS_STATIC */
+
+    if (pending)
+    {
+        pending = 0;
+
+        /* release memory for temporary per-frame allocs */
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->release(tharr[i]->mpool);
+        }
+
+        release(mpool);
+    }
+
+    /* return pools' own chunks to the system if reservations
+     * have shrunk below half of the chunks' size */
+    trim(msize, RT_QUAD_ALIGN);
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->trim(tharr[i]->msize, RT_QUAD_ALIGN);
+    }
+
+    /* reserve memory for temporary per-frame allocs */
+    mpool = reserve(msize, RT_QUAD_ALIGN);
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->mpool = tharr[i]->reserve(tharr[i]->msize, RT_QUAD_ALIGN);
+    }
+
+    /* bind lists built below to current camera */
+    rcam = cam;
+
+    time_mark(RT_TMRS_SEQ);
+
+    /* 1st phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT1 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT1) == 0
+#endif /* RT_OPTS_UPDATE_EXT1 */
+       )
+    {
+        this->f_update(tdata, thnum, 1);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 1);
+    }
+
+    time_mark(RT_TMRS_PH1);
+
+    /* update ray positioning and steppers */
+    rt_real h, v;
+
+    RT_VEC3_SET(pos, cam->pos);
+    RT_VEC3_SET(hor, cam->hor);
+    RT_VEC3_SET(ver, cam->ver);
+    RT_VEC3_SET(nrm, cam->nrm);
+
+    h = -0.5f * 1.0f;
+    v = -0.5f * aspect;
+
+    /* aim rays at camera's top-left corner */
+    RT_VEC3_MUL_VAL1(dir, nrm, cam->pov);
+    RT_VEC3_MAD_VAL1(dir, hor, h);
+    RT_VEC3_MAD_VAL1(dir, ver, v);
+
+    /* update tile positioning and steppers */
+    RT_VEC3_ADD(org, pos, dir);
+
+    h = 1.0f / (factor * tile_w); /* x_res / tile_w */
+    v = 1.0f / (factor * tile_h); /* x_res / tile_h */
+
+    RT_VEC3_MUL_VAL1(htl, hor, h);
+    RT_VEC3_MUL_VAL1(vtl, ver, v);
+
+    /* balance surfaces between threads for phases 2 and 3
+     * based on update costs estimated in the previous frame */
+    reset_parts();
+
+    time_mark(RT_TMRS_SEQ);
+
+    /* 2nd phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 2);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 2);
+    }
+
+    time_mark(RT_TMRS_PH2);
+
+    /* phase 2.5, hierarchical update of arrays' bounds from surfaces */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+    &&  thnum > 1 && tsk_num > 1)
+    {
+        /* update bounds of the tasks first,
+         * then the hierarchy above the tasks */
+        this->f_update(tdata, thnum, 25);
+        time_mark(RT_TMRS_P25);
+
+        root->update_bounds();
+
+        for (i = 0; i < tsk_num; i++)
+        {
+            tsk_arr[i]->tsk_mode = 0;
+        }
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        root->update_bounds();
+    }
+
+    rt_Surface *srf;
+
+    /* update surfaces' node lists */
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        /* rebuild surface's node list (per-surface)
+         * based on transform flags and arrays' bounds */
+        tharr[0]->snode(srf);
+    }
+
+    /* rebuild global hierarchical list */
+    hlist = tharr[0]->ssort(RT_NULL);
+
+#if RT_OPTS_SHADOW != 0
+    if ((opts & RT_OPTS_SHADOW) != 0)
+    {
+        /* rebuild broad-phase for shadow lists,
+         * "hlist" is needed inside */
+        tharr[0]->bsort();
+    }
+#endif /* RT_OPTS_SHADOW */
+
+    /* rebuild global surface/node list */
+    slist = tharr[0]->ssort(RT_NULL);
+    tharr[0]->filter(RT_NULL, &slist);
+
+    /* rebuild global light/shadow list,
+     * "slist" is needed inside */
+    llist = tharr[0]->lsort(RT_NULL);
+
+    /* rebuild camera's surface/node list,
+     * "slist" is needed inside */
+    clist = tharr[0]->ssort(cam);
+
+    if (g_print)
+    {
+        RT_PRINT_GLB();
+        RT_PRINT_SRF_LST(slist);
+        RT_PRINT_LGT_LST(llist);
+        RT_PRINT_CAM(cam);
+        RT_PRINT_SRF_LST(clist);
+    }
+
+    time_mark(RT_TMRS_SEQ);
+
+    /* 3rd phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT3 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT3) == 0
+#endif /* RT_OPTS_UPDATE_EXT3 */
+       )
+    {
+        this->f_update(tdata, thnum, 3);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 3);
+    }
+
+    time_mark(RT_TMRS_PH3);
+
+    /* screen tiling */
+    rt_si32 tline, j;
+
+#if RT_OPTS_TILING != 0
+    if ((opts & RT_OPTS_TILING) != 0)
+    {
+        memset(tiles, 0, sizeof(rt_ELEM *) * tiles_in_row * tiles_in_col);
+
+        rt_ELEM *elm, *nxt, **ptr = &rlist;
+
+        rlist = RT_NULL;
+
+        /* build exact copy of reversed "clist" (should be cheap),
+         * trnode elements become tailing rather than heading,
+         * elements grouping for cached transform is retained */
+        for (nxt = clist; nxt != RT_NULL; nxt = nxt->next)
+        {
+            /* alloc new element as "nxt's" copy */
+            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+            elm->data = nxt->data;
+            elm->simd = nxt->simd;
+            elm->temp = nxt->temp;
+            /* insert element as list's head */
+            elm->next = *ptr;
+           *ptr = elm;
+        }
+
+        /* sort reversed "clist" far-to-near,
+         * so that tile lists are merged near-to-far */
+#if RT_OPTS_DEPTHS != 0
+        if ((opts & RT_OPTS_DEPTHS) != 0)
+        {
+            rt_Array *arr;
+
+            for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+            {
+                arr->tmin = RT_INF;
+            }
+
+            /* trnode's depth is the nearest of its surfaces */
+            for (elm = rlist; elm != RT_NULL; elm = elm->next)
+            {
+                rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+                if (!RT_IS_ARRAY(nd)
+                &&  nd->trnode != RT_NULL && nd->trnode != nd)
+                {
+                    arr = (rt_Array *)nd->trnode;
+                    arr->tmin = RT_MIN(arr->tmin, nd->tmin);
+                }
+            }
+
+            rlist = dsort(rlist);
+        }
+#endif /* RT_OPTS_DEPTHS */
+
+        time_mark(RT_TMRS_SEQ);
+
+        /* merge surfaces' tile lists in multi-threaded update,
+         * each thread owns a band of tile rows in the tilebuffer */
+#if RT_OPTS_THREAD != 0
+        if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene()
+        &&  !g_print && thnum > 1)
+        {
+            this->f_update(tdata, thnum, 4);
+        }
+        else
+#endif /* RT_OPTS_THREAD */
+        {
+            update_scene(this, -thnum, 4);
+        }
+
+        time_mark(RT_TMRS_TLS);
+
+        if (g_print)
+        {
+            rt_si32 i = 0, j = 0;
+
+            tline = i * tiles_in_row;
+
+            RT_PRINT_TLS_LST(tiles[tline + j], i, j);
+        }
+    }
+    else
+#endif /* RT_OPTS_TILING */
+    {
+        for (i = 0; i < tiles_in_col; i++)
+        {
+            tline = i * tiles_in_row;
+
+            for (j = 0; j < tiles_in_row; j++)
+            {
+                tiles[tline + j] = clist;
+            }
+        }
+    }
+
+    /* update depth bounds for tile lists */
+    reset_depth();
+
+    /* aim rays at pixel centers */
+    RT_VEC3_MUL_VAL1(hor, hor, factor);
+    RT_VEC3_MUL_VAL1(ver, ver, factor);
+
+    RT_VEC3_MAD_VAL1(dir, hor, 0.5f);
+    RT_VEC3_MAD_VAL1(dir, ver, 0.5f);
+
+    /* accumulate ambient from camera and all light sources */
+    RT_VEC3_MUL_VAL1(amb, cam->cam->col.hdr, cam->cam->lum[0]);
+    amb[RT_A] = cam->cam->lum[0];
+
+    rt_Light *lgt = RT_NULL;
+
+    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        RT_VEC3_MAD_VAL1(amb, lgt->lgt->col.hdr, lgt->lgt->lum[0]);
+        amb[RT_A] += lgt->lgt->lum[0];
+    }
+
+#if RT_OPTS_STATIC != 0
+    } /* --<----<-- static frame --<----<-- */
+#endif /* RT_OPTS_STATIC */
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    } /* --<----<-- skip update1 --<----<-- */
+#endif /* RT_OPTS_UPDATE_EXT0 */
+}
+
+/*
+ * Finalize backend data structures
+ * after the frame has been rendered.
+ */
+rt_void rt_Scene::render_done()
+{
+    rt_si32 i;
+
+#if RT_FEAT_STATS
+    /* sum up threads' ray counters of the frame */
+    memset(st_arr, 0, sizeof(st_arr));
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SIMD_INFOX *s_inf = tharr[i]->s_inf;
+
+        st_arr[RT_STAT_PRM] += s_inf->cnt_p;
+        st_arr[RT_STAT_SHD] += s_inf->cnt_s;
+        st_arr[RT_STAT_RFL] += s_inf->cnt_f;
+        st_arr[RT_STAT_RFR] += s_inf->cnt_t;
+        st_arr[RT_STAT_PTR] += s_inf->cnt_d;
+        st_arr[RT_STAT_SRF] += s_inf->cnt_q;
+        st_arr[RT_STAT_CLP] += s_inf->cnt_c;
+    }
+#endif /* RT_FEAT_STATS */
+
+    /* publish tiles' render cost of the frame,
+     * restart accumulation for the next frame */
+    if (hm_on)
+    {
+        for (i = 0; i < tiles_in_row * tiles_in_col; i++)
+        {
+            hm_buf[i] = (rt_real)hm_acc[i];
+            hm_acc[i] = 0;
+        }
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    if ((opts & RT_OPTS_UPDATE_EXT0) == 0)
+    { /* -->---->-- skip update2 -->---->-- */
+#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    /* print state done */
+    if (g_print)
+    {
+        RT_PRINT_STATE_DONE();
+        g_print = RT_FALSE;
+    }
+
+    /* adapt per-frame pools to actual usage */
+    reset_msize();
+
+#if RT_OPTS_STATIC != 0
+    if ((opts & RT_OPTS_STATIC) != 0 && !pip_act)
+    {
+        /* keep memory for per-frame allocs reserved,
+         * so that lists are cached for the next static frame */
+        pending = 1;
+    }
+    else
+#endif /* RT_OPTS_STATIC */
+    {
+        /* release memory for temporary per-frame allocs */
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->release(tharr[i]->mpool);
+        }
+
+        release(mpool);
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    } /* --<----<-- skip update2 --<----<-- */
+    else
+    {
+        pending = 1;
+    }
+#endif /* RT_OPTS_UPDATE_EXT0 */
+}
+
+/*
+ * Map update phase's id to its timer slot.
+ */
+static
+rt_si32 tmr_slot(rt_si32 phase)
+{
+    switch (phase)
+    {
+        case 5:
+        return RT_TMRS_P05;
+        case 1:
+        return RT_TMRS_PH1;
+        case 2:
+        return RT_TMRS_PH2;
+        case 25:
+        return RT_TMRS_P25;
+        case 3:
+        return RT_TMRS_PH3;
+        case 4:
+        return RT_TMRS_TLS;
+        default:
+        return RT_TMRS_SEQ;
+    }
+}
+
+/*
+ * Update portion of the scene with given "index"
+ * as part of the multi-threaded update.
+ */
+rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
+{
+    rt_si32 i;
+
+    rt_Array   *arr;
+    rt_Camera  *cam;
+    rt_Light   *lgt;
+    rt_Surface *srf;
+
+    /* time thread's slice of the phase */
+    rt_time tmr = tmr_cur != RT_NULL ? f_tick() : 0;
+
+    if (phase == 5)
+    {
+        for (i = 0; i < tsk_num; i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* update array's subtree transform matrices
+             * from parent array's transform matrix
+             * updated in sequential part of phase 0.5 */
+            tsk_arr[i]->update_task();
+        }
+    }
+    else
+    if (phase == 25)
+    {
+        for (i = 0; i < tsk_num; i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            arr = tsk_arr[i];
+
+            /* update array's subtree bounds separately only if
+             * its own trnode (if any) and all of its sub-objects'
+             * trnodes and bvnodes are found within its subtree */
+            if (arr->tsk_local
+            && (arr->trnode == RT_NULL || arr->trnode == arr))
+            {
+                arr->tsk_mode = 2;
+                arr->update_task();
+            }
+        }
+    }
+    else
+    if (phase == 4)
+    {
+        rt_ELEM *elm;
+
+        /* traverse reversed "clist" to keep original "clist's" order
+         * and optimize trnode handling for each tile */
+        for (elm = rlist; elm != RT_NULL; elm = elm->next)
+        {
+            rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+            /* skip trnode elements from reversed "clist"
+             * as they are handled separately for each tile */
+            if (RT_IS_ARRAY(nd))
+            {
+                continue;
+            }
+
+            srf = (rt_Surface *)nd;
+
+            /* merge surface's tile list for the band of tile rows
+             * owned by the thread, split in 2nd phase above */
+            tharr[index]->smerge(srf, srf->tlb[index]);
+        }
+    }
+    else
+    if (phase == 1)
+    {
+        for (arr = arr_head, i = 0; arr != RT_NULL; arr = arr->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* update array's fields from transform matrix
+             * updated in multi-tasked phase 0.5 */
+            arr->update_fields();
+        }
+
+        for (cam = cam_head, i = 0; cam != RT_NULL; cam = cam->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* update camera's fields and transform matrix
+             * from parent array's transform matrix
+             * updated in multi-tasked phase 0.5 */
+            cam->update_fields();
+        }
+
+        for (lgt = lgt_head, i = 0; lgt != RT_NULL; lgt = lgt->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* update light's fields and transform matrix
+             * from parent array's transform matrix
+             * updated in multi-tasked phase 0.5 */
+            lgt->update_fields();
+        }
+
+        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* update surface's fields and transform matrix
+             * from parent array's transform matrix
+             * updated in multi-tasked phase 0.5 */
+            srf->update_fields();
+        }
+    }
+    else
+    if (phase == 2)
+    {
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            if (srf->part[0] != index)
+            {
+                continue;
+            }
+
+            /* rebuild surface's clip list (cross-surface)
+             * based on transform flags updated in 1st phase above */
+            tharr[index]->sclip(srf);
+
+            /* update surface's bounds taking into account surfaces
+             * from custom clippers list updated above */
+            srf->update_bounds();
+
+            /* rebuild surface's tile list (per-surface)
+             * based on surface bounds updated above */
+            tharr[index]->stile(srf);
+
+            /* split surface's tile list into bands of tile rows
+             * for multi-threaded tiling after 3rd phase below */
+            tharr[index]->sband(srf);
+
+            /* estimate surface's cost in 2nd phase for the next frame
+             * from the lengths of the lists rebuilt above */
+            srf->cost[0] = 1 + count((rt_ELEM *)srf->s_srf->msc_p[2])
+                             + count(srf->tls);
+        }
+    }
+    else
+    if (phase == 3)
+    {
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            if (srf->part[1] != index)
+            {
+                continue;
+            }
+
+            if (g_print)
+            {
+                RT_PRINT_SRF(srf);
+            }
+
+            /* rebuild surface's rfl/rfr surface lists (cross-surface)
+             * based on surface bounds updated in 2nd phase above
+             * and array bounds updated in multi-tasked phase 2.5 */
+            tharr[index]->ssort(srf);
+
+            /* rebuild surface's light/shadow lists (cross-surface)
+             * based on surface bounds updated in 2nd phase above
+             * and array bounds updated in multi-tasked phase 2.5 */
+            tharr[index]->lsort(srf);
+
+            /* estimate surface's cost in 3rd phase for the next frame
+             * from the lengths of the lists rebuilt above */
+            srf->cost[1] = 1 + count((rt_ELEM *)srf->s_srf->lst_p[0])
+                             + count((rt_ELEM *)srf->s_srf->lst_p[1])
+                             + count((rt_ELEM *)srf->s_srf->lst_p[2])
+                             + count((rt_ELEM *)srf->s_srf->lst_p[3]);
+
+            /* update surface's backend-related parts */
+            pfm->update0(srf->s_srf);
+
+#if 0 /* SIMD-buffers don't normally require reset between frames */
+            memset(srf->s_srf->msc_p[0], 255, RT_BUFFER_POOL*thnum);
+#endif /* enable for SIMD-buffers as a debug option if needed */
+        }
+    }
+
+    if (tmr_cur != RT_NULL)
+    {
+        tmr_cur->busy[index * RT_TMRS_NUM + tmr_slot(phase)] += f_tick() - tmr;
+    }
+
+    /* fill thread's wait for the rest of the update run
+     * with bands of the frame pending in the pipeline */
+    if (pip_run)
+    {
+        tharr[index]->pip_end = (fetch_add(&pip_cnt, 1) / thnum + 1) * thnum;
+
+        render_slice(index, 11);
+    }
+}
+
+/*
+ * Render portion of the frame with given "index"
+ * as part of the multi-threaded render.
+ */
+rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
+{
+    if (tmr_cur == RT_NULL)
+    {
+        render_phase(index, phase);
+
+        return;
+    }
+
+    /* time thread's slice of the render pass */
+    rt_time tmr = f_tick();
+
+    render_phase(index, phase);
+
+    tmr_cur->busy[index * RT_TMRS_NUM + RT_TMRS_RND] += f_tick() - tmr;
+}
+
+/*
+ * Render portion of the frame with given "index"
+ * for a given "phase" of the render (see render_slice).
+ */
+rt_void rt_Scene::render_phase(rt_si32 index, rt_si32 phase)
+{
+    /* adjust ray steppers according to antialiasing mode */
+    rt_real fha[RT_SIMD_WIDTH], fhi[RT_SIMD_WIDTH], fhu; /* h - hor */
+    rt_real fva[RT_SIMD_WIDTH], fvi[RT_SIMD_WIDTH], fvu; /* v - ver */
+    rt_si32 i, n;
+
+    /* render portions of all scenes in the batch,
+     * threads start at different scenes to spread
+     * rows stealing across scenes' counters */
+    if (phase == 2)
+    {
+        rt_si32 k = pfm->bat_num;
+
+        n = index * k / thnum;
+
+        for (i = 0; i < k; i++)
+        {
+            rt_Scene *scn = pfm->bat_arr[(n + i) % k];
+
+            if (scn->bat_on)
+            {
+                scn->render_slice(index, 1);
+            }
+        }
+
+        return;
+    }
+
+    /* reconstruct frame in checkerboard mode */
+    if (phase == 4)
+    {
+        render_cbrd(index);
+
+        return;
+    }
+
+    /* upsample low-rate items in variable-rate render */
+    if (phase == 5)
+    {
+        render_rate(index);
+
+        return;
+    }
+
+    /* mark edge blocks for adaptive antialiasing */
+    if (phase == 6)
+    {
+        render_edge(index);
+
+        return;
+    }
+
+    /* update variance estimates for adaptive sampling */
+    if (phase == 8)
+    {
+        render_ptcv(index);
+
+        return;
+    }
+
+    /* run denoiser's pass over path-tracer's colors */
+    if (phase == 10)
+    {
+        render_dnse(index);
+
+        return;
+    }
+
+    if (pfm->fsaa == RT_FSAA_NO)
+    {
+        for (i = 0; i < pfm->simd_width; i++)
+        {
+            fha[i] = 0.0f;
+            fva[i] = 0.0f;
+
+            fhi[i] = (rt_real)i;
+            fvi[i] = 0.0f;
+        }
+
+        fhu = (rt_real)(pfm->simd_width);
+        fvu = (rt_real)thnum;
+    }
+    else
+    if (pfm->fsaa == RT_FSAA_2X) /* alternating */
+    {
+        rt_real as = 0.25f;
+#if RT_FSAA_REGULAR
+        rt_real ar = 0.00f;
+#else /* RT_FSAA_REGULAR */
+        rt_real ar = 0.08f;
+#endif /* RT_FSAA_REGULAR */
+
+        for (i = 0; i < pfm->simd_width / 4; i++)
+        {
+            fha[i*4+0] = (-ar+as);
+            fha[i*4+1] = (+ar-as);
+            fha[i*4+2] = (+ar-as);
+            fha[i*4+3] = (-ar+as);
+
+            fva[i*4+0] = (+ar+as);
+            fva[i*4+1] = (-ar-as);
+            fva[i*4+2] = (+ar+as);
+            fva[i*4+3] = (-ar-as);
+
+            fhi[i*4+0] = (rt_real)(i*2+0);
+            fhi[i*4+1] = (rt_real)(i*2+0);
+            fhi[i*4+2] = (rt_real)(i*2+1);
+            fhi[i*4+3] = (rt_real)(i*2+1);
+
+            fvi[i*4+0] = 0.0f;
+            fvi[i*4+1] = 0.0f;
+            fvi[i*4+2] = 0.0f;
+            fvi[i*4+3] = 0.0f;
+        }
+
+        fhu = (rt_real)(pfm->simd_width / 2);
+        fvu = (rt_real)thnum;
+    }
+    else
+    if (pfm->fsaa == RT_FSAA_4X)
+    {
+        rt_real as = 0.25f;
+#if RT_FSAA_REGULAR
+        rt_real ar = 0.00f;
+#else /* RT_FSAA_REGULAR */
+        rt_real ar = 0.08f;
+#endif /* RT_FSAA_REGULAR */
+
+        for (i = 0; i < pfm->simd_width / 4; i++)
+        {
+            fha[i*4+0] = (-ar-as);
+            fha[i*4+1] = (-ar+as);
+            fha[i*4+2] = (+ar-as);
+            fha[i*4+3] = (+ar+as);
+
+            fva[i*4+0] = (+ar-as);
+            fva[i*4+1] = (-ar-as);
+            fva[i*4+2] = (+ar+as);
+            fva[i*4+3] = (-ar+as);
+
+            fhi[i*4+0] = (rt_real)i;
+            fhi[i*4+1] = (rt_real)i;
+            fhi[i*4+2] = (rt_real)i;
+            fhi[i*4+3] = (rt_real)i;
+
+            fvi[i*4+0] = 0.0f;
+            fvi[i*4+1] = 0.0f;
+            fvi[i*4+2] = 0.0f;
+            fvi[i*4+3] = 0.0f;
+        }
+
+        fhu = (rt_real)(pfm->simd_width / 4);
+        fvu = (rt_real)thnum;
+    }
+    else
+    if (pfm->fsaa == RT_FSAA_8X) /* 8x reserved */
+    {
+        ;
+    }
+
+    /* rows are either interleaved between threads
+     * or rendered consecutively within stolen bands,
+     * progressive (phase 3) and pipelined (phase 11) render
+     * and regions of interest always steal bands (spans of tiles),
+     * variable-rate render and path-tracer's adaptive sampling
+     * steal their items of tiles */
+    rt_si32 frm_i = index, frm_u = thnum, frm_h = y_res, frm_j = 0, k;
+    rt_si32 frm_w = x_res, steal = phase == 3 || phase == 11
+                                || rects_num != 0 || cb_act;
+    rt_si32 bands = rects_num != 0 ? spans_num : tiles_in_col, c;
+    rt_si32 frm_s = 0, trj, trw, vx, vy, o;
+    rt_si32 pie = phase == 11 ? tharr[index]->pip_end : 0;
+    rt_real ptc = pts_c;
+
+    if (vr_act)
+    {
+        steal = 1;
+        bands = vr_num;
+    }
+    else
+    if (pt_act)
+    {
+        steal = 1;
+        bands = pt_num;
+    }
+
+#if RT_OPTS_STEAL != 0
+    if ((opts & RT_OPTS_STEAL) != 0)
+    {
+        steal = 1;
+    }
+#endif /* RT_OPTS_STEAL */
+
+    /* heatmap times stolen items, plain bands of rows
+     * are split into single tiles, other items' time
+     * is spread evenly over their tiles, path-tracer's
+     * seeds of single tiles start at their own columns */
+    rt_si32 hmt = hm_on && !vr_act && !pt_act && !cb_act && rects_num == 0
+                        && phase != 3 && phase != 11;
+    rt_time hms = 0;
+
+    if (hm_on)
+    {
+        steal = 1;
+    }
+
+    if (hmt)
+    {
+        bands = tiles_in_row * tiles_in_col;
+    }
+
+    if (steal)
+    {
+        frm_u = 1;
+        fvu = (rt_real)frm_u;
+    }
+
+    /* checkerboard traces every other pixel of each row into
+     * half-width rows, rows of a band are traced in two passes */
+    rt_real fhs = (rt_real)(1 + cb_act);
+
+    if (cb_act)
+    {
+        fhu *= fhs;
+        frm_u = 2;
+        fvu = (rt_real)frm_u;
+    }
+
+    /* pipelined render (phase 11) takes the camera,
+     * lists and tilebuffer of the pending frame */
+    rt_si32 pip = phase == 11;
+    rt_real *r_pos = pip ? pip_pos : pos;
+    rt_real *r_dir = pip ? pip_dir : dir;
+    rt_real *r_hor = pip ? pip_hor : hor;
+    rt_real *r_ver = pip ? pip_ver : ver;
+    rt_real *r_amb = pip ? pip_amb : amb;
+
+/*  rt_SIMD_CAMERA */
+
+    rt_SIMD_CAMERA *s_cam = tharr[index]->s_cam;
+
+    RT_SIMD_SET(s_cam->t_max, RT_INF);
+
+    RT_SIMD_SET(s_cam->dir_x, r_dir[RT_X]);
+    RT_SIMD_SET(s_cam->dir_y, r_dir[RT_Y]);
+    RT_SIMD_SET(s_cam->dir_z, r_dir[RT_Z]);
+
+    RT_SIMD_SET(s_cam->hor_x, r_hor[RT_X]);
+    RT_SIMD_SET(s_cam->hor_y, r_hor[RT_Y]);
+    RT_SIMD_SET(s_cam->hor_z, r_hor[RT_Z]);
+
+    RT_SIMD_SET(s_cam->ver_x, r_ver[RT_X]);
+    RT_SIMD_SET(s_cam->ver_y, r_ver[RT_Y]);
+    RT_SIMD_SET(s_cam->ver_z, r_ver[RT_Z]);
+
+    RT_SIMD_SET(s_cam->hor_u, fhu);
+    RT_SIMD_SET(s_cam->ver_u, fvu);
+
+    RT_SIMD_SET(s_cam->clamp, (rt_real)255);
+    RT_SIMD_SET(s_cam->cmask, (rt_elem)255);
+
+    RT_SIMD_SET(s_cam->col_r, r_amb[RT_R]);
+    RT_SIMD_SET(s_cam->col_g, r_amb[RT_G]);
+    RT_SIMD_SET(s_cam->col_b, r_amb[RT_B]);
+    RT_SIMD_SET(s_cam->l_amb, r_amb[RT_A]);
+
+    RT_SIMD_SET(s_cam->x_row, (rt_real)(x_row << pfm->fsaa));
+    RT_SIMD_SET(s_cam->idx_h, pfm->simd_width);
+
+/*  rt_SIMD_CONTEXT */
+
+    rt_SIMD_CONTEXT *s_ctx = tharr[index]->s_ctx;
+
+    s_ctx->param[1] = -((opts & RT_OPTS_GAMMA) == 0) & RT_PROP_GAMMA;
+    RT_SIMD_SET(s_ctx->t_min, pip ? pip_pov : cam->pov);
+    RT_SIMD_SET(s_ctx->wmask, -1);
+
+    RT_SIMD_SET(s_ctx->org_x, r_pos[RT_X]);
+    RT_SIMD_SET(s_ctx->org_y, r_pos[RT_Y]);
+    RT_SIMD_SET(s_ctx->org_z, r_pos[RT_Z]);
+
+/*  rt_SIMD_INFOX */
+
+    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+
+    s_inf->ctx = s_ctx;
+    s_inf->cam = s_cam;
+    s_inf->lst = pip ? pip_lst : clist;
+
+    s_inf->thndx = index;
+    s_inf->thnum = thnum;
+    s_inf->depth = depth;
+    s_inf->fsaa  = pfm->fsaa;
+
+    s_inf->pt_on = pt_on;
+
+    s_inf->frm_u = frm_u;
+
+    s_inf->frame  = cb_act ? cb_hlf : frame;
+    s_inf->tile_w = cb_act ? tile_w / 2 : tile_w;
+    s_inf->tiles  = pip ? pip_tls : tiles;
+
+    s_inf->ptr_r  = ptr_r;
+    s_inf->ptr_g  = ptr_g;
+    s_inf->ptr_b  = ptr_b;
+
+    /* checkerboard keeps traced pixels' depth for reprojection */
+    s_inf->ptr_t  = cb_act ? cb_dep : RT_NULL;
+
+    /* denoiser's guide is captured once per accumulation
+     * from first hits of path-tracer's samples */
+    s_inf->alb_r  = dn_act && !dn_val ? dn_alb : RT_NULL;
+    s_inf->alb_g  = dn_act ? dn_alb + 4 * x_row * y_res : RT_NULL;
+    s_inf->alb_b  = dn_act ? dn_alb + 8 * x_row * y_res : RT_NULL;
+
+    /* re-trace edge blocks for adaptive antialiasing */
+    if (phase == 7)
+    {
+        render_adaa(index);
+
+        return;
+    }
+
+    do
+    {
+        if (steal)
+        {
+            /* progressive render steals bands until the deadline,
+             * empty bands are skipped as samples are counted once */
+            if (phase == 3
+            && (rband >= bands || (rband > pdone && f_time() >= ptime)))
+            {
+                break;
+            }
+
+            /* pipelined render steals bands within update run
+             * until all of its slices are done, empty bands
+             * are left to the run after the update */
+            if (pie != 0 && (rband >= bands || pip_cnt >= pie))
+            {
+                break;
+            }
+
+            k = fetch_add(&rband, 1);
+
+            if ((phase == 3 || pie != 0) && k >= bands)
+            {
+                break;
+            }
+
+            /* steal next band of rows, the last (empty) band
+             * still updates path-tracer's samples counter */
+            frm_i = y_res;
+
+            if (vr_act && k < bands)
+            {
+                frm_i = vr_itm[k * 4 + 0] * tile_h;
+                frm_j = vr_itm[k * 4 + 1] * tile_w;
+                frm_w = RT_MIN(vr_itm[k * 4 + 2] * tile_w + tile_w, x_res);
+                frm_s = vr_itm[k * 4 + 3];
+            }
+            else
+            if (pt_act && k < bands)
+            {
+                frm_i = pt_itm[k * 4 + 0] * tile_h;
+                frm_j = pt_itm[k * 4 + 1] * tile_w;
+                frm_w = RT_MIN(pt_itm[k * 4 + 2] * tile_w + tile_w, x_res);
+                frm_s = pt_itm[k * 4 + 3];
+
+                /* item's tiles share their samples counter */
+                ptc = pt_cnt[pt_itm[k * 4 + 0] * tiles_in_row
+                           + pt_itm[k * 4 + 1]];
+            }
+            else
+            if (rects_num != 0 && k < bands)
+            {
+                frm_i = spans[k * 3 + 0] * tile_h;
+                frm_j = spans[k * 3 + 1] * tile_w;
+                frm_w = RT_MIN(spans[k * 3 + 2] * tile_w + tile_w, x_res);
+            }
+            else
+            if (hmt && k < bands)
+            {
+                frm_i = (k / tiles_in_row) * tile_h;
+                frm_j = (k % tiles_in_row) * tile_w;
+                frm_w = RT_MIN(frm_j + tile_w, x_res);
+            }
+            else
+            if (k < bands)
+            {
+                /* progressive render takes rows in priority order */
+                frm_i = (phase == 3 ? prow(k, bands) : k) * tile_h;
+            }
+
+            frm_h = RT_MIN(frm_i + tile_h, y_res);
+        }
+
+        trj = frm_j;
+        trw = cb_act ? (frm_w + 1) / 2 : frm_w;
+
+        /* variable-rate items below full rate trace every "vx"-th
+         * pixel of every "vy"-th row into compacted rows of scratch
+         * buffer at item's own columns, tiles and color-planes are
+         * then addressed from item's first column */
+        if (vr_act)
+        {
+            vx = vr_step[frm_s][0];
+            vy = vr_step[frm_s][1];
+            o = frm_s != 0 ? frm_j : 0;
+
+            trj = frm_j - o;
+            trw = trj + (frm_w - frm_j + vx - 1) / vx;
+
+            s_inf->frame  = (frm_s != 0 ? vr_buf : frame) + o;
+            s_inf->tile_w = tile_w / vx;
+            s_inf->tiles  = tiles + o / tile_w;
+
+            if (ptr_r != RT_NULL)
+            {
+                s_inf->ptr_r = ptr_r + (o << pfm->fsaa);
+                s_inf->ptr_g = ptr_g + (o << pfm->fsaa);
+                s_inf->ptr_b = ptr_b + (o << pfm->fsaa);
+            }
+
+            s_inf->frm_u = vy;
+            fhs = (rt_real)vx;
+
+            RT_SIMD_SET(s_cam->hor_u, fhu * fhs);
+            RT_SIMD_SET(s_cam->ver_u, (rt_real)vy);
+        }
+
+        if (hm_on)
+        {
+            hms = f_cost();
+        }
+
+        for (c = 0; c <= cb_act; c++)
+        {
+            /* checkerboard's offset of traced pixels in the pass */
+            rt_real fhc = (rt_real)(cb_act & (frm_i + c + cb_par));
+
+            s_inf->frm_i = frm_i + c;
+            s_inf->frm_h = frm_h;
+            s_inf->frm_j = trj;
+            s_inf->frm_w = trw;
+
+            RT_SIMD_SET(s_inf->pts_c, ptc);
+
+            for (n = pt_act && frm_i < y_res ? frm_s : RT_MAX(1, pt_on);
+                 n > 0; n--)
+            {
+                /* use of integer indices for primary rays update
+                 * makes related fp-math independent from SIMD width */
+                for (i = 0; i < pfm->simd_width; i++)
+                {
+                    s_cam->index[i] = i + (trj << pfm->fsaa);
+                    s_inf->hor_c[i] = fhi[i] * fhs + fhc + (rt_real)frm_j;
+
+                    s_inf->hor_i[i] = fhi[i] * fhs + fhc + (rt_real)frm_j;
+                    s_inf->ver_i[i] = fvi[i] + (rt_real)(frm_i + c);
+
+                    s_cam->hor_a[i] = fha[i];
+                    s_cam->ver_a[i] = fva[i];
+                }
+
+                s_inf->depth = depth;
+                RT_SIMD_SET(s_ctx->wmask, -1);
+
+                /* render frame based on tilebuffer */
+                pfm->render0(s_inf);
+            }
+        }
+
+        /* stolen items don't share tiles within a phase */
+        if (hm_on && frm_i < y_res)
+        {
+            rt_time *acc = hm_acc + (frm_i / tile_h) * tiles_in_row;
+            rt_si32 hmj = frm_j / tile_w, hmn = (frm_w - 1) / tile_w;
+
+            hms = (f_cost() - hms) / (hmn - hmj + 1);
+
+            for (c = hmj; c <= hmn; c++)
+            {
+                acc[c] += hms;
+            }
+        }
+    }
+    while (steal && frm_i < frm_h);
+}
+
+/*
+ * Return framebuffer's stride in pixels.
+ */
+rt_si32 rt_Scene::get_x_row()
+{
+    return x_row;
+}
+
+/*
+ * Return 1 if the row of tiles with given index is complete
+ * in current (or last) frame of progressive render, 0 otherwise.
+ */
+rt_si32 rt_Scene::get_row_done(rt_si32 row)
+{
+    rt_si32 n = tiles_in_col, k;
+
+    if (row < 0 || row >= n)
+    {
+        return 0;
+    }
+
+    /* row is complete when its last span is */
+    if (rects_num != 0)
+    {
+        return srows[row] < srows[row + 1] && srows[row + 1] <= pdone;
+    }
+
+    /* inverse of the priority order in prow */
+    k = row >= n / 2 ? (row - n / 2) * 2 : (n / 2 - row) * 2 - 1;
+
+    return k < pdone;
+}
+
+/*
+ * Print current state during next render-call.
+ * Has global scope and effect on any instance.
+ * The flag is reset upon rendering completion.
+ */
+rt_void rt_Scene::print_state()
+{
+    g_print = RT_TRUE;
+}
+
+/*
+ * Generate next random number using XX-bit LCG method.
+ */
+static
+rt_ui64 randomXX(rt_ui64 seed)
+{
+#if RT_PRNG != LCG48
+
+    /* use 48-bit seeding to decorrelate lesser LCG */
+    return (seed * LL(25214903917) + 11) & LL(0x0000FFFFFFFFFFFF);
+
+#else /* RT_PRNG == LCG48 */
+
+    /* use 32-bit seeding to decorrelate 48-bit LCG */
+    return (seed * 214013 + 2531011) & 0xFFFFFFFF;
+
+#endif /* RT_PRNG == LCG48 */
+}
+
+/*
+ * Reset current state of framebuffer's seed-plane for path-tracer.
+ */
+rt_void rt_Scene::reset_pseed()
+{
+    if ((opts & RT_OPTS_PT) != 0)
+    {
+        return;
+    }
+
+    rt_si32 k, n = 4 * x_row * y_res;
+    rt_ui64 seed = 1;
+
+    for (k = 0; k < n; k++)
+    {
+        seed = randomXX(seed);
+        pseed[k] = (rt_elem)seed;
+    }
+}
+
+/*
+ * Reset current state of framebuffer's color-planes for path-tracer.
+ */
+rt_void rt_Scene::reset_color()
+{
+    if ((opts & RT_OPTS_PT) != 0)
+    {
+        return;
+    }
+
+    pts_c = 0.0f;
+    pt_sep = RT_FALSE;
+    dn_val = RT_FALSE;
+
+    memset(ptr_r, 0, 4 * x_row * y_res * sizeof(rt_real));
+    memset(ptr_g, 0, 4 * x_row * y_res * sizeof(rt_real));
+    memset(ptr_b, 0, 4 * x_row * y_res * sizeof(rt_real));
+}
+
+/*
+ * Partition surfaces between threads for update phases 2 and 3,
+ * contiguous runs of the surface list get about the same total cost.
+ */
+rt_void rt_Scene::reset_parts()
+{
+    rt_Surface *srf;
+    rt_si32 k;
+
+    for (k = 0; k < 2; k++)
+    {
+        rt_ui64 acc = 0, sum = 0;
+
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            sum += srf->cost[k];
+        }
+
+        /* thread index is taken from the middle of surface's cost range,
+         * so that expensive surfaces are not piled up at range's ends */
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            srf->part[k] = (rt_si32)
+                ((acc * 2 + srf->cost[k]) * thnum / (sum * 2 + 1));
+
+            acc += srf->cost[k];
+        }
+    }
+}
+
+/*
+ * Update surfaces' depth bounds for primary rays to leave tile lists early,
+ * bounds are reset if tile lists are not sorted front-to-back by depth.
+ */
+rt_void rt_Scene::reset_depth()
+{
+    rt_Surface *srf;
+
+#if RT_OPTS_TILING != 0 && RT_OPTS_DEPTHS != 0
+    if ((opts & RT_OPTS_TILING) != 0 && (opts & RT_OPTS_DEPTHS) != 0)
+    {
+        rt_ELEM *elm;
+        rt_real tmin = RT_INF;
+
+        /* reversed "clist" goes far-to-near, thus surface's bound
+         * is the nearest depth of itself and all surfaces behind it */
+        for (elm = rlist; elm != RT_NULL; elm = elm->next)
+        {
+            rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+            if (RT_IS_ARRAY(nd))
+            {
+                continue;
+            }
+
+            srf = (rt_Surface *)nd;
+
+            tmin = RT_MIN(tmin, srf->tmin);
+
+            RT_SIMD_SET(srf->s_srf->t_min,
+                        tmin - RT_FABS(tmin) * RT_DEPTH_THRESHOLD);
+        }
+    }
+    else
+#endif /* RT_OPTS_TILING, RT_OPTS_DEPTHS */
+    {
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            RT_SIMD_SET(srf->s_srf->t_min, -RT_INF);
+        }
+    }
+}
+
+/*
+ * Update tilebuffer's layout to platform's current tile dimensions,
+ * lists retained from previous frame are released to force full rebuild.
+ */
+rt_void rt_Scene::reset_tiles()
+{
+    rt_si32 i, k = tiles_in_row * tiles_in_col;
+
+    /* release memory for temporary per-frame allocs
+     * before tilebuffer's allocs (if any) below */
+    if (pending)
+    {
+        pending = 0;
+
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->release(tharr[i]->mpool);
+        }
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    if ((opts & RT_OPTS_UPDATE_EXT0) == 0)
-    { /* -->---->-- skip update2 -->---->-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
+        release(mpool);
+    }
 
-    /* print state done */
-    if (g_print)
+    tile_w = pfm->tile_w;
+    tile_h = pfm->tile_h;
+
+    tiles_in_row = (x_res + tile_w - 1) / tile_w;
+    tiles_in_col = (y_res + tile_h - 1) / tile_h;
+
+    /* grow tilebuffer if needed, smaller layouts
+     * reuse the largest tilebuffer allocated so far */
+    if (tiles_max < tiles_in_row * tiles_in_col)
     {
-        RT_PRINT_STATE_DONE();
-        g_print = RT_FALSE;
+        tiles_max = tiles_in_row * tiles_in_col;
+
+        tiles = (rt_ELEM **)
+                alloc(tiles_max * sizeof(rt_ELEM *), RT_ALIGN);
+
+        spans = (rt_si32 *)
+                alloc(tiles_max * 3 * sizeof(rt_si32), RT_ALIGN);
+
+        vr_map = (rt_si32 *)
+                alloc(tiles_max * sizeof(rt_si32), RT_ALIGN);
+        vr_itm = (rt_si32 *)
+                alloc(tiles_max * 4 * sizeof(rt_si32), RT_ALIGN);
+
+        pt_cnt = (rt_real *)
+                alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+        pt_upd = (rt_si32 *)
+                alloc(tiles_max * sizeof(rt_si32), RT_ALIGN);
+        pt_err = (rt_real *)
+                alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+        pt_itm = (rt_si32 *)
+                alloc(tiles_max * 4 * sizeof(rt_si32), RT_ALIGN);
+
+        hm_acc = (rt_time *)
+                alloc(tiles_max * sizeof(rt_time), RT_ALIGN);
+        hm_buf = (rt_real *)
+                alloc(tiles_max * sizeof(rt_real), RT_ALIGN);
+
+        memset(hm_acc, 0, tiles_max * sizeof(rt_time));
+        memset(hm_buf, 0, tiles_max * sizeof(rt_real));
+    }
+
+    memset(tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+
+    /* map regions of interest to the new layout */
+    reset_spans();
+
+    /* application's rate map was given for the previous layout,
+     * rate map derived from the focal point is rebuilt per frame */
+    if (vr_on == 1)
+    {
+        vr_on = 0;
+    }
+
+    /* tiles' samples of adaptive sampling can't be mapped
+     * to the new layout, path-tracer's accumulation restarts */
+    if (pt_sep)
+    {
+        reset_color();
+    }
+
+    /* grow estimates of per-frame allocs for tiling,
+     * fewer tiles are left to adaptive pools sizing */
+    k = RT_MAX(tiles_in_row * tiles_in_col - k, 0);
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->s_inf->tile_w  = tile_w;
+        tharr[i]->s_inf->tile_h  = tile_h;
+        tharr[i]->s_inf->tls_row = tiles_in_row;
+        tharr[i]->s_inf->tiles   = tiles;
+
+        tharr[i]->msize += k * (rt_si32)sizeof(rt_ELEM) *
+                           (srf_num + thnum - 1) / thnum;
+    }
+
+    msize += k * (rt_si32)sizeof(rt_ELEM) * arr_num;
+}
+
+/*
+ * Build spans of tiles covering regions of interest,
+ * adjacent tiles of a row overlapping any rectangle are merged.
+ */
+rt_void rt_Scene::reset_spans()
+{
+    rt_si32 i, j, k, n, *r;
+
+    spans_num = 0;
+
+    for (i = 0; i < tiles_in_col; i++)
+    {
+        srows[i] = spans_num;
+
+        for (j = 0, k = 0; j < tiles_in_row; j++)
+        {
+            for (n = 0, r = rects; n < rects_num; n++, r += 4)
+            {
+                if (r[0] < r[2] && r[0] < (j + 1) * tile_w
+                &&  r[1] < r[3] && r[1] < (i + 1) * tile_h
+                &&  r[2] > j * tile_w && r[3] > i * tile_h)
+                {
+                    break;
+                }
+            }
+
+            if (n < rects_num)
+            {
+                /* open new span or extend current one */
+                if (k == 0)
+                {
+                    spans[spans_num * 3 + 0] = i;
+                    spans[spans_num * 3 + 1] = j;
+                    k = 1;
+                }
+                spans[spans_num * 3 + 2] = j;
+            }
+            else
+            if (k != 0)
+            {
+                spans_num++;
+                k = 0;
+            }
+        }
+
+        spans_num += k;
+    }
+
+    srows[i] = spans_num;
+}
+
+/*
+ * Build items of variable-rate render from the rate map (derived from
+ * the focal point if set), adjacent tiles of a row with the same rate
+ * are merged, rows-only steps are taken for the rate if compacted rows
+ * of tiles can't hold whole SIMD steps of pixels (as with wide SIMD).
+ */
+rt_void rt_Scene::reset_rates()
+{
+    rt_si32 i, j, r, *m = vr_map, s = pfm->simd_width >> pfm->fsaa;
+    rt_real x, y, d;
+
+    if (vr_on == 2)
+    {
+        for (i = 0; i < tiles_in_col; i++)
+        {
+            for (j = 0; j < tiles_in_row; j++)
+            {
+                /* tile's center distance in units of radius */
+                x = (rt_real)(j * tile_w + tile_w / 2 - vr_fcs[0]);
+                y = (rt_real)(i * tile_h + tile_h / 2 - vr_fcs[1]);
+                d = RT_SQRT(x * x + y * y) / (rt_real)vr_fcs[2];
+
+                m[i * tiles_in_row + j] = d < 1.0f ? 0 : d < 2.0f ? 1 :
+                                          d < 3.0f ? 2 : 3;
+            }
+        }
+    }
+
+    vr_num = 0;
+
+    for (i = 0; i < tiles_in_col; i++)
+    {
+        for (j = 0; j < tiles_in_row; j++, m++)
+        {
+            r = *m + ((tile_w / vr_step[*m][0]) % s != 0) * 3;
+
+            /* open new item or extend current one */
+            if (j == 0 || r != vr_itm[vr_num * 4 - 1])
+            {
+                vr_itm[vr_num * 4 + 0] = i;
+                vr_itm[vr_num * 4 + 1] = j;
+                vr_itm[vr_num * 4 + 3] = r;
+                vr_num++;
+            }
+            vr_itm[vr_num * 4 - 2] = j;
+        }
+    }
+}
+
+/*
+ * Build items of path-tracer's adaptive sampling from tiles' errors,
+ * converged tiles are skipped, tiles with errors above 4 thresholds take
+ * twice the samples, adjacent tiles of a row with the same number of
+ * accumulated samples and new samples are merged.
+ */
+rt_void rt_Scene::reset_ptcv()
+{
+    rt_si32 i, j, t, s, *itm = pt_itm - 4;
+
+    if (!pt_sep)
+    {
+        /* tiles start from the frame's counter */
+        for (t = 0; t < tiles_in_row * tiles_in_col; t++)
+        {
+            pt_cnt[t] = pts_c;
+            pt_upd[t] = 0;
+            pt_err[t] = 0.0f;
+        }
+
+        pt_sep = RT_TRUE;
+        pt_left = tiles_in_row * tiles_in_col;
+    }
+
+    pt_num = 0;
+
+    for (i = 0, t = 0; i < tiles_in_col; i++)
+    {
+        for (j = 0; j < tiles_in_row; j++, t++)
+        {
+            /* tiles are tested once enough estimates are taken */
+            if (pt_upd[t] >= RT_PTCV_MIN && pt_err[t] < pt_tol)
+            {
+                continue;
+            }
+
+            s = pt_upd[t] >= RT_PTCV_MIN && pt_err[t] > 4.0f * pt_tol ?
+                pt_on * 2 : pt_on;
+
+            /* open new item or extend current one */
+            if (pt_num == 0 || itm[0] != i || itm[2] != j - 1
+            ||  itm[3] != s || pt_cnt[t - 1] != pt_cnt[t])
+            {
+                itm += 4;
+                itm[0] = i;
+                itm[1] = j;
+                itm[3] = s;
+                pt_num++;
+            }
+            itm[2] = j;
+        }
+    }
+}
+
+/*
+ * Resize reservation "msize" of per-frame memory pool given its usage "mused"
+ * in the last frame, while peak usage "mpeak" is tracked within the window,
+ * headroom of 1/4 is added to avoid resizing back and forth.
+ */
+static
+rt_void mresize(rt_ui32 *msize, rt_ui32 *mpeak, rt_ui32 mused, rt_si32 last)
+{
+    *mpeak = RT_MAX(*mpeak, mused);
+
+    /* grow at once if reserved area has overflowed */
+    if (*msize < mused)
+    {
+        *msize = mused + mused / 4;
+    }
+    else
+    /* shrink if underused for the whole window */
+    if (last && *mpeak < *msize / 2)
+    {
+        *msize = *mpeak + *mpeak / 4;
+    }
+
+    if (last)
+    {
+        *mpeak = 0;
+    }
+}
+
+/*
+ * Record usage of per-frame memory pools in the last frame and
+ * resize their reservations for the next frame (with hysteresis).
+ */
+rt_void rt_Scene::reset_msize()
+{
+    rt_si32 i, last = --mfrms <= 0;
+
+    if (last)
+    {
+        mfrms = RT_MSIZE_FRAMES;
+    }
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SceneThread *thr = tharr[i];
+
+        thr->mused = (rt_ui32)thr->usage(thr->mpool);
+        mresize(&thr->msize, &thr->mpeak, thr->mused, last);
+    }
+
+    mused = (rt_ui32)usage(mpool);
+    mresize(&msize, &mpeak, mused, last);
+}
+
+/*
+ * Reset threads' ray counters for the frame.
+ */
+rt_void rt_Scene::reset_stats()
+{
+#if RT_FEAT_STATS
+    rt_si32 i;
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SIMD_INFOX *s_inf = tharr[i]->s_inf;
+
+        s_inf->cnt_p = 0;
+        s_inf->cnt_s = 0;
+        s_inf->cnt_f = 0;
+        s_inf->cnt_t = 0;
+        s_inf->cnt_d = 0;
+        s_inf->cnt_q = 0;
+        s_inf->cnt_c = 0;
+    }
+#endif /* RT_FEAT_STATS */
+}
+
+/*
+ * Drop frame pending in the pipeline without rendering it,
+ * memory for its per-frame allocs is released.
+ */
+rt_void rt_Scene::reset_pipe()
+{
+    rt_si32 i, k = pip_par ^ 1;
+
+    swap_pools(k);
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->release(tharr[i]->mpool);
+    }
+
+    release(mpool);
+
+    swap_pools(k);
+
+    pip_val = RT_FALSE;
+}
+
+/*
+ * Exchange per-frame pools of the scene and its threads with the pools
+ * of the pipeline with given index "k", called in pairs around updates
+ * and releases of the frames overlapped in the pipeline.
+ */
+rt_void rt_Scene::swap_pools(rt_si32 k)
+{
+    rt_pntr ptr;
+    rt_si32 i;
+
+    pip_chn[k] = chain(pip_chn[k]);
+
+    ptr = mpool;
+    mpool = pip_mpl[k];
+    pip_mpl[k] = ptr;
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SceneThread *thr = tharr[i];
+
+        thr->pip_chn[k] = thr->chain(thr->pip_chn[k]);
+
+        ptr = thr->mpool;
+        thr->mpool = thr->pip_mpl[k];
+        thr->pip_mpl[k] = ptr;
+    }
+}
+
+/*
+ * Swap SIMD structures of all objects with their alternates,
+ * so that the frame pending in the pipeline keeps its own
+ * while the scene is updated, materials' and nodes' structures
+ * are swapped before nodes' pointers to them are relinked.
+ */
+rt_void rt_Scene::swap_simd()
+{
+    rt_Material *mat;
+    rt_Light    *lgt;
+    rt_Array    *arr;
+    rt_Surface  *srf;
+
+    for (mat = mat_head; mat != RT_NULL; mat = mat->next)
+    {
+        mat->swap_simd(this);
+    }
+    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        lgt->swap_simd();
+    }
+    for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+    {
+        arr->swap_simd();
+    }
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->swap_simd();
+    }
+
+    for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+    {
+        arr->link_simd();
+    }
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->link_simd();
+    }
+}
+
+/*
+ * Get reservation size (in bytes) of per-frame memory pool of given thread,
+ * negative "index" selects main thread's pool.
+ */
+rt_ui32 rt_Scene::get_msize(rt_si32 index)
+{
+    if (index >= thnum)
+    {
+        return 0;
+    }
+
+    return index < 0 ? msize : tharr[index]->msize;
+}
+
+/*
+ * Get usage (in bytes) of per-frame memory pool of given thread
+ * in the last frame, negative "index" selects main thread's pool.
+ */
+rt_ui32 rt_Scene::get_mused(rt_si32 index)
+{
+    if (index >= thnum)
+    {
+        return 0;
+    }
+
+    return index < 0 ? mused : tharr[index]->mused;
+}
+
+/*
+ * Get size (in bytes) of the heap's chunk holding per-frame memory pool
+ * of given thread if the pool has a chunk of its own (0 otherwise),
+ * negative "index" selects main thread's pool.
+ */
+rt_ui32 rt_Scene::get_mchunk(rt_si32 index)
+{
+    if (index >= thnum || (index < 0 ? mpool : tharr[index]->mpool) == RT_NULL)
+    {
+        return 0;
     }
 
-    /* release memory for temporary per-frame allocs */
-    for (i = 0; i < thnum; i++)
+    return (rt_ui32)(index < 0 ? chunk(mpool, RT_QUAD_ALIGN) :
+                     tharr[index]->chunk(tharr[index]->mpool, RT_QUAD_ALIGN));
+}
+
+/*
+ * Get runtime optimization flags.
+ */
+rt_si32 rt_Scene::get_opts()
+{
+    return opts;
+}
+
+/*
+ * Set runtime optimization flags,
+ * except those turned off in the original scene definition.
+ */
+rt_si32 rt_Scene::set_opts(rt_si32 opts)
+{
+    /* automatic bvnodes are built once in constructor,
+     * keep the bit set there for get_opts to report them */
+    opts = (opts & ~RT_OPTS_VARRAY_EXT1)
+         | (this->opts & RT_OPTS_VARRAY_EXT1);
+
+    this->opts = opts & ~scn->opts;
+
+    /* trigger update of the whole hierarchy,
+     * safe to reset time as "rootobj" never has an animator,
+     * "rootobj's" time is restored within the update */
+    rootobj.time = -1;
+
+    return opts;
+}
+
+/*
+ * Get path-tracer mode: 0 - off, n - on (number of frames between updates).
+ */
+rt_si32 rt_Scene::get_pton()
+{
+    return this->pt_on;
+}
+
+/*
+ * Set path-tracer mode: 0 - off, n - on (number of frames between updates).
+ */
+rt_si32 rt_Scene::set_pton(rt_si32 pton)
+{
+    if ((opts & RT_OPTS_PT) == 0) /* if path-tracer is not optimized out */
     {
-        tharr[i]->release(tharr[i]->mpool);
+        rt_si32 pt_on = this->pt_on;
+
+        this->pt_on = pton;
+
+        if (this->pt_on && !pt_on)
+        {
+            reset_pseed();
+            reset_color();
+        }
     }
 
-    release(mpool);
+    return this->pt_on;
+}
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    } /* --<----<-- skip update2 --<----<-- */
-    else
+/*
+ * Get number of tiles left to converge in path-tracer's adaptive sampling,
+ * 0 - the image is done, -1 - adaptive sampling (or path-tracer) is off.
+ */
+rt_si32 rt_Scene::get_ptcv()
+{
+    if (pt_on == 0 || pt_tol <= 0.0f)
     {
-        pending = 1;
+        return -1;
     }
-#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    return pt_sep ? pt_left : tiles_in_row * tiles_in_col;
 }
 
 /*
- * Update portion of the scene with given "index"
- * as part of the multi-threaded update.
+ * Set convergence threshold "tol" of path-tracer's adaptive sampling as
+ * standard error of tiles' mean luminance (in fp colors of 1.0 limit),
+ * each frame adds samples only to tiles above the threshold (twice the
+ * samples if 4 times above it), converged tiles keep their contents.
+ * Zero (or negative) "tol" turns adaptive sampling off.
  */
-rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
+rt_void rt_Scene::set_ptcv(rt_real tol)
 {
     rt_si32 i;
 
-    rt_Array   *arr;
-    rt_Camera  *cam;
-    rt_Light   *lgt;
-    rt_Surface *srf;
-
-    if (phase == 1)
+    if ((opts & RT_OPTS_PT) == 0) /* if path-tracer is not optimized out */
     {
-        for (arr = arr_head, i = 0; arr != RT_NULL; arr = arr->next, i++)
+        if (tol > 0.0f && ptr_l == RT_NULL)
         {
-            if ((i % thnum) != index)
+            /* abandon progressive frame in progress */
+            if (pstate != 0)
             {
-                continue;
+                pstate = 0;
+                render_done();
             }
 
-            /* update array's fields from transform matrix
-             * updated in sequential phase 0.5 */
-            arr->update_fields();
-        }
-
-        for (cam = cam_head, i = 0; cam != RT_NULL; cam = cam->next, i++)
-        {
-            if ((i % thnum) != index)
+            /* release memory for temporary per-frame allocs
+             * before adaptive sampling's allocs below */
+            if (pending)
             {
-                continue;
-            }
+                pending = 0;
 
-            /* update camera's fields and transform matrix
-             * from parent array's transform matrix
-             * updated in sequential phase 0.5 */
-            cam->update_fields();
-        }
+                for (i = 0; i < thnum; i++)
+                {
+                    tharr[i]->release(tharr[i]->mpool);
+                }
 
-        for (lgt = lgt_head, i = 0; lgt != RT_NULL; lgt = lgt->next, i++)
-        {
-            if ((i % thnum) != index)
-            {
-                continue;
+                release(mpool);
             }
 
-            /* update light's fields and transform matrix
-             * from parent array's transform matrix
-             * updated in sequential phase 0.5 */
-            lgt->update_fields();
+            ptr_l = (rt_real *)
+                    alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+            ptr_v = (rt_real *)
+                    alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
         }
 
-        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
-        {
-            if ((i % thnum) != index)
-            {
-                continue;
-            }
-
-            /* update surface's fields and transform matrix
-             * from parent array's transform matrix
-             * updated in sequential phase 0.5 */
-            srf->update_fields();
-        }
+        this->pt_tol = RT_MAX(tol, 0.0f);
     }
-    else
-    if (phase == 2)
-    {
-        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
-        {
-            if ((i % thnum) != index)
-            {
-                continue;
-            }
+}
 
-            /* rebuild surface's clip list (cross-surface)
-             * based on transform flags updated in 1st phase above */
-            tharr[index]->sclip(srf);
+/*
+ * Get path-tracer's denoiser mode: 0 - off, n - number of wavelet passes.
+ */
+rt_si32 rt_Scene::get_dnse()
+{
+    return this->dn_on;
+}
 
-            /* update surface's bounds taking into account surfaces
-             * from custom clippers list updated above */
-            srf->update_bounds();
+/*
+ * Set path-tracer's denoiser mode: 0 - off, n - number of wavelet passes
+ * (up to RT_DNSE_MAX, each pass doubles filter's reach), accumulated colors
+ * are filtered before conversion to the frame, edges are kept given surface
+ * colors of the first hits captured in path-tracer's first pass
+ * of accumulation.
+ */
+rt_si32 rt_Scene::set_dnse(rt_si32 dnse)
+{
+    rt_si32 i;
 
-            /* rebuild surface's tile list (per-surface)
-             * based on surface bounds updated above */
-            tharr[index]->stile(srf);
-        }
-    }
-    else
-    if (phase == 3)
+    if ((opts & RT_OPTS_PT) == 0) /* if path-tracer is not optimized out */
     {
-        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        dnse = RT_MIN(RT_MAX(dnse, 0), RT_DNSE_MAX);
+
+        if (dnse != 0 && dn_pln == RT_NULL)
         {
-            if ((i % thnum) != index)
+            /* abandon progressive frame in progress */
+            if (pstate != 0)
             {
-                continue;
+                pstate = 0;
+                render_done();
             }
 
-            if (g_print)
+            /* release memory for temporary per-frame allocs
+             * before denoiser's allocs below */
+            if (pending)
             {
-                RT_PRINT_SRF(srf);
-            }
-
-            /* rebuild surface's rfl/rfr surface lists (cross-surface)
-             * based on surface bounds updated in 2nd phase above
-             * and array bounds updated in sequential phase 2.5 */
-            tharr[index]->ssort(srf);
+                pending = 0;
 
-            /* rebuild surface's light/shadow lists (cross-surface)
-             * based on surface bounds updated in 2nd phase above
-             * and array bounds updated in sequential phase 2.5 */
-            tharr[index]->lsort(srf);
+                for (i = 0; i < thnum; i++)
+                {
+                    tharr[i]->release(tharr[i]->mpool);
+                }
 
-            /* update surface's backend-related parts */
-            pfm->update0(srf->s_srf);
+                release(mpool);
+            }
 
-#if 0 /* SIMD-buffers don't normally require reset between frames */
-            memset(srf->s_srf->msc_p[0], 255, RT_BUFFER_POOL*thnum);
-#endif /* enable for SIMD-buffers as a debug option if needed */
+            dn_pln = (rt_real *)
+                     alloc(12 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+            dn_alb = (rt_real *)
+                     alloc(12 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+            dn_stg = (rt_real *)
+                     alloc(37 * x_row * thnum * sizeof(rt_real), RT_SIMD_ALIGN);
+
+            /* rows' padding and captured samples start cleared */
+            memset(dn_pln, 0, 12 * x_row * y_res * sizeof(rt_real));
+            memset(dn_alb, 0, 12 * x_row * y_res * sizeof(rt_real));
+            memset(dn_stg, 0, 37 * x_row * thnum * sizeof(rt_real));
         }
+
+        this->dn_on = dnse;
     }
+
+    return this->dn_on;
 }
 
 /*
- * Render portion of the frame with given "index"
- * as part of the multi-threaded render.
+ * Get checkerboard mode: 0 - off, 1 - on.
  */
-rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
+rt_si32 rt_Scene::get_cbon()
 {
-    /* adjust ray steppers according to antialiasing mode */
-    rt_real fha[RT_SIMD_WIDTH], fhi[RT_SIMD_WIDTH], fhu; /* h - hor */
-    rt_real fva[RT_SIMD_WIDTH], fvi[RT_SIMD_WIDTH], fvu; /* v - ver */
-    rt_si32 i, n;
+    return this->cb_on;
+}
 
-    if (pfm->fsaa == RT_FSAA_NO)
+/*
+ * Set checkerboard mode: 0 - off, 1 - on (half of the pixels are traced
+ * per frame, the rest is reconstructed from the previous frame).
+ */
+rt_si32 rt_Scene::set_cbon(rt_si32 cbon)
+{
+    rt_si32 i;
+
+    if (cbon && cb_hlf == RT_NULL)
     {
-        for (i = 0; i < pfm->simd_width; i++)
+        /* abandon progressive frame in progress */
+        if (pstate != 0)
         {
-            fha[i] = 0.0f;
-            fva[i] = 0.0f;
-
-            fhi[i] = (rt_real)i;
-            fvi[i] = (rt_real)index;
+            pstate = 0;
+            render_done();
         }
 
-        fhu = (rt_real)(pfm->simd_width);
-        fvu = (rt_real)thnum;
-    }
-    else
-    if (pfm->fsaa == RT_FSAA_2X) /* alternating */
-    {
-        rt_real as = 0.25f;
-#if RT_FSAA_REGULAR
-        rt_real ar = 0.00f;
-#else /* RT_FSAA_REGULAR */
-        rt_real ar = 0.08f;
-#endif /* RT_FSAA_REGULAR */
-
-        for (i = 0; i < pfm->simd_width / 4; i++)
+        /* release memory for temporary per-frame allocs
+         * before checkerboard's allocs below */
+        if (pending)
         {
-            fha[i*4+0] = (-ar+as);
-            fha[i*4+1] = (+ar-as);
-            fha[i*4+2] = (+ar-as);
-            fha[i*4+3] = (-ar+as);
-
-            fva[i*4+0] = (+ar+as);
-            fva[i*4+1] = (-ar-as);
-            fva[i*4+2] = (+ar+as);
-            fva[i*4+3] = (-ar-as);
+            pending = 0;
 
-            fhi[i*4+0] = (rt_real)(i*2+0);
-            fhi[i*4+1] = (rt_real)(i*2+0);
-            fhi[i*4+2] = (rt_real)(i*2+1);
-            fhi[i*4+3] = (rt_real)(i*2+1);
+            for (i = 0; i < thnum; i++)
+            {
+                tharr[i]->release(tharr[i]->mpool);
+            }
 
-            fvi[i*4+0] = (rt_real)index;
-            fvi[i*4+1] = (rt_real)index;
-            fvi[i*4+2] = (rt_real)index;
-            fvi[i*4+3] = (rt_real)index;
+            release(mpool);
         }
 
-        fhu = (rt_real)(pfm->simd_width / 2);
-        fvu = (rt_real)thnum;
-    }
-    else
-    if (pfm->fsaa == RT_FSAA_4X)
-    {
-        rt_real as = 0.25f;
-#if RT_FSAA_REGULAR
-        rt_real ar = 0.00f;
-#else /* RT_FSAA_REGULAR */
-        rt_real ar = 0.08f;
-#endif /* RT_FSAA_REGULAR */
+        cb_hlf = (rt_ui32 *)
+                 alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
 
-        for (i = 0; i < pfm->simd_width / 4; i++)
+        for (i = 0; i < 2; i++)
         {
-            fha[i*4+0] = (-ar-as);
-            fha[i*4+1] = (-ar+as);
-            fha[i*4+2] = (+ar-as);
-            fha[i*4+3] = (+ar+as);
-
-            fva[i*4+0] = (+ar-as);
-            fva[i*4+1] = (-ar-as);
-            fva[i*4+2] = (+ar+as);
-            fva[i*4+3] = (-ar+as);
-
-            fhi[i*4+0] = (rt_real)i;
-            fhi[i*4+1] = (rt_real)i;
-            fhi[i*4+2] = (rt_real)i;
-            fhi[i*4+3] = (rt_real)i;
-
-            fvi[i*4+0] = (rt_real)index;
-            fvi[i*4+1] = (rt_real)index;
-            fvi[i*4+2] = (rt_real)index;
-            fvi[i*4+3] = (rt_real)index;
+            cb_hst[i] = (rt_ui32 *)
+                 alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
         }
 
-        fhu = (rt_real)(pfm->simd_width / 4);
-        fvu = (rt_real)thnum;
-    }
-    else
-    if (pfm->fsaa == RT_FSAA_8X) /* 8x reserved */
-    {
-        ;
-    }
+        cb_dep = (rt_real *)
+                 alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
 
-/*  rt_SIMD_CAMERA */
+        cb_stg = (rt_elem *)
+                 alloc(6 * x_row * thnum * sizeof(rt_elem), RT_SIMD_ALIGN);
+    }
 
-    rt_SIMD_CAMERA *s_cam = tharr[index]->s_cam;
+    this->cb_on = cbon != 0;
 
-    RT_SIMD_SET(s_cam->t_max, RT_INF);
+    /* history is taken from the next full frame */
+    cb_val = RT_FALSE;
 
-    RT_SIMD_SET(s_cam->dir_x, dir[RT_X]);
-    RT_SIMD_SET(s_cam->dir_y, dir[RT_Y]);
-    RT_SIMD_SET(s_cam->dir_z, dir[RT_Z]);
+    return this->cb_on;
+}
 
-    RT_SIMD_SET(s_cam->hor_x, hor[RT_X]);
-    RT_SIMD_SET(s_cam->hor_y, hor[RT_Y]);
-    RT_SIMD_SET(s_cam->hor_z, hor[RT_Z]);
+/*
+ * Get adaptive antialiasing mode: RT_FSAA_NO (off), RT_FSAA_2X/4X/8X.
+ */
+rt_si32 rt_Scene::get_adaa()
+{
+    return this->ad_on;
+}
 
-    RT_SIMD_SET(s_cam->ver_x, ver[RT_X]);
-    RT_SIMD_SET(s_cam->ver_y, ver[RT_Y]);
-    RT_SIMD_SET(s_cam->ver_z, ver[RT_Z]);
+/*
+ * Set adaptive antialiasing mode: RT_FSAA_NO (off), RT_FSAA_2X/4X/8X,
+ * a single sample per pixel is traced first, then blocks of pixels with
+ * color edges are re-traced with the rest of samples (given full-screen
+ * antialiasing is off).
+ */
+rt_si32 rt_Scene::set_adaa(rt_si32 fsaa)
+{
+    rt_si32 i;
 
-    RT_SIMD_SET(s_cam->hor_u, fhu);
-    RT_SIMD_SET(s_cam->ver_u, fvu);
+    fsaa = RT_MIN(RT_MAX(fsaa, RT_FSAA_NO), RT_FSAA_8X);
 
-    RT_SIMD_SET(s_cam->clamp, (rt_real)255);
-    RT_SIMD_SET(s_cam->cmask, (rt_elem)255);
+    if (fsaa != RT_FSAA_NO && ad_buf == RT_NULL)
+    {
+        /* abandon progressive frame in progress */
+        if (pstate != 0)
+        {
+            pstate = 0;
+            render_done();
+        }
 
-    RT_SIMD_SET(s_cam->col_r, amb[RT_R]);
-    RT_SIMD_SET(s_cam->col_g, amb[RT_G]);
-    RT_SIMD_SET(s_cam->col_b, amb[RT_B]);
-    RT_SIMD_SET(s_cam->l_amb, amb[RT_A]);
+        /* release memory for temporary per-frame allocs
+         * before adaptive antialiasing's allocs below */
+        if (pending)
+        {
+            pending = 0;
 
-    RT_SIMD_SET(s_cam->x_row, (rt_real)(x_row << pfm->fsaa));
-    RT_SIMD_SET(s_cam->idx_h, pfm->simd_width);
+            for (i = 0; i < thnum; i++)
+            {
+                tharr[i]->release(tharr[i]->mpool);
+            }
 
-/*  rt_SIMD_CONTEXT */
+            release(mpool);
+        }
 
-    rt_SIMD_CONTEXT *s_ctx = tharr[index]->s_ctx;
+        ad_msk = (rt_ui08 *)
+                 alloc(x_row * y_res * sizeof(rt_ui08), RT_ALIGN);
+        ad_buf = (rt_ui32 *)
+                 alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
+        ad_acc = (rt_ui64 *)
+                 alloc(x_row * y_res * sizeof(rt_ui64), RT_ALIGN);
+    }
 
-    s_ctx->param[1] = -((opts & RT_OPTS_GAMMA) == 0) & RT_PROP_GAMMA;
-    RT_SIMD_SET(s_ctx->t_min, cam->pov);
-    RT_SIMD_SET(s_ctx->wmask, -1);
+    this->ad_on = fsaa;
 
-    RT_SIMD_SET(s_ctx->org_x, pos[RT_X]);
-    RT_SIMD_SET(s_ctx->org_y, pos[RT_Y]);
-    RT_SIMD_SET(s_ctx->org_z, pos[RT_Z]);
+    return this->ad_on;
+}
 
-/*  rt_SIMD_INFOX */
+/*
+ * Get timer record of the frame rendered "age" frames ago (0 - last),
+ * the record stays valid until it is overwritten in the ring.
+ * Return NULL if no such frame has been recorded.
+ */
+rt_TMRS* rt_Scene::get_tmrs(rt_si32 age)
+{
+    if (age < 0 || age >= RT_MIN(tmr_cnt, tmr_num))
+    {
+        return RT_NULL;
+    }
 
-    rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
+    return &tmr_arr[(tmr_cnt - 1 - age) % tmr_num];
+}
 
-    s_inf->ctx = s_ctx;
-    s_inf->cam = s_cam;
-    s_inf->lst = clist;
+/*
+ * Set ring of "num" per-frame timer records for frames from "render",
+ * "f_tick" is platform's monotonic timer of high resolution (e.g. in ns),
+ * the ring is allocated on first use, later "num" is clamped to its size,
+ * zero "num" (or NULL "f_tick") turns timers off, recording restarts.
+ * Return number of records in use.
+ */
+rt_si32 rt_Scene::set_tmrs(rt_si32 num, rt_FUNC_TIME f_tick)
+{
+    rt_si32 i;
 
-    s_inf->thndx = index;
-    s_inf->thnum = thnum;
-    s_inf->depth = depth;
-    s_inf->fsaa  = pfm->fsaa;
+    tmr_cnt = 0;
 
-    s_inf->pt_on = pt_on;
+    if (num <= 0 || f_tick == RT_NULL)
+    {
+        tmr_num = 0;
+        this->f_tick = RT_NULL;
 
-    RT_SIMD_SET(s_inf->pts_c, pts_c);
+        return tmr_num;
+    }
 
-    for (n = RT_MAX(1, pt_on); n > 0; n--)
+    if (tmr_max == 0)
     {
-        /* use of integer indices for primary rays update
-         * makes related fp-math independent from SIMD width */
-        for (i = 0; i < pfm->simd_width; i++)
+        /* abandon progressive frame in progress */
+        if (pstate != 0)
+        {
+            pstate = 0;
+            render_done();
+        }
+
+        /* release memory for temporary per-frame allocs
+         * before timers' allocs below */
+        if (pending)
         {
-            s_cam->index[i] = i;
-            s_inf->hor_c[i] = fhi[i];
+            pending = 0;
 
-            s_inf->hor_i[i] = fhi[i];
-            s_inf->ver_i[i] = fvi[i];
+            for (i = 0; i < thnum; i++)
+            {
+                tharr[i]->release(tharr[i]->mpool);
+            }
 
-            s_cam->hor_a[i] = fha[i];
-            s_cam->ver_a[i] = fva[i];
+            release(mpool);
         }
 
-        s_inf->depth = depth;
-        RT_SIMD_SET(s_ctx->wmask, -1);
+        tmr_arr = (rt_TMRS *)alloc(num * sizeof(rt_TMRS), RT_ALIGN);
+
+        rt_time *busy = (rt_time *)
+                 alloc(num * thnum * RT_TMRS_NUM * sizeof(rt_time), RT_ALIGN);
 
-        /* render frame based on tilebuffer */
-        pfm->render0(s_inf);
+        for (i = 0; i < num; i++)
+        {
+            tmr_arr[i].thnum = thnum;
+            tmr_arr[i].busy = busy + i * thnum * RT_TMRS_NUM;
+        }
+
+        tmr_max = num;
     }
+
+    tmr_num = RT_MIN(num, tmr_max);
+    this->f_tick = f_tick;
+
+    return tmr_num;
 }
 
 /*
- * Return framebuffer's stride in pixels.
+ * Get ray packet counter "index" (RT_STAT_*) of the last frame, counted
+ * once per SIMD packet by the backend when built with RT_FEAT_STATS.
+ * Return 0 if counters are built out or "index" is out of range.
  */
-rt_si32 rt_Scene::get_x_row()
+rt_word rt_Scene::get_stat(rt_si32 index)
 {
-    return x_row;
+    if (index < 0 || index >= RT_STAT_NUM)
+    {
+        return 0;
+    }
+
+    return st_arr[index];
 }
 
 /*
- * Print current state during next render-call.
- * Has global scope and effect on any instance.
- * The flag is reset upon rendering completion.
+ * Get per-tile render cost of the last frame (in units of heatmap's timer)
+ * for current layout's tiles in row order.
+ * Return NULL if heatmap is off.
  */
-rt_void rt_Scene::print_state()
+rt_real* rt_Scene::get_heat()
 {
-    g_print = RT_TRUE;
+    return hm_on ? hm_buf : RT_NULL;
 }
 
 /*
- * Generate next random number using XX-bit LCG method.
+ * Set per-tile render cost heatmap: 0 - off, 1 - on (render0's passes
+ * over each tile are timed by "f_cost", rows are stolen in single tiles,
+ * which changes work distribution between threads).
+ * NULL "f_cost" turns heatmap off.
+ * Return heatmap mode.
  */
-static
-rt_ui64 randomXX(rt_ui64 seed)
+rt_si32 rt_Scene::set_heat(rt_si32 heat, rt_FUNC_TIME f_cost)
 {
-#if RT_PRNG != LCG48
+    rt_si32 i;
 
-    /* use 48-bit seeding to decorrelate lesser LCG */
-    return (seed * LL(25214903917) + 11) & LL(0x0000FFFFFFFFFFFF);
+    heat = heat != 0 && f_cost != RT_NULL;
 
-#else /* RT_PRNG == LCG48 */
+    if (heat && hm_img == RT_NULL)
+    {
+        /* abandon progressive frame in progress */
+        if (pstate != 0)
+        {
+            pstate = 0;
+            render_done();
+        }
 
-    /* use 32-bit seeding to decorrelate 48-bit LCG */
-    return (seed * 214013 + 2531011) & 0xFFFFFFFF;
+        /* release memory for temporary per-frame allocs
+         * before heatmap's allocs below */
+        if (pending)
+        {
+            pending = 0;
 
-#endif /* RT_PRNG == LCG48 */
+            for (i = 0; i < thnum; i++)
+            {
+                tharr[i]->release(tharr[i]->mpool);
+            }
+
+            release(mpool);
+        }
+
+        hm_img = (rt_ui32 *)
+                 alloc(x_res * y_res * sizeof(rt_ui32), RT_ALIGN);
+    }
+
+    /* restart accumulation of tiles' time */
+    if (heat && !hm_on)
+    {
+        memset(hm_acc, 0, tiles_max * sizeof(rt_time));
+        memset(hm_buf, 0, tiles_max * sizeof(rt_real));
+    }
+
+    this->hm_on = heat;
+    this->f_cost = heat ? f_cost : RT_NULL;
+
+    return this->hm_on;
 }
 
 /*
- * Reset current state of framebuffer's seed-plane for path-tracer.
+ * Set per-tile shading rates of variable-rate render from "rate" array
+ * of current layout's tiles in row order (0 - full, 1 - 1/2, 2 - 1/4,
+ * 3 - 1/16 of the pixels are traced, the rest is upsampled).
+ * NULL "rate" restores full rate, as does a change of tiles layout.
  */
-rt_void rt_Scene::reset_pseed()
+rt_void rt_Scene::set_rates(rt_si32 *rate)
 {
-    if ((opts & RT_OPTS_PT) != 0)
-    {
-        return;
-    }
+    rt_si32 i;
 
-    rt_si32 k, n = 4 * x_row * y_res;
-    rt_ui64 seed = 1;
+    set_focus(0, 0, rate != RT_NULL);
 
-    for (k = 0; k < n; k++)
+    if (rate != RT_NULL)
     {
-        seed = randomXX(seed);
-        pseed[k] = (rt_elem)seed;
+        for (i = 0; i < tiles_in_row * tiles_in_col; i++)
+        {
+            vr_map[i] = RT_MIN(RT_MAX(rate[i], 0), 3);
+        }
+
+        vr_on = 1;
     }
 }
 
 /*
- * Reset current state of framebuffer's color-planes for path-tracer.
+ * Set focal point "x", "y" of variable-rate render in pixels, tiles'
+ * shading rates are lowered with distance in units of "rad" (full rate
+ * within the radius, then 1/2, 1/4 and 1/16 of the pixels are traced).
+ * Zero (or negative) "rad" restores full rate.
  */
-rt_void rt_Scene::reset_color()
+rt_void rt_Scene::set_focus(rt_si32 x, rt_si32 y, rt_si32 rad)
 {
-    if ((opts & RT_OPTS_PT) != 0)
+    rt_si32 i, j;
+
+    if (rad > 0 && vr_buf == RT_NULL)
     {
-        return;
-    }
+        /* abandon progressive frame in progress */
+        if (pstate != 0)
+        {
+            pstate = 0;
+            render_done();
+        }
 
-    pts_c = 0.0f;
+        /* release memory for temporary per-frame allocs
+         * before variable-rate render's allocs below */
+        if (pending)
+        {
+            pending = 0;
 
-    memset(ptr_r, 0, 4 * x_row * y_res * sizeof(rt_real));
-    memset(ptr_g, 0, 4 * x_row * y_res * sizeof(rt_real));
-    memset(ptr_b, 0, 4 * x_row * y_res * sizeof(rt_real));
-}
+            for (i = 0; i < thnum; i++)
+            {
+                tharr[i]->release(tharr[i]->mpool);
+            }
 
-/*
- * Get runtime optimization flags.
- */
-rt_si32 rt_Scene::get_opts()
-{
-    return opts;
-}
+            release(mpool);
+        }
 
-/*
- * Set runtime optimization flags,
- * except those turned off in the original scene definition.
- */
-rt_si32 rt_Scene::set_opts(rt_si32 opts)
-{
-    this->opts = opts & ~scn->opts;
+        vr_buf = (rt_ui32 *)
+                 alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
 
-    /* trigger update of the whole hierarchy,
-     * safe to reset time as "rootobj" never has an animator,
-     * "rootobj's" time is restored within the update */
-    rootobj.time = -1;
+        vr_wgt = (rt_elem *)
+                 alloc(6 * x_row * sizeof(rt_elem), RT_SIMD_ALIGN);
+        vr_stg = (rt_elem *)
+                 alloc(5 * x_row * thnum * sizeof(rt_elem), RT_SIMD_ALIGN);
 
-    return opts;
-}
+        for (i = 0; i < x_row; i++)
+        {
+            for (j = 0; j < 4; j++)
+            {
+                vr_wgt[j * x_row + i] = (rt_elem)j;
+            }
 
-/*
- * Get path-tracer mode: 0 - off, n - on (number of frames between updates).
- */
-rt_si32 rt_Scene::get_pton()
-{
-    return this->pt_on;
+            vr_wgt[4 * x_row + i] = (rt_elem)(i % 2 * 2);
+            vr_wgt[5 * x_row + i] = (rt_elem)(i % 4);
+        }
+    }
+
+    vr_fcs[0] = x;
+    vr_fcs[1] = y;
+    vr_fcs[2] = rad;
+
+    vr_on = rad > 0 ? 2 : 0;
 }
 
 /*
- * Set path-tracer mode: 0 - off, n - on (number of frames between updates).
+ * Set "num" regions of interest from "rect" array of pixel rectangles
+ * (x0, y0, x1, y1 exclusive), both screen tiling and render are then
+ * restricted to the rows of tiles covering the rectangles,
+ * the rest of the frame keeps its previous contents.
+ * Zero "num" (or NULL "rect") restores rendering of the whole frame.
  */
-rt_si32 rt_Scene::set_pton(rt_si32 pton)
+rt_void rt_Scene::set_rects(rt_si32 num, rt_si32 *rect)
 {
-    if ((opts & RT_OPTS_PT) == 0) /* if path-tracer is not optimized out */
+    rt_si32 i;
+
+    /* abandon progressive frame in progress */
+    if (pstate != 0)
     {
-        rt_si32 pt_on = this->pt_on;
+        pstate = 0;
+        render_done();
+    }
 
-        this->pt_on = pton;
+    /* release memory for temporary per-frame allocs
+     * before regions' allocs (if any) below, lists retained
+     * from previous frame were tiled for previous regions */
+    if (pending)
+    {
+        pending = 0;
 
-        if (this->pt_on && !pt_on)
+        for (i = 0; i < thnum; i++)
         {
-            reset_pseed();
-            reset_color();
+            tharr[i]->release(tharr[i]->mpool);
         }
+
+        release(mpool);
     }
 
-    return this->pt_on;
+    num = rect != RT_NULL ? RT_MAX(num, 0) : 0;
+
+    if (rects_max < num)
+    {
+        rects_max = num;
+
+        rects = (rt_si32 *)
+                alloc(rects_max * 4 * sizeof(rt_si32), RT_ALIGN);
+    }
+
+    /* clip rectangles to the frame */
+    for (i = 0; i < num * 4; i += 2)
+    {
+        rects[i + 0] = RT_MIN(RT_MAX(rect[i + 0], 0), x_res);
+        rects[i + 1] = RT_MIN(RT_MAX(rect[i + 1], 0), y_res);
+    }
+
+    rects_num = num;
+
+    reset_spans();
+
+    /* path-tracer's samples are accumulated within regions only,
+     * restart accumulation as regions have changed */
+    if (pt_on)
+    {
+        reset_color();
+    }
 }
 
 /*
@@ -3858,19 +7914,54 @@ rt_ui32* rt_Scene::get_frame()
 }
 
 /*
- * Save current frame to an image.
+ * Switch rendering to another application-provided framebuffer "frame"
+ * of the same dimensions and stride, so that consecutive frames can be
+ * rendered to rotated buffers while previous ones are being displayed.
+ * If parts of the frame aren't rendered every frame (outside of regions
+ * of interest, converged tiles of path-tracer's adaptive sampling, rows
+ * of progressive frame in progress) previous contents are carried over.
+ * Return pointer to the framebuffer in use, which remains unchanged
+ * if the scene has reallocated its framebuffer in the constructor.
  */
-rt_void rt_Scene::save_frame(rt_si32 index)
+rt_ui32* rt_Scene::set_frame(rt_ui32 *frame)
 {
-    rt_char name[20];
+    rt_si32 y;
+
+    if (frm_ext == 0 || frame == RT_NULL || frame == this->frame
+    || ((rt_word)frame & (RT_SIMD_ALIGN - 1)) != 0)
+    {
+        return this->frame;
+    }
+
+    /* progressive frame in progress resumes in the new framebuffer
+     * as threads pick up the frame's pointer on each render call */
+    if (pstate != 0 || rects_num != 0 || get_ptcv() >= 0)
+    {
+        for (y = 0; y < y_res; y++)
+        {
+            memcpy(frame + y * x_row, this->frame + y * x_row,
+                                            x_res * sizeof(rt_ui32));
+        }
+    }
+
+    this->frame = frame;
 
+    return frame;
+}
+
+/*
+ * Prepare frame's image file name for given "index".
+ */
+static
+rt_void frame_name(rt_char *name, rt_si32 index)
+{
     if (index < 1000)
     {
-        strncpy(name, "scrXXX.bmp", 20);
+        strncpy(name, "scrXXX.bmp", RT_CAPT_NAME);
     }
     else
     {
-        strncpy(name, "scrXXX-Y.bmp", 20);
+        strncpy(name, "scrXXX-Y.bmp", RT_CAPT_NAME);
     }
 
     /* prepare filename string */
@@ -3886,6 +7977,17 @@ rt_void rt_Scene::save_frame(rt_si32 index)
         index -= 1;
         name[7] = '0' + (index % 10);
     }
+}
+
+/*
+ * Save current frame to an image.
+ */
+rt_void rt_Scene::save_frame(rt_si32 index)
+{
+    rt_char name[RT_CAPT_NAME];
+
+    /* prepare filename string */
+    frame_name(name, index);
 
     /* prepare frame's image */
     rt_TEX tex;
@@ -3898,6 +8000,130 @@ rt_void rt_Scene::save_frame(rt_si32 index)
     save_image(this, name, &tex);
 }
 
+/*
+ * Map value in [0, 1] range to heatmap's false color
+ * (blue, cyan, green, yellow, red).
+ */
+static
+rt_ui32 heat_color(rt_real v)
+{
+    rt_si32 k = RT_MIN(RT_MAX((rt_si32)(v * 1020.0f), 0), 1020);
+
+    if (k < 255)
+    {
+        return 0x000000FF | k << 8;
+    }
+    if (k < 510)
+    {
+        return 0x0000FF00 | (510 - k);
+    }
+    if (k < 765)
+    {
+        return 0x0000FF00 | (k - 510) << 16;
+    }
+
+    return 0x00FF0000 | (1020 - k) << 8;
+}
+
+/*
+ * Save per-tile render cost of the last frame as a false-color image
+ * with frame's dimensions (blue - free, green - average cost of a tile,
+ * red - twice the average or more, so that outliers don't flatten it),
+ * named as frame's image with "hmp" prefix instead of "scr".
+ */
+rt_void rt_Scene::save_heat(rt_si32 index)
+{
+    rt_char name[RT_CAPT_NAME];
+    rt_si32 i, j, n = tiles_in_row * tiles_in_col;
+    rt_real top = 0.0f;
+
+    if (hm_on == 0)
+    {
+        throw rt_Exception("heatmap isn't set in scene");
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        top += hm_buf[i];
+    }
+
+    top = top > 0.0f ? (rt_real)n / (2.0f * top) : 0.0f;
+
+    /* fill tiles with their colors */
+    for (j = 0; j < y_res; j++)
+    {
+        rt_real *buf = hm_buf + (j / tile_h) * tiles_in_row;
+        rt_ui32 *img = hm_img + j * x_res;
+
+        for (i = 0; i < x_res; i++)
+        {
+            img[i] = heat_color(buf[i / tile_w] * top);
+        }
+    }
+
+    /* prepare filename string */
+    frame_name(name, index);
+    memcpy(name, "hmp", 3);
+
+    /* prepare heatmap's image */
+    rt_TEX tex;
+    tex.ptex = hm_img;
+    tex.tex_num = +x_res;
+    tex.x_dim = +x_res;
+    tex.y_dim = -y_res;
+
+    /* save heatmap's image */
+    save_image(this, name, &tex);
+}
+
+/*
+ * Copy current frame to platform's capture ring to be saved
+ * to an image by platform's I/O thread (see "write_capt").
+ * Return 1 if the frame is queued, 0 if the ring is full.
+ */
+rt_si32 rt_Scene::capt_frame(rt_si32 index)
+{
+    rt_si32 i, k = pfm->capt_head, n = pfm->capt_num;
+
+    if (n == 0)
+    {
+        throw rt_Exception("capture ring isn't set in platform");
+    }
+
+    if (x_res * y_res > pfm->capt_max)
+    {
+        throw rt_Exception("frame doesn't fit capture ring's buffers");
+    }
+
+    if (k - pfm->capt_tail >= n)
+    {
+        return 0;
+    }
+
+    rt_TEX *tx = &pfm->capt_tex[k % n];
+    rt_char *name = pfm->capt_str + (k % n) * (strlen(RT_PATH_DUMP)
+                                                          + RT_CAPT_NAME);
+
+    /* copy frame's rows without the stride */
+    for (i = 0; i < y_res; i++)
+    {
+        memcpy((rt_ui32 *)tx->ptex + i * x_res, frame + i * x_row,
+                                                x_res * sizeof(rt_ui32));
+    }
+
+    tx->tex_num = +x_res;
+    tx->x_dim = +x_res;
+    tx->y_dim = -y_res;
+
+    strcpy(name, RT_PATH_DUMP);
+    frame_name(name + strlen(RT_PATH_DUMP), index);
+
+    /* hand the frame over to I/O thread */
+    fetch_add(&pfm->capt_head, 1);
+
+    return 1;
+}
+
 /*
  * Return pointer to the platform container.
  */
@@ -3924,6 +8150,11 @@ rt_Scene::~rt_Scene()
     /* destroy object hierarchy */
     delete root;
 
+    /* free pools of the frames
+     * overlapped in the pipeline */
+    unchain(pip_chn[0]);
+    unchain(pip_chn[1]);
+
     /* destroy textures */
     while (tex_head)
     {
@@ -38,6 +38,50 @@
 #define RT_TILE_W               8  /* screen tile width  in pixels (%S == 0) */
 #define RT_TILE_H               8  /* screen tile height in pixels */
 
+#define RT_TILE_TUNE_FRAMES     2  /* frames timed per candidate in autotune */
+
+#define RT_MSIZE_FRAMES         16 /* frames of low usage before pool shrinks */
+
+#define RT_CBRD_TOL             16 /* checkerboard history's color tolerance */
+
+#define RT_ADAA_TOL             12 /* adaptive antialiasing's edge threshold */
+
+#define RT_PTCV_MIN             16 /* path-tracer's tile updates before test */
+
+#define RT_DNSE_TOL             24 /* denoiser guide's color edge threshold */
+#define RT_DNSE_MAX             5  /* denoiser's max number of wavelet passes */
+#define RT_DNSE_CAP             4.0f /* denoiser's clamp of traced colors */
+
+#define RT_CAPT_NUM             16 /* frames in capture ring for I/O thread */
+#define RT_CAPT_NAME            20 /* max length of captured frame's name */
+
+/*
+ * Timer slots of per-frame records,
+ * sequential parts of the frame are accumulated in slot 0.
+ */
+#define RT_TMRS_SEQ             0  /* sequential update and render parts */
+#define RT_TMRS_P05             1  /* phase 0.5, arrays' transform matrices */
+#define RT_TMRS_PH1             2  /* 1st phase, surfaces' transform, data */
+#define RT_TMRS_PH2             3  /* 2nd phase, clip lists, bounds, tiles */
+#define RT_TMRS_P25             4  /* phase 2.5, arrays' bounds */
+#define RT_TMRS_PH3             5  /* 3rd phase, cross-surface lists */
+#define RT_TMRS_TLS             6  /* merge of surfaces' tile lists */
+#define RT_TMRS_RND             7  /* render passes (render0 and filters) */
+#define RT_TMRS_NUM             8
+
+/*
+ * Ray packet counters of the frame (if RT_FEAT_STATS), summed over threads,
+ * each counts SIMD packets traced by the backend, not individual rays.
+ */
+#define RT_STAT_PRM             0  /* packets of primary rays */
+#define RT_STAT_SHD             1  /* packets of shadow rays */
+#define RT_STAT_RFL             2  /* packets of reflected rays */
+#define RT_STAT_RFR             3  /* packets of refracted rays */
+#define RT_STAT_PTR             4  /* packets of path-tracer's rays */
+#define RT_STAT_SRF             5  /* packets' ray-surface solves */
+#define RT_STAT_CLP             6  /* solves with all roots rejected */
+#define RT_STAT_NUM             7
+
 /*
  * Floating point thresholds,
  * values have been roughly selected for single-precision,
@@ -45,6 +89,7 @@
  */
 #define RT_TILE_THRESHOLD       0.2f
 #define RT_LINE_THRESHOLD       0.01f
+#define RT_DEPTH_THRESHOLD      0.001f
 
 /*
  * Fullscreen antialiasing modes.
@@ -52,7 +97,7 @@
 #define RT_FSAA_NO              0
 #define RT_FSAA_2X              1
 #define RT_FSAA_4X              2
-#define RT_FSAA_8X              3 /* reserved */
+#define RT_FSAA_8X              3 /* adaptive only */
 
 #ifndef RT_FSAA_REGULAR
 #define RT_FSAA_REGULAR         0 /* makes AA-grid regular if 1 */
@@ -73,6 +118,27 @@ typedef rt_void (*rt_FUNC_TERM)(rt_pntr tdata, rt_si32 thnum);
 typedef rt_void (*rt_FUNC_UPDATE)(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
 typedef rt_void (*rt_FUNC_RENDER)(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
 
+/*
+ * Timer function type (in ms) for tiles autotuning,
+ * progressive render takes it in units of its budget (e.g. in us).
+ */
+typedef rt_time (*rt_FUNC_TIME)();
+
+/*
+ * Per-frame record of timers (in units of platform's timer function),
+ * "wall" holds main thread's time spent in each slot of the frame,
+ * "busy" holds each thread's time spent in its slices of each slot
+ * (thnum x RT_TMRS_NUM), the difference is the time waited at
+ * the pool's barrier, the spread of "busy" is threads' imbalance.
+ */
+struct rt_TMRS
+{
+    rt_time             time;
+    rt_si32             thnum;
+    rt_time             wall[RT_TMRS_NUM];
+    rt_time            *busy;
+};
+
 /*
  * Platform abstraction container.
  */
@@ -117,6 +183,23 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_Scene           *tail;
     rt_Scene           *cur;
 
+    /* scenes rendered together
+     * in a single run of the pool */
+    rt_Scene          **bat_arr;
+    rt_si32             bat_num;
+
+    /* ring of frames captured for platform's
+     * I/O thread with their full path names,
+     * counters of frames queued and written,
+     * buffer for the image being written */
+    rt_TEX             *capt_tex;
+    rt_char            *capt_str;
+    rt_si32             capt_num;
+    rt_si32             capt_max;
+    volatile rt_si32    capt_head;
+    volatile rt_si32    capt_tail;
+    rt_pntr             capt_buf;
+
 /*  methods */
 
     rt_void     add_scene(rt_Scene *scn);
@@ -127,6 +210,7 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32     switch0(rt_SIMD_INFOX *s_inf, rt_si32 simd);
     rt_void     update0(rt_SIMD_SURFACE *s_srf);
     rt_void     render0(rt_SIMD_INFOX *s_inf);
+    rt_void     filter0(rt_SIMD_INFOX *s_inf);
 
     public:
 
@@ -148,11 +232,21 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32     get_fsaa_max();
     rt_si32     get_fsaa();
     rt_si32     get_tile_w();
+    rt_si32     get_tile_h();
+    rt_void     set_tile(rt_si32 tile_w, rt_si32 tile_h);
+    rt_void     tune_tile(rt_Scene *scn, rt_time time, rt_FUNC_TIME f_time);
 
     rt_Scene*   get_cur_scene();
     rt_Scene*   set_cur_scene(rt_Scene *scn);
     rt_void     next_scene();
 
+    rt_void     render_batch(rt_Scene **scn, rt_si32 num, rt_time time);
+    rt_void     render_pipe(rt_Scene *scn, rt_time time);
+
+    rt_si32     set_capt(rt_si32 num, rt_si32 x_res, rt_si32 y_res);
+    rt_si32     get_capt();
+    rt_si32     write_capt();
+
     friend      class rt_SceneThread;
     friend      class rt_Scene;
 };
@@ -187,11 +281,36 @@ class rt_SceneThread : public rt_Heap
     rt_SIMD_INFOX      *s_inf;
     rt_SIMD_CAMERA     *s_cam;
     rt_SIMD_CONTEXT    *s_ctx;
+    rt_SIMD_FILTER     *s_flt;
 
     /* memory pool in the heap
      * for temporary per-frame allocs */
     rt_pntr             mpool;
     rt_ui32             msize;
+    /* pool's usage in the last frame,
+     * peak usage in the current window */
+    rt_ui32             mused;
+    rt_ui32             mpeak;
+
+    /* count of update slices at which
+     * bands stolen in the pipeline end */
+    rt_si32             pip_end;
+    /* pools' lists of chunks and reservations
+     * of the frames overlapped in the pipeline */
+    rt_pntr             pip_chn[2];
+    rt_pntr             pip_mpl[2];
+
+    /* broad-phase candidates of the last shadow query
+     * linked in "hlist's" order as next siblings and first
+     * children, "bp_lsm" stamps mark linked elements with
+     * "bp_cur" to avoid clearing arrays between queries */
+    rt_si32            *bp_cnd;
+    rt_si32            *bp_tmp;
+    rt_si32            *bp_nxt;
+    rt_si32            *bp_fch;
+    rt_si32            *bp_lst;
+    rt_si32            *bp_lsm;
+    rt_si32             bp_cur;
 
 /*  methods */
 
@@ -199,6 +318,8 @@ class rt_SceneThread : public rt_Heap
 
     rt_void     tiling(rt_vec2 p1, rt_vec2 p2);
 
+    rt_si32     bnear(rt_vec4 bmin, rt_vec4 bmax);
+
     rt_ELEM*    insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem);
 
     public:
@@ -216,9 +337,13 @@ class rt_SceneThread : public rt_Heap
     rt_void     snode(rt_Surface *srf);
     rt_void     sclip(rt_Surface *srf);
     rt_void     stile(rt_Surface *srf);
+    rt_void     sband(rt_Surface *srf);
+    rt_void     smerge(rt_Surface *srf, rt_ELEM *tls);
 
     rt_ELEM*    ssort(rt_Object *obj);
     rt_ELEM*    lsort(rt_Object *obj);
+
+    rt_void     bsort();
 };
 
 /******************************************************************************/
@@ -247,11 +372,30 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32             y_res;
     rt_si32             x_row;
     rt_ui32            *frame;
+    /* framebuffer is provided by the application */
+    rt_si32             frm_ext;
 
     /* tilebuffer's dimensions and pointer */
     rt_si32             tiles_in_row;
     rt_si32             tiles_in_col;
     rt_ELEM           **tiles;
+    /* tile dimensions of current layout,
+     * number of tiles allocated */
+    rt_si32             tile_w;
+    rt_si32             tile_h;
+    rt_si32             tiles_max;
+
+    /* regions of interest as pixel rectangles
+     * (x0, y0, x1, y1 exclusive), whole frame if none */
+    rt_si32            *rects;
+    rt_si32             rects_num;
+    rt_si32             rects_max;
+    /* spans of tiles covering the regions as
+     * (row, first and last column) in row order,
+     * first span of each row of tiles */
+    rt_si32            *spans;
+    rt_si32             spans_num;
+    rt_si32            *srows;
 
     /* framebuffer's seed-plane for path-tracer */
     rt_elem            *pseed;
@@ -263,6 +407,96 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_real            *ptr_b;
     rt_si32             pt_on;
 
+    /* path-tracer's adaptive sampling: convergence threshold
+     * (standard error of tile's mean luminance, 0 - off),
+     * active in current frame, tiles' samples differ from
+     * the frame's counter, number of tiles left to converge */
+    rt_real             pt_tol;
+    rt_si32             pt_act;
+    rt_si32             pt_sep;
+    rt_si32             pt_left;
+    /* per tile: samples, updates of variance estimates and
+     * standard error, items of adjacent tiles with the same
+     * samples as (row, first and last column, new samples) */
+    rt_real            *pt_cnt;
+    rt_si32            *pt_upd;
+    rt_real            *pt_err;
+    rt_si32            *pt_itm;
+    rt_si32             pt_num;
+    /* framebuffer's planes of previous mean luminance and
+     * sums of variance estimates (laid out as color-planes) */
+    rt_real            *ptr_l;
+    rt_real            *ptr_v;
+
+    /* path-tracer's denoiser: number of wavelet passes
+     * (0 - off), active in current frame, guide is valid,
+     * current pass (0 - colors, then filter) */
+    rt_si32             dn_on;
+    rt_si32             dn_act;
+    rt_si32             dn_val;
+    rt_si32             dn_pas;
+    /* 2 sets of per-pixel color-planes each followed by
+     * guide's planes, guide's per-sample planes captured
+     * in path-tracer's pass, per-thread staged rows */
+    rt_real            *dn_pln;
+    rt_real            *dn_alb;
+    rt_real            *dn_stg;
+
+    /* checkerboard mode: enabled, active in current frame,
+     * parity of traced pixels, history is valid */
+    rt_si32             cb_on;
+    rt_si32             cb_act;
+    rt_si32             cb_par;
+    rt_si32             cb_val;
+    /* traced pixels (half-width rows at frame's stride),
+     * history frames (previous, next) for reconstruction */
+    rt_ui32            *cb_hlf;
+    rt_ui32            *cb_hst[2];
+    /* depth of traced pixels' primary hits (at the stride
+     * of path-tracer's planes), rows staged for the filter
+     * (6 per thread: 4 neighbors, depth, output) */
+    rt_real            *cb_dep;
+    rt_elem            *cb_stg;
+    /* camera's position and ray-stepper variables
+     * of the history frame */
+    rt_vec4             cb_pos;
+    rt_vec4             cb_dir;
+    rt_vec4             cb_hor;
+    rt_vec4             cb_ver;
+
+    /* variable-rate render: off, per-tile rate map is set
+     * by the application or derived from the focal point,
+     * active in current frame, focal point and radius */
+    rt_si32             vr_on;
+    rt_si32             vr_act;
+    rt_si32             vr_fcs[3];
+    /* shading rates per tile (0 - full, 1 - 1/2, 2 - 1/4,
+     * 3 - 1/16 of the pixels), items of same-rate tiles as
+     * (row, first and last column, steps) in row order */
+    rt_si32            *vr_map;
+    rt_si32            *vr_itm;
+    rt_si32             vr_num;
+    /* traced pixels of low-rate items (compacted rows
+     * at item's own columns at frame's stride) */
+    rt_ui32            *vr_buf;
+    /* quarters of the second row per pixel for the filter
+     * (constant 0..3, then repeating for 1/2 and 1/4 steps),
+     * rows staged for the filter (5 per thread: 2 operands,
+     * 2 expanded traced rows, output) */
+    rt_elem            *vr_wgt;
+    rt_elem            *vr_stg;
+
+    /* adaptive antialiasing: mode (RT_FSAA_NO is off),
+     * active in current frame, edge blocks of each row
+     * (SIMD steps of pixels at frame's stride) */
+    rt_si32             ad_on;
+    rt_si32             ad_act;
+    rt_ui08            *ad_msk;
+    /* re-traced samples of edge blocks,
+     * samples' sums (color channels in 16-bit lanes) */
+    rt_ui32            *ad_buf;
+    rt_ui64            *ad_acc;
+
     /* aspect-ratio and pixel-width */
     rt_real             aspect;
     rt_real             factor;
@@ -274,6 +508,13 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
      * for temporary per-frame allocs */
     rt_pntr             mpool;
     rt_ui32             msize;
+    /* pool's usage in the last frame,
+     * peak usage in the current window */
+    rt_ui32             mused;
+    rt_ui32             mpeak;
+    /* frames left in the window
+     * of adaptive pools sizing */
+    rt_si32             mfrms;
     /* pending release flag */
     rt_si32             pending;
 
@@ -286,6 +527,14 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32             thnum;
     rt_SceneThread    **tharr;
     rt_pntr             tdata;
+    /* next band of rows to render
+     * when rows stealing is enabled */
+    volatile
+    rt_si32             rband;
+    /* subtrees of the hierarchy updated
+     * as separate tasks in phases 0.5, 2.5 */
+    rt_Array          **tsk_arr;
+    rt_si32             tsk_num;
 
     /* global hierarchical list */
     rt_ELEM            *hlist;
@@ -295,6 +544,27 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_ELEM            *llist;
     /* camera's surface/node list */
     rt_ELEM            *clist;
+    /* reversed camera's list for tiling */
+    rt_ELEM            *rlist;
+
+    /* broad-phase for shadow lists, "hlist's" elements
+     * in pre-order with parents, next siblings and first
+     * children (top level's at "bp_num") as indices,
+     * bounded elements sorted by lower bounds "bp_key"
+     * along the axis "bp_axs" (up to "bp_ext" apart),
+     * larger elements are checked in every query */
+    rt_ELEM           **bp_elm;
+    rt_si32            *bp_par;
+    rt_si32            *bp_nxt;
+    rt_si32            *bp_fch;
+    rt_si32             bp_num;
+    rt_si32            *bp_srt;
+    rt_real            *bp_key;
+    rt_si32             bp_snm;
+    rt_si32            *bp_big;
+    rt_si32             bp_bnm;
+    rt_si32             bp_axs;
+    rt_real             bp_ext;
 
     /* ray-position variables */
     rt_vec4             pos;
@@ -319,11 +589,101 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     /* current camera */
     rt_Camera          *cam;
     rt_si32             cam_idx;
+    /* camera of the lists
+     * retained from previous frame */
+    rt_Camera          *rcam;
+    /* scene's render is tasked to
+     * the pool as part of a batch */
+    rt_si32             bat_on;
+    /* pipelined render: frame updated in the previous
+     * call is pending, scene is updated in the pipeline,
+     * bands are stolen within update's runs, counter of
+     * update slices done, index of the pools for the
+     * next update, pools' lists of chunks and reservations */
+    rt_si32             pip_val;
+    rt_si32             pip_act;
+    rt_si32             pip_run;
+    volatile rt_si32    pip_cnt;
+    rt_si32             pip_par;
+    rt_pntr             pip_chn[2];
+    rt_pntr             pip_mpl[2];
+    /* pending frame's tilebuffer (number of tiles
+     * allocated), camera's list, ray-position and
+     * ray-stepper variables, ambient color, camera's
+     * point of view and SIMD target of the update */
+    rt_ELEM           **pip_tls;
+    rt_si32             pip_max;
+    rt_ELEM            *pip_lst;
+    rt_vec4             pip_pos;
+    rt_vec4             pip_dir;
+    rt_vec4             pip_hor;
+    rt_vec4             pip_ver;
+    rt_vec4             pip_amb;
+    rt_real             pip_pov;
+    rt_si32             pip_smd;
+
+    /* progressive render: frame in progress flag,
+     * number of tile rows completed in the frame,
+     * deadline of current call and its timer */
+    rt_si32             pstate;
+    rt_si32             pdone;
+    rt_time             ptime;
+    rt_FUNC_TIME        f_time;
+
+    /* ring of per-frame timer records,
+     * number of records in use and allocated,
+     * number of frames recorded, record of the
+     * frame being timed, its last mark and timer */
+    rt_TMRS            *tmr_arr;
+    rt_si32             tmr_num;
+    rt_si32             tmr_max;
+    rt_si32             tmr_cnt;
+    rt_TMRS            *tmr_cur;
+    rt_time             tmr_last;
+    rt_FUNC_TIME        f_tick;
+
+    /* ray and intersection counters
+     * of the last frame rendered */
+    rt_word             st_arr[RT_STAT_NUM];
+
+    /* per-tile render cost heatmap: enabled,
+     * tiles' time accumulated in current frame,
+     * tiles' cost in the last frame, its false-color
+     * image (at frame's resolution) and its timer */
+    rt_si32             hm_on;
+    rt_time            *hm_acc;
+    rt_real            *hm_buf;
+    rt_ui32            *hm_img;
+    rt_FUNC_TIME        f_cost;
 
 /*  methods */
 
     rt_void     reset_pseed();
     rt_void     reset_color();
+    rt_void     reset_parts();
+    rt_void     reset_depth();
+    rt_void     reset_tiles();
+    rt_void     reset_spans();
+    rt_void     reset_rates();
+    rt_void     reset_ptcv();
+    rt_void     reset_msize();
+    rt_void     reset_stats();
+    rt_void     reset_pipe();
+    rt_void     swap_pools(rt_si32 k);
+    rt_void     swap_simd();
+
+    rt_void     render_init(rt_time time);
+    rt_void     render_done();
+    rt_void     render_phase(rt_si32 index, rt_si32 phase);
+    rt_void     time_mark(rt_si32 slot);
+    rt_void     render_cbrd(rt_si32 index);
+    rt_void     render_rate(rt_si32 index);
+    rt_void     expand_rate(rt_si32 index, rt_elem *row,
+                            rt_ui32 *src, rt_si32 n, rt_si32 vx);
+    rt_void     render_edge(rt_si32 index);
+    rt_void     render_adaa(rt_si32 index);
+    rt_void     render_ptcv(rt_si32 index);
+    rt_void     render_dnse(rt_si32 index);
 
     public:
 
@@ -339,6 +699,7 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
 
     rt_void     update(rt_time time, rt_si32 action);
     rt_void     render(rt_time time);
+    rt_si32     render_part(rt_time time, rt_time budget, rt_FUNC_TIME f_time);
 
     rt_void     update_slice(rt_si32 index, rt_si32 phase);
     rt_void     render_slice(rt_si32 index, rt_si32 phase);
@@ -351,21 +712,46 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_void     plot_trigs();
 
     rt_si32     get_x_row();
+    rt_si32     get_row_done(rt_si32 row);
     rt_void     print_state(); /* has global scope and effect on any instance */
 
+    rt_ui32     get_msize(rt_si32 index);
+    rt_ui32     get_mused(rt_si32 index);
+    rt_ui32     get_mchunk(rt_si32 index);
+
     rt_si32     get_opts();
     rt_si32     set_opts(rt_si32 opts);
     rt_si32     get_pton();
     rt_si32     set_pton(rt_si32 pton);
+    rt_si32     get_ptcv();
+    rt_void     set_ptcv(rt_real tol);
+    rt_si32     get_dnse();
+    rt_si32     set_dnse(rt_si32 dnse);
+    rt_void     set_rects(rt_si32 num, rt_si32 *rect);
+    rt_si32     get_cbon();
+    rt_si32     set_cbon(rt_si32 cbon);
+    rt_void     set_rates(rt_si32 *rate);
+    rt_void     set_focus(rt_si32 x, rt_si32 y, rt_si32 rad);
+    rt_si32     get_adaa();
+    rt_si32     set_adaa(rt_si32 fsaa);
+    rt_TMRS*    get_tmrs(rt_si32 age);
+    rt_si32     set_tmrs(rt_si32 num, rt_FUNC_TIME f_tick);
+    rt_word     get_stat(rt_si32 index);
+    rt_real*    get_heat();
+    rt_si32     set_heat(rt_si32 heat, rt_FUNC_TIME f_cost);
 
     rt_si32     get_cam_idx();
     rt_si32     next_cam();
     rt_ui32*    get_frame();
+    rt_ui32*    set_frame(rt_ui32 *frame);
     rt_void     save_frame(rt_si32 index);
+    rt_void     save_heat(rt_si32 index);
+    rt_si32     capt_frame(rt_si32 index);
 
     rt_Platform*get_platform();
 
     friend      class rt_SceneThread;
+    friend      class rt_Platform;
 };
 
 /* internal SIMD format converter */
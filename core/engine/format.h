@@ -42,7 +42,9 @@
 #define RT_OPTS_TILING_EXT1     (1 << 2)
 #define RT_OPTS_FSCALE          (1 << 3)
 #define RT_OPTS_TARRAY          (1 << 4)
-#define RT_OPTS_VARRAY          (1 << 5) /* 6 is reserved for future exts */
+#define RT_OPTS_VARRAY          (1 << 5)
+#define RT_OPTS_VARRAY_EXT1     (1 << 6) /* prohibits auto bvnodes if 1 */
+                                         /* (read at construction only) */
 #define RT_OPTS_ADJUST          (1 << 7)
 #define RT_OPTS_UPDATE          (1 << 8)
 #define RT_OPTS_RENDER          (1 << 9)
@@ -56,9 +58,12 @@
 #define RT_OPTS_INSERT_EXT1     (0 << 17)
 #define RT_OPTS_INSERT_EXT2     (0 << 18)
 #define RT_OPTS_REMOVE          (0 << 19)
+#define RT_OPTS_DEPTHS          (1 << 16) /* sorts tile lists by bbox depth */
 
 #define RT_OPTS_GAMMA           (1 << 20) /* turns off Gamma when set to 1 */
 #define RT_OPTS_FRESNEL         (1 << 21) /* turns off Fresnel when set to 1 */
+#define RT_OPTS_STATIC          (1 << 22) /* caches lists of static frames */
+#define RT_OPTS_STEAL           (1 << 23) /* idle threads steal bands of rows */
 
 #define RT_OPTS_BUFFERS         (0 << 24) /* prohibits SIMD-buffers if 1 */
 #define RT_OPTS_PT              (1 << 25) /* prohibits path-tracer if 1 */
@@ -75,10 +80,34 @@
 /* Gamma correction (RT_OPTS_GAMMA) and Fresnel reflectance (RT_OPTS_FRESNEL)
  * optimizations are on by default (which turns corresponding properties off)
  * as scene assets need to be reworked to properly support these new features */
+/* automatic bvnodes (RT_OPTS_VARRAY_EXT1) split arrays' contents into nested
+ * pairs by the median position along the longest axis and turn every non-root
+ * array with more than one sub-object into a bounding volume, building binary
+ * hierarchy (BVH) for all rays, off by default as it slows down smaller scenes,
+ * to enable it in a particular scene add RT_OPTS_VARRAY_EXT1 to the list of
+ * optimizations to be turned off in scene definition struct, the hierarchy
+ * is built once in arrays' constructors, thus the flag is construction-time
+ * only and set_opts keeps the scene's initial value of the bit */
 /* bbox sorting (RT_OPTS_INSERT) and hidden surfaces removal (RT_OPTS_REMOVE)
- * optimizations have been turned off for poor scalability with larger scenes */
+ * optimizations have been turned off for poor scalability with larger scenes,
+ * depth sorting (RT_OPTS_DEPTHS) reuses the bit of RT_OPTS_INSERT to order
+ * tile lists front-to-back by surfaces' nearest bbox depth (merge sort),
+ * primary rays then leave the list once all hits are closer than the rest,
+ * off by default as nearest bbox depth is a poor visibility order for large
+ * or boundless surfaces, add RT_OPTS_DEPTHS to scene's optimizations to use */
+/* static-frame cache (RT_OPTS_STATIC) keeps per-frame pools reserved across
+ * frames and skips update phases 1-3 along with screen tiling if the hierarchy
+ * hasn't changed in phase 0.5, it's not an incremental update: surfaces' lists
+ * refer to frame-wide lists ("slist" from lights' elements, tiles' copies of
+ * "clist"), thus any change (camera's included) rebuilds all lists and only
+ * fully static frames are cached, not included in RT_OPTS_FULL,
+ * add it to the opts passed to set_opts to use */
+/* rows stealing (RT_OPTS_STEAL) replaces fixed rows interleaving in render
+ * with bands of tile height handed out to threads from a shared counter,
+ * per-pixel PRNG seeding is kept in the seed-plane, thus images are the same */
 
 #define RT_OPTS_NONE            (                                           \
+        RT_OPTS_VARRAY_EXT1     |                                           \
         RT_OPTS_GAMMA           |                                           \
         RT_OPTS_FRESNEL         |                                           \
         RT_OPTS_BUFFERS         |                                           \
@@ -91,6 +120,7 @@
         RT_OPTS_FSCALE          |                                           \
         RT_OPTS_TARRAY          |                                           \
         RT_OPTS_VARRAY          |                                           \
+        RT_OPTS_VARRAY_EXT1     |                                           \
         RT_OPTS_ADJUST          |                                           \
         RT_OPTS_UPDATE          |                                           \
         RT_OPTS_RENDER          |                                           \
@@ -106,6 +136,7 @@
         RT_OPTS_REMOVE          |                                           \
         RT_OPTS_GAMMA           |                                           \
         RT_OPTS_FRESNEL         |                                           \
+        RT_OPTS_STEAL           |                                           \
         RT_OPTS_BUFFERS         |                                           \
         RT_OPTS_PT              )
 
@@ -170,16 +170,22 @@ rt_void rt_Object::update_bvnode(rt_Object *bvnode, rt_bool mode)
 }
 
 /*
- * Update object's status with given "time", "flags" and "trnode".
+ * Update object's transform from animator with given "time".
  */
-rt_void rt_Object::update_status(rt_time time, rt_si32 flags,
-                                 rt_Object *trnode)
+rt_void rt_Object::update_anim(rt_time time)
 {
+    /* scene data is already up to date,
+     * no writes to shared data below */
+    if (obj->time == time)
+    {
+        return;
+    }
+
     /* animator is called only once for object
      * instances sharing the same scene data,
      * part of sequential update (phase 0.5)
      * as the code below is not thread-safe */
-    if (obj->f_anim != RT_NULL && obj->time != time)
+    if (obj->f_anim != RT_NULL)
     {
         obj->f_anim(time, obj->time < 0 ? 0 : obj->time, trm, RT_NULL);
     }
@@ -188,6 +194,15 @@ rt_void rt_Object::update_status(rt_time time, rt_si32 flags,
      * between first update and all subsequent updates,
      * even if animator is not present */
     obj->time = time;
+}
+
+/*
+ * Update object's status with given "time", "flags" and "trnode".
+ */
+rt_void rt_Object::update_status(rt_time time, rt_si32 flags,
+                                 rt_Object *trnode)
+{
+    update_anim(time);
 
     /* inherit changed status from the hierarchy */
     obj_changed = (flags & RT_UPDATE_FLAG_OBJ);
@@ -606,6 +621,7 @@ rt_Light::rt_Light(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj) :
 /*  rt_SIMD_LIGHT */
 
     s_lgt = (rt_SIMD_LIGHT *)rg->alloc(sizeof(rt_SIMD_LIGHT), RT_SIMD_ALIGN);
+    p_lgt = RT_NULL;
 
     RT_SIMD_SET(s_lgt->t_max, 1.0f);
 
@@ -666,6 +682,37 @@ rt_void rt_Light::update_fields()
     RT_SIMD_SET(s_lgt->pos_z, pos[RT_Z]);
 }
 
+/*
+ * Copy SIMD struct "src" of "size" bytes into alternate struct "dst",
+ * which is allocated on first use if NULL. Return alternate struct.
+ */
+static
+rt_pntr copy_simd(rt_Registry *rg, rt_pntr dst, rt_pntr src, rt_si32 size)
+{
+    if (dst == RT_NULL)
+    {
+        dst = rg->alloc(size, RT_SIMD_ALIGN);
+    }
+
+    memcpy(dst, src, size);
+
+    return dst;
+}
+
+/*
+ * Swap SIMD struct with its alternate taking over current contents,
+ * so that the next update doesn't overwrite the struct
+ * still referenced by the frame rendered in the pipeline.
+ */
+rt_void rt_Light::swap_simd()
+{
+    rt_SIMD_LIGHT *s_tmp = s_lgt;
+
+    s_lgt = (rt_SIMD_LIGHT *)copy_simd(rg, p_lgt, s_lgt,
+                                       sizeof(rt_SIMD_LIGHT));
+    p_lgt = s_tmp;
+}
+
 /*
  * Deinitialize light object.
  */
@@ -717,6 +764,9 @@ rt_Node::rt_Node(rt_Registry *rg, rt_Object *parent,
     /* reset relations template */
     rel = RT_NULL;
 
+    /* reset depth for sorting */
+    tmin = -RT_INF;
+
     /* validate surface size */
     ssize = RT_MAX(ssize, sizeof(rt_SIMD_SURFACE));
 
@@ -726,6 +776,9 @@ rt_Node::rt_Node(rt_Registry *rg, rt_Object *parent,
     memset(s_srf, 0, ssize);
     s_srf->srf_t[3] = tag;
 
+    p_srf = RT_NULL;
+    p_size = ssize;
+
     /* allocate SIMD-buffers (with actual number of threads) */
     if ((rg->opts & RT_OPTS_BUFFERS) == 0)
     {
@@ -1139,6 +1192,37 @@ rt_void rt_Node::update_bbgeom(rt_BOUND *box)
 #endif /* RT_OPTS_REMOVE */
 }
 
+/*
+ * Swap SIMD struct with its alternate taking over current contents,
+ * so that the next update doesn't overwrite the struct
+ * still referenced by the frame rendered in the pipeline.
+ */
+rt_void rt_Node::swap_simd()
+{
+    rt_SIMD_SURFACE *s_tmp = s_srf;
+
+    s_srf = (rt_SIMD_SURFACE *)copy_simd(rg, p_srf, s_srf, p_size);
+    p_srf = s_tmp;
+}
+
+/*
+ * Relink SIMD struct's pointers to itself and to other objects'
+ * SIMD structs, called once all structs have been swapped.
+ */
+rt_void rt_Node::link_simd()
+{
+    RT_SIMD_SET(s_srf->srf_p, (rt_uelm)((rt_ui64)(rt_uptr)s_srf & 0xFFFFFFFF));
+    RT_SIMD_SET(s_srf->srf_h, (rt_uelm)((rt_ui64)(rt_uptr)s_srf >> 32));
+
+    s_srf->mat_p[0] = outer->s_mat;
+    s_srf->mat_p[2] = inner->s_mat;
+
+    if (s_srf->msc_p[3] != RT_NULL)
+    {
+        s_srf->msc_p[3] = ((rt_Node *)trnode)->s_srf;
+    }
+}
+
 /*
  * Deinitialize node object.
  */
@@ -1177,6 +1261,59 @@ rt_SIDE sd_array01 =
 /* mat */   &mt_glass01_array01,
 };
 
+/*
+ * Reorder "num" objects from scene data "arr" so that the one
+ * in the middle has the median position along the axis "k",
+ * lower positions are put before it, higher positions after.
+ */
+static
+rt_void split_median(rt_OBJECT *arr, rt_si32 num, rt_si32 k)
+{
+    rt_si32 l = 0, r = num - 1, m = num / 2, i, j;
+    rt_OBJECT tmp;
+    rt_real pos;
+
+    while (l < r)
+    {
+        pos = arr[(l + r) / 2].trm.pos[k];
+
+        for (i = l, j = r; i <= j; )
+        {
+            while (arr[i].trm.pos[k] < pos)
+            {
+                i++;
+            }
+            while (arr[j].trm.pos[k] > pos)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                tmp = arr[i];
+                arr[i] = arr[j];
+                arr[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        /* continue within the part containing the middle */
+        if (m <= j)
+        {
+            r = j;
+        }
+        else
+        if (m >= i)
+        {
+            l = i;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
 /*
  * Instantiate array object.
  */
@@ -1192,6 +1329,15 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     arr_changed = 0;
     scn_changed = 0;
 
+    /* reset array's task status */
+    tsk_mode = 0;
+    tsk_local = 0;
+
+    tsk_time = -1;
+    tsk_flags = 0;
+    tsk_trnode = RT_NULL;
+    tsk_pmtx = RT_NULL;
+
     /* reset array's accumulated light */
     memset(&col, 0, sizeof(rt_COL));
 
@@ -1278,14 +1424,27 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     /* process array's objects */
     rt_OBJECT *arr = (rt_OBJECT *)obj->obj.pobj;
 
-    obj_num = obj->obj.obj_num;
+    rt_si32 arr_num = obj->obj.obj_num;
+
+#if RT_OPTS_VARRAY_EXT1 != 0
+    /* split array's contents into a pair of nested arrays,
+     * which are split further in their own constructors,
+     * thus automatic bvnodes below build a binary hierarchy */
+    if ((rg->opts & RT_OPTS_VARRAY) != 0
+    &&  (rg->opts & RT_OPTS_VARRAY_EXT1) == 0)
+    {
+        arr = split_array(arr, &arr_num);
+    }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+
+    obj_num = arr_num;
     obj_arr = (rt_Object **)rg->alloc(obj_num * sizeof(rt_Object *), RT_ALIGN);
 
     rt_si32 i, j; /* j - for skipping unsupported object tags */
 
     /* instantiate every object in array from scene data,
      * including sub-arrays (recursive) */
-    for (i = 0, j = 0; i < obj->obj.obj_num; i++, j++)
+    for (i = 0, j = 0; i < arr_num; i++, j++)
     {
         switch (arr[i].obj.tag)
         {
@@ -1387,6 +1546,20 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
         }
     }
 
+#if RT_OPTS_VARRAY_EXT1 != 0
+    /* enable bounding volume for every non-root array with more than
+     * one sub-object, including nested arrays from the split above,
+     * thus building a hierarchy of bvnodes (BVH) used by primary,
+     * secondary and shadow rays alike, explicit relations below
+     * (and in parent arrays) take precedence over automatic bvnodes */
+    if ((rg->opts & RT_OPTS_VARRAY) != 0
+    &&  (rg->opts & RT_OPTS_VARRAY_EXT1) == 0
+    &&  parent != RT_NULL && obj_num > 1)
+    {
+        update_bvnode(this, RT_TRUE);
+    }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+
     /* process array's relations */
     rt_RELATION *rel = obj->obj.prel;
 
@@ -1613,6 +1786,7 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
 
     s_inb = (rt_SIMD_SURFACE *)rg->alloc(ssize, RT_SIMD_ALIGN);
     memset(s_inb, 0, ssize);
+    p_inb = RT_NULL;
     s_inb->srf_t[3] = RT_TAG_SURFACE_MAX;
 
     s_inb->mat_p[0] = outer->s_mat;
@@ -1631,6 +1805,7 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
 
     s_bvb = (rt_SIMD_SURFACE *)rg->alloc(ssize, RT_SIMD_ALIGN);
     memset(s_bvb, 0, ssize);
+    p_bvb = RT_NULL;
     s_bvb->srf_t[3] = RT_TAG_SURFACE_MAX;
 
     s_bvb->mat_p[0] = outer->s_mat;
@@ -1646,6 +1821,105 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     RT_SIMD_SET(s_bvb->t_eps, RT_TEPS_THRESHOLD);
 }
 
+/*
+ * Split surfaces and sub-arrays from array's scene data "arr" of "num"
+ * objects into a pair of nested arrays (with identity transform) by the
+ * median of their positions along the longest axis of their spread,
+ * other objects (cameras) are kept in place after the split.
+ * Arrays with relations, with ancestors indexing into sub-arrays
+ * or with lights (accumulated for the array's emitting surfaces)
+ * aren't split, as well as arrays of up to RT_SPLIT_LIMIT objects.
+ * Return new scene data with updated "num" or original "arr".
+ */
+rt_OBJECT* rt_Array::split_array(rt_OBJECT *arr, rt_si32 *num)
+{
+    rt_si32 i, j, k, n;
+    rt_Array *par;
+
+    /* relations address objects by indices in scene data */
+    for (par = this; par != RT_NULL; par = (rt_Array *)par->parent)
+    {
+        rt_RELATION *rel = par->obj->obj.prel;
+
+        for (i = 0; i < par->obj->obj.rel_num; i++)
+        {
+            if (par == this || rel[i].rel == RT_REL_INDEX_ARRAY)
+            {
+                return arr;
+            }
+        }
+    }
+
+    rt_vec3 bmin, bmax;
+
+    RT_VEC3_SET_VAL1(bmin, +RT_INF);
+    RT_VEC3_SET_VAL1(bmax, -RT_INF);
+
+    /* count objects to be split and their spread */
+    for (i = 0, n = 0; i < *num; i++)
+    {
+        if (arr[i].obj.tag == RT_TAG_LIGHT)
+        {
+            return arr;
+        }
+        if (arr[i].obj.tag >= RT_TAG_ARRAY
+        &&  arr[i].obj.tag < RT_TAG_SURFACE_MAX)
+        {
+            for (k = 0; k < 3; k++)
+            {
+                bmin[k] = RT_MIN(bmin[k], arr[i].trm.pos[k]);
+                bmax[k] = RT_MAX(bmax[k], arr[i].trm.pos[k]);
+            }
+            n++;
+        }
+    }
+
+    if (n <= RT_SPLIT_LIMIT)
+    {
+        return arr;
+    }
+
+    /* select the longest axis */
+    k = RT_X;
+    k = bmax[RT_Y] - bmin[RT_Y] > bmax[k] - bmin[k] ? RT_Y : k;
+    k = bmax[RT_Z] - bmin[RT_Z] > bmax[k] - bmin[k] ? RT_Z : k;
+
+    /* new scene data for the array is followed by
+     * the split objects referenced by nested arrays */
+    rt_OBJECT *out = (rt_OBJECT *)
+            rg->alloc((*num + 2) * sizeof(rt_OBJECT), RT_ALIGN);
+    rt_OBJECT *spl = out + *num - n + 2;
+
+    for (i = 0, j = 0, n = 0; i < *num; i++)
+    {
+        if (arr[i].obj.tag >= RT_TAG_ARRAY
+        &&  arr[i].obj.tag < RT_TAG_SURFACE_MAX)
+        {
+            spl[n++] = arr[i];
+        }
+        else
+        {
+            out[j++] = arr[i];
+        }
+    }
+
+    split_median(spl, n, k);
+
+    for (i = 0; i < 2; i++, j++)
+    {
+        memset(&out[j], 0, sizeof(rt_OBJECT));
+        RT_VEC3_SET_VAL1(out[j].trm.scl, 1.0f);
+
+        out[j].obj.tag = RT_TAG_ARRAY;
+        out[j].obj.pobj = spl + i * (n / 2);
+        out[j].obj.obj_num = i == 0 ? n / 2 : n - n / 2;
+    }
+
+    *num = j;
+
+    return out;
+}
+
 /*
  * Build relations template based on given template "lst" from scene data.
  */
@@ -1766,6 +2040,21 @@ rt_void rt_Array::update_object(rt_time time, rt_si32 flags,
      * updated trnode and matrix pointer for sub-objects */
     for (i = 0; i < obj_num; i++)
     {
+        /* defer update of sub-arrays processed as separate tasks,
+         * their changed status is aggregated in update_scnchg */
+        if (RT_IS_ARRAY(obj_arr[i])
+        &&  ((rt_Array *)obj_arr[i])->tsk_mode == 1)
+        {
+            rt_Array *arr = (rt_Array *)obj_arr[i];
+
+            arr->tsk_time = time;
+            arr->tsk_flags = flags | mtx_has_trm | obj_changed;
+            arr->tsk_trnode = this->trnode;
+            arr->tsk_pmtx = pmtx;
+
+            continue;
+        }
+
         obj_arr[i]->update_object(time, flags | mtx_has_trm | obj_changed,
                                   this->trnode, *pmtx);
 
@@ -1895,7 +2184,13 @@ rt_void rt_Array::update_bounds()
         {
             nd = (rt_Node *)obj_arr[i];
             arr = (rt_Array *)nd;
-            arr->update_bounds();
+
+            /* skip sub-arrays already processed as separate tasks,
+             * but still contribute their bounds below */
+            if (arr->tsk_mode != 2)
+            {
+                arr->update_bounds();
+            }
         }
         else
         if (RT_IS_SURFACE(obj_arr[i]))
@@ -2340,6 +2635,130 @@ rt_void rt_Array::update_bounds()
     }
 }
 
+/*
+ * Check if bvnodes of all sub-objects (recursive)
+ * are found within the subtree of given array "top".
+ */
+rt_bool rt_Array::check_bvnode(rt_Array *top)
+{
+    rt_si32 i;
+    rt_Object *par;
+
+    for (i = 0; i < obj_num; i++)
+    {
+        for (par = obj_arr[i]->bvnode; par != RT_NULL; par = par->parent)
+        {
+            if (par == top)
+            {
+                break;
+            }
+        }
+
+        if (obj_arr[i]->bvnode != RT_NULL && par == RT_NULL)
+        {
+            return RT_FALSE;
+        }
+
+        if (RT_IS_ARRAY(obj_arr[i])
+        &&  ((rt_Array *)obj_arr[i])->check_bvnode(top) == RT_FALSE)
+        {
+            return RT_FALSE;
+        }
+    }
+
+    return RT_TRUE;
+}
+
+/*
+ * Update array's subtree as a separate task (multi-threaded),
+ * the part of the hierarchy above the task is updated sequentially.
+ */
+rt_void rt_Array::update_task()
+{
+    /* arguments were saved by parent's update_object */
+    if (tsk_mode == 1)
+    {
+        update_object(tsk_time, tsk_flags, tsk_trnode, *tsk_pmtx);
+    }
+    else
+    /* bounds are contributed to the hierarchy
+     * above the task by parent's update_bounds */
+    if (tsk_mode == 2)
+    {
+        update_bounds();
+    }
+}
+
+/*
+ * Update array's changed status from sub-objects (recursive),
+ * stop at sub-arrays already processed as separate tasks.
+ */
+rt_void rt_Array::update_scnchg()
+{
+    scn_changed = 0;
+
+    rt_si32 i;
+
+    for (i = 0; i < obj_num; i++)
+    {
+        if (RT_IS_ARRAY(obj_arr[i]))
+        {
+            rt_Array *arr = (rt_Array *)obj_arr[i];
+
+            if (arr->tsk_mode == 0)
+            {
+                arr->update_scnchg();
+            }
+
+            scn_changed |= arr->scn_changed;
+        }
+        else
+        {
+            scn_changed |= obj_arr[i]->obj_changed;
+        }
+    }
+}
+
+/*
+ * Swap SIMD structs with their alternates taking over current contents,
+ * so that the next update doesn't overwrite the structs
+ * still referenced by the frame rendered in the pipeline.
+ */
+rt_void rt_Array::swap_simd()
+{
+    rt_SIMD_SURFACE *s_tmp;
+
+    rt_Node::swap_simd();
+
+    s_tmp = s_inb;
+    s_inb = (rt_SIMD_SURFACE *)copy_simd(rg, p_inb, s_inb, p_size);
+    p_inb = s_tmp;
+
+    s_tmp = s_bvb;
+    s_bvb = (rt_SIMD_SURFACE *)copy_simd(rg, p_bvb, s_bvb, p_size);
+    p_bvb = s_tmp;
+}
+
+/*
+ * Relink SIMD structs' pointers to other objects' SIMD structs,
+ * called once all structs have been swapped.
+ */
+rt_void rt_Array::link_simd()
+{
+    rt_Node::link_simd();
+
+    s_inb->mat_p[0] = outer->s_mat;
+    s_inb->mat_p[2] = inner->s_mat;
+
+    if (s_inb->msc_p[3] != RT_NULL)
+    {
+        s_inb->msc_p[3] = ((rt_Node *)trnode)->s_srf;
+    }
+
+    s_bvb->mat_p[0] = outer->s_mat;
+    s_bvb->mat_p[2] = inner->s_mat;
+}
+
 /*
  * Deinitialize array object.
  */
@@ -2376,6 +2795,14 @@ rt_Surface::rt_Surface(rt_Registry *rg, rt_Object *parent,
     /* reset surface's changed status */
     srf_changed = 0;
 
+    /* reset surface's update costs */
+    cost[0] = cost[1] = 1;
+    part[0] = part[1] = 0;
+
+    /* tiles list bands are allocated by the scene */
+    tls = RT_NULL;
+    tlb = RT_NULL;
+
     /* init outer side material */
     outer = new(rg) rt_Material(rg, &srf->side_outer,
                     obj->obj.pmat_outer ? obj->obj.pmat_outer :
@@ -2869,6 +3296,17 @@ rt_void rt_Surface::update_bounds()
     RT_SIMD_SET(s_srf->max_z, shape->bmax[RT_Z] - pps[RT_Z]);
 }
 
+/*
+ * Relink SIMD struct's pointers after all structs have been swapped,
+ * surface's shape keeps the address of its custom clippers list.
+ */
+rt_void rt_Surface::link_simd()
+{
+    rt_Node::link_simd();
+
+    shape->ptr = (rt_pntr*)&s_srf->msc_p[2];
+}
+
 /*
  * Deinitialize surface object.
  */
@@ -4120,6 +4558,7 @@ rt_Material::rt_Material(rt_Registry *rg, rt_SIDE *sd, rt_MATERIAL *mat) :
 
     s_mat = (rt_SIMD_MATERIAL *)
             rg->alloc(sizeof(rt_SIMD_MATERIAL), RT_SIMD_ALIGN);
+    p_mat = RT_NULL;
 
     s_mat->t_map[RT_X] = map[RT_X] * RT_SIMD_QUADS * 16;
     s_mat->t_map[RT_Y] = map[RT_Y] * RT_SIMD_QUADS * 16;
@@ -4246,6 +4685,20 @@ rt_void rt_Material::resolve_texture(rt_Registry *rg)
 #endif /* (RT_POINTER - RT_ADDRESS) */
 }
 
+/*
+ * Swap SIMD struct with its alternate taking over current contents,
+ * so that the next update doesn't overwrite the struct
+ * still referenced by the frame rendered in the pipeline.
+ */
+rt_void rt_Material::swap_simd(rt_Registry *rg)
+{
+    rt_SIMD_MATERIAL *s_tmp = s_mat;
+
+    s_mat = (rt_SIMD_MATERIAL *)copy_simd(rg, p_mat, s_mat,
+                                          sizeof(rt_SIMD_MATERIAL));
+    p_mat = s_tmp;
+}
+
 /*
  * Deinitialize material.
  */
@@ -31,6 +31,8 @@
 #define RT_EDGES_LIMIT          12 /* maximum number of edges for bbox */
 #define RT_FACES_LIMIT          6  /* maximum number of faces for bbox */
 
+#define RT_SPLIT_LIMIT          8  /* maximum number of objects in leaf bvh */
+
 /*
  * Floating point thresholds,
  * values have been roughly selected for single-precision,
@@ -293,6 +295,8 @@ class rt_Object
     virtual
     rt_void update_bvnode(rt_Object *bvnode, rt_bool mode);
 
+    rt_void update_anim(rt_time time);
+
     virtual
     rt_void update_object(rt_time time, rt_si32 flags,
                           rt_Object *trnode, rt_mat4 mtx);
@@ -367,6 +371,10 @@ class rt_Light : public rt_Object, public rt_List<rt_Light>
 
     rt_SIMD_LIGHT      *s_lgt;
 
+    /* alternate light SIMD struct
+     * for frames overlapped in the pipeline */
+    rt_SIMD_LIGHT      *p_lgt;
+
 /*  methods */
 
     public:
@@ -381,6 +389,8 @@ class rt_Light : public rt_Object, public rt_List<rt_Light>
                           rt_Object *trnode, rt_mat4 mtx);
     virtual
     rt_void update_fields();
+
+    rt_void swap_simd();
 };
 
 /******************************************************************************/
@@ -405,10 +415,19 @@ class rt_Node : public rt_Object
      * for arrays and surfaces */
     rt_ELEM            *rel;
 
+    /* nearest bbox depth along camera's
+     * primary rays for tile lists sorting */
+    rt_real             tmin;
+
     /* surface SIMD struct,
      * used for trnode if present */
     rt_SIMD_SURFACE    *s_srf;
 
+    /* alternate surface SIMD struct
+     * for frames overlapped in the pipeline */
+    rt_SIMD_SURFACE    *p_srf;
+    rt_si32             p_size;
+
 /*  methods */
 
     protected:
@@ -437,6 +456,11 @@ class rt_Node : public rt_Object
                           rt_Object *trnode, rt_mat4 mtx);
     virtual
     rt_void update_fields();
+
+    virtual
+    rt_void swap_simd();
+    virtual
+    rt_void link_simd();
 };
 
 /******************************************************************************/
@@ -496,6 +520,27 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
      * used for bvbox part of bvnode */
     rt_SIMD_SURFACE    *s_bvb;
 
+    /* alternate SIMD structs for inbox and bvbox
+     * for frames overlapped in the pipeline */
+    rt_SIMD_SURFACE    *p_inb;
+    rt_SIMD_SURFACE    *p_bvb;
+
+    /* non-zero if array's subtree is updated
+     * as a separate task (multi-threaded),
+     * 1 - in phase 0.5, 2 - in phase 2.5 */
+    rt_si32             tsk_mode;
+
+    /* non-zero if bvnodes of all sub-objects
+     * are found within array's subtree */
+    rt_si32             tsk_local;
+
+    /* arguments for deferred update
+     * of array's subtree in phase 0.5 */
+    rt_time             tsk_time;
+    rt_si32             tsk_flags;
+    rt_Object          *tsk_trnode;
+    rt_mat4            *tsk_pmtx;
+
 /*  methods */
 
     protected:
@@ -504,6 +549,8 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
 
     rt_void update_matrix(rt_mat4 mtx);
 
+    rt_OBJECT* split_array(rt_OBJECT *arr, rt_si32 *num);
+
     public:
 
     rt_Array(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj,
@@ -523,7 +570,16 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
     virtual
     rt_void update_fields();
 
+    virtual
+    rt_void swap_simd();
+    virtual
+    rt_void link_simd();
+
     rt_void update_bounds();
+
+    rt_bool check_bvnode(rt_Array *top);
+    rt_void update_task();
+    rt_void update_scnchg();
 };
 
 /******************************************************************************/
@@ -559,10 +615,22 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
      * prepared for rendering */
     rt_ELEM            *tls;
 
+    /* tiles list split into bands
+     * of tile rows (one per thread) */
+    rt_ELEM           **tlb;
+
     /* surface shape extension to
      * bounding box and volume */
     rt_SHAPE           *shape;
 
+    /* update cost estimates for phases 2, 3
+     * from list lengths of the previous frame */
+    rt_si32             cost[2];
+
+    /* thread index for phases 2, 3
+     * from cost-balanced partitioning */
+    rt_si32             part[2];
+
 /*  methods */
 
     protected:
@@ -601,6 +669,9 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
     virtual
     rt_void update_fields();
 
+    virtual
+    rt_void link_simd();
+
     rt_void update_bounds();
 };
 
@@ -1019,6 +1090,10 @@ class rt_Material : public rt_List<rt_Material>
     rt_SIMD_MATERIAL   *s_mat;
     rt_si32             props;
 
+    /* alternate material SIMD struct
+     * for frames overlapped in the pipeline */
+    rt_SIMD_MATERIAL   *p_mat;
+
 /*  methods */
 
     public:
@@ -1032,6 +1107,8 @@ class rt_Material : public rt_List<rt_Material>
    ~rt_Material();
 
     rt_void resolve_texture(rt_Registry *rg);
+
+    rt_void swap_simd(rt_Registry *rg);
 };
 
 #endif /* RT_OBJECT_H */
@@ -993,6 +993,65 @@ rt_si32 clip_side(rt_SHAPE *srf, rt_vec4 pos)
     return c;
 }
 
+/*
+ * Compute axis-aligned box "bmin", "bmax" enclosing "obj's" bbox "mid"
+ * (light's "pos") and "nd2's" bounding sphere, which contains all
+ * segments between the light and "nd2" (broad-phase for "bbox_shad").
+ *
+ * Return values:
+ *   0 - box is unbounded
+ *   1 - box is computed
+ */
+rt_si32 bbox_hull(rt_BOUND *obj, rt_BOUND *nd2, rt_vec4 bmin, rt_vec4 bmax)
+{
+    if (nd2->rad == RT_INF || obj->rad == RT_INF)
+    {
+        return 0;
+    }
+
+    rt_vec4 rad_vec;
+    RT_VEC3_SET_VAL1(rad_vec, nd2->rad);
+
+    RT_VEC3_SUB(bmin, nd2->mid, rad_vec);
+    RT_VEC3_ADD(bmax, nd2->mid, rad_vec);
+
+    RT_VEC3_MIN(bmin, bmin, obj->mid);
+    RT_VEC3_MAX(bmax, bmax, obj->mid);
+
+    return 1;
+}
+
+/*
+ * Determine if "nd1's" bounding sphere overlaps axis-aligned box
+ * "bmin", "bmax" computed by "bbox_hull" (broad-phase for "bbox_shad").
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 bbox_near(rt_BOUND *nd1, rt_vec4 bmin, rt_vec4 bmax)
+{
+    if (nd1->rad == RT_INF)
+    {
+        return 1;
+    }
+
+    rt_real dff_dot = 0.0f;
+    rt_si32 i;
+
+    /* accumulate squared distance
+     * from sphere's center to the box */
+    for (i = 0; i < 3; i++)
+    {
+        rt_real dff_val = nd1->mid[i] < bmin[i] ? bmin[i] - nd1->mid[i] :
+                          nd1->mid[i] > bmax[i] ? nd1->mid[i] - bmax[i] : 0.0f;
+
+        dff_dot += dff_val * dff_val;
+    }
+
+    return dff_dot <= nd1->rad * nd1->rad ? 1 : 0;
+}
+
 /*
  * Determine if "nd1's" bbox casts shadow on "nd2's" bbox
  * as seen from "obj's" bbox "mid" (light's "pos").
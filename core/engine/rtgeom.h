@@ -318,6 +318,27 @@ struct rt_SHAPE : public rt_BOUND
     rt_pntr            *ptr;
 };
 
+/*
+ * Compute axis-aligned box "bmin", "bmax" enclosing "obj's" bbox "mid"
+ * (light's "pos") and "nd2's" bounding sphere, which contains all
+ * segments between the light and "nd2" (broad-phase for "bbox_shad").
+ *
+ * Return values:
+ *   0 - box is unbounded
+ *   1 - box is computed
+ */
+rt_si32 bbox_hull(rt_BOUND *obj, rt_BOUND *nd2, rt_vec4 bmin, rt_vec4 bmax);
+
+/*
+ * Determine if "nd1's" bounding sphere overlaps axis-aligned box
+ * "bmin", "bmax" computed by "bbox_hull" (broad-phase for "bbox_shad").
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 bbox_near(rt_BOUND *nd1, rt_vec4 bmin, rt_vec4 bmax);
+
 /*
  * Determine if "nd1's" bbox casts shadow on "nd2's" bbox
  * as seen from "obj's" bbox "mid" (light's "pos").
@@ -200,162 +200,115 @@ rt_void load_image(rt_Heap *hp, rt_pstr name, rt_TEX *tx)
         ((rt_byte *)(p))[3] = ((w) >> 0x18) & 0xFF
 
 /*
- * Save image from memory to file.
+ * Pack image from memory to BMP file format in "data" (if not NULL),
+ * return size of the packed image in bytes.
  */
-rt_void save_image(rt_Heap *hp, rt_pstr name, rt_TEX *tx)
+rt_size pack_image(rt_TEX *tx, rt_pntr data)
 {
-#if RT_EMBED_FILEIO == 0
     rt_ui32 *p = RT_NULL;
-    rt_si32 i, k, n;
-
-    rt_pstr path = RT_PATH_DUMP;
-    rt_size len = strlen(path);
-    rt_char *fullpath = (rt_char *)hp->alloc(len + strlen(name) + 1, 0);
-
-    strcpy(fullpath, path);
-    strcpy(fullpath + len, name);
-
-    rt_File fl(fullpath, "wb");
-    rt_File *f = &fl;
-
-    /* release memory for temporary fullpath string,
-     * would also release all allocs made after fullpath */
-    hp->release(fullpath);
+    rt_si32 i, j, k;
 
     rt_ui32 boffset = 54, binfo = 40, bmeter = 4000, bzero = 0;
     rt_si32 bwidth = RT_ABS32(tx->x_dim), bheight = RT_ABS32(tx->y_dim);
-    rt_ui32 bsize = boffset + bwidth * bheight * 3, buf;
+    rt_si32 bstride = ((bwidth*3+3)/4)*4; /* rows are padded to 4 bytes */
+    rt_ui32 bimage = bstride * bheight, bsize = boffset + bimage;
     rt_ui16 bdepth = 24, bplanes = 1, bsig = 0x4D42;
 
-    do /* use "do {break} while(0)" instead of "goto label" */
-    {
-        if (f->error() != 0)
-        {
-            break;
-        }
-
-        RT_SAVE_H(bsig, &buf);
-        if (f->save(&buf, sizeof(bsig), 1) != 1)
-        {
-            break;
-        }
-
-        RT_SAVE_W(bsize, &buf);
-        if (f->save(&buf, sizeof(bsize), 1) != 1)
-        {
-            break;
-        }
-
-        RT_SAVE_W(bzero, &buf);
-        if (f->save(&buf, sizeof(bzero), 1) != 1)
-        {
-            break;
-        }
+    rt_byte *b = (rt_byte *)data;
 
-        RT_SAVE_W(boffset, &buf);
-        if (f->save(&buf, sizeof(boffset), 1) != 1)
-        {
-            break;
-        }
-
-        RT_SAVE_W(binfo, &buf);
-        if (f->save(&buf, sizeof(binfo), 1) != 1)
-        {
-            break;
-        }
-
-        RT_SAVE_W(tx->x_dim, &buf);
-        if (f->save(&buf, sizeof(tx->x_dim), 1) != 1)
-        {
-            break;
-        }
+    if (b == RT_NULL)
+    {
+        return bsize;
+    }
 
-        RT_SAVE_W(tx->y_dim, &buf);
-        if (f->save(&buf, sizeof(tx->y_dim), 1) != 1)
-        {
-            break;
-        }
+    RT_SAVE_H(bsig,         b +  0);
+    RT_SAVE_W(bsize,        b +  2);
+    RT_SAVE_W(bzero,        b +  6);
+    RT_SAVE_W(boffset,      b + 10);
+    RT_SAVE_W(binfo,        b + 14);
+    RT_SAVE_W(tx->x_dim,    b + 18);
+    RT_SAVE_W(tx->y_dim,    b + 22);
+    RT_SAVE_H(bplanes,      b + 26);
+    RT_SAVE_H(bdepth,       b + 28);
+    RT_SAVE_W(bzero,        b + 30);
+    RT_SAVE_W(bimage,       b + 34);
+    RT_SAVE_W(bmeter,       b + 38);
+    RT_SAVE_W(bmeter,       b + 42);
+    RT_SAVE_W(bzero,        b + 46);
+    RT_SAVE_W(bzero,        b + 50);
+
+    b += boffset;
+
+    for (i = 0; i < bheight; i++, b += bstride)
+    {
+        /* tex's stride is taken from tex_num if greater than width */
+        p = (rt_ui32 *)tx->ptex + i * RT_MAX(tx->tex_num, bwidth);
 
-        RT_SAVE_H(bplanes, &buf);
-        if (f->save(&buf, sizeof(bplanes), 1) != 1)
+        for (j = 0; j < bwidth; j++)
         {
-            break;
+            b[j*3+0] = (p[j] >> 0x00) & 0xFF;
+            b[j*3+1] = (p[j] >> 0x08) & 0xFF;
+            b[j*3+2] = (p[j] >> 0x10) & 0xFF;
         }
 
-        RT_SAVE_H(bdepth, &buf);
-        if (f->save(&buf, sizeof(bdepth), 1) != 1)
+        for (k = bwidth*3; k < bstride; k++)
         {
-            break;
+            b[k] = 0;
         }
+    }
 
-        RT_SAVE_W(bzero, &buf);
-        if (f->save(&buf, sizeof(bzero), 1) != 1)
-        {
-            break;
-        }
+    return bsize;
+}
 
-        bsize -= boffset;
+/*
+ * Save packed image "data" of given "size" to file with full "path",
+ * the whole image is written at once, return 1 on success, 0 otherwise.
+ */
+rt_si32 dump_image(rt_pstr path, rt_pntr data, rt_size size)
+{
+#if RT_EMBED_FILEIO == 0
+    rt_File fl(path, "wb");
+    rt_File *f = &fl;
 
-        RT_SAVE_W(bsize, &buf);
-        if (f->save(&buf, sizeof(bsize), 1) != 1)
-        {
-            break;
-        }
+    if (f->error() != 0 || f->save(data, size, 1) != 1)
+    {
+        return 0;
+    }
 
-        RT_SAVE_W(bmeter, &buf);
-        if (f->save(&buf, sizeof(bmeter), 1) != 1)
-        {
-            break;
-        }
+    return 1;
+#else /* RT_EMBED_FILEIO */
+    return 0;
+#endif /* RT_EMBED_FILEIO */
+}
 
-        RT_SAVE_W(bmeter, &buf);
-        if (f->save(&buf, sizeof(bmeter), 1) != 1)
-        {
-            break;
-        }
+/*
+ * Save image from memory to file.
+ */
+rt_void save_image(rt_Heap *hp, rt_pstr name, rt_TEX *tx)
+{
+#if RT_EMBED_FILEIO == 0
+    rt_pstr path = RT_PATH_DUMP;
+    rt_size len = strlen(path);
+    rt_char *fullpath = (rt_char *)hp->alloc(len + strlen(name) + 1, 0);
 
-        RT_SAVE_W(bzero, &buf);
-        if (f->save(&buf, sizeof(bzero), 1) != 1)
-        {
-            break;
-        }
+    strcpy(fullpath, path);
+    strcpy(fullpath + len, name);
 
-        RT_SAVE_W(bzero, &buf);
-        if (f->save(&buf, sizeof(bzero), 1) != 1)
-        {
-            break;
-        }
+    rt_size size = pack_image(tx, RT_NULL);
+    rt_pntr data = hp->alloc(size, RT_ALIGN);
 
-        n = bwidth * bheight;
+    pack_image(tx, data);
 
-        for (i = 0, p = (rt_ui32 *)tx->ptex; i < n; i++, p++)
-        {
-            RT_SAVE_W(*p, &buf);
-            if (f->save(&buf, 3, 1) != 1)
-            {
-                break;
-            }
-            if ((i+1) % bwidth == 0) /* <- temp fix for tex's stride */
-            {
-                p += RT_MAX(tx->tex_num, bwidth) - bwidth;
-                k = ((bwidth*3+3)/4)*4 - (bwidth*3); buf = 0;
-                if (k != 0 && f->save(&buf, k, 1) != 1)
-                {
-                    break;
-                }
-            }
-        }
+    rt_si32 r = dump_image(fullpath, data, size);
 
-        if (i < n)
-        {
-            break;
-        }
+    /* release memory for temporary fullpath string and image,
+     * would also release all allocs made after fullpath */
+    hp->release(fullpath);
 
-        return;
+    if (r == 0)
+    {
+        throw rt_Exception("failed to save image");
     }
-    while (0);
-
-    throw rt_Exception("failed to save image");
 #endif /* RT_EMBED_FILEIO */
 }
 
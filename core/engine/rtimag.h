@@ -41,6 +41,18 @@
  */
 rt_void load_image(rt_Heap *hp, rt_pstr name, rt_TEX *tx);
 
+/*
+ * Pack image from memory to BMP file format in "data" (if not NULL),
+ * return size of the packed image in bytes.
+ */
+rt_size pack_image(rt_TEX *tx, rt_pntr data);
+
+/*
+ * Save packed image "data" of given "size" to file with full "path",
+ * return 1 on success, 0 otherwise.
+ */
+rt_si32 dump_image(rt_pstr path, rt_pntr data, rt_size size);
+
 /*
  * Save image from memory to file.
  */
@@ -284,6 +284,130 @@ rt_pntr rt_Heap::release(rt_pntr ptr)
     return RT_NULL;
 }
 
+/*
+ * Return number of bytes allocated after given "ptr" was reserved,
+ * including chunks allocated afterwards if reserved area overflowed.
+ */
+rt_size rt_Heap::usage(rt_pntr ptr)
+{
+    rt_CHUNK *chunk = head;
+    rt_size size = 0;
+
+    /* sum up chunks allocated after the chunk where "ptr" belongs */
+    while (chunk != RT_NULL && (ptr < chunk + 1 || ptr >= chunk->end))
+    {
+        size += chunk->ptr - (rt_byte *)(chunk + 1);
+        chunk = chunk->next;
+    }
+
+    if (chunk != RT_NULL && chunk->ptr >= (rt_byte *)ptr)
+    {
+        size += chunk->ptr - (rt_byte *)ptr;
+    }
+
+    return size;
+}
+
+/*
+ * Free head chunk if nothing is allocated in it and it's more than twice
+ * as big as needed for given "size" bytes with given "align", so that
+ * next reserve fits into previous chunk or allocates a smaller one.
+ * The very first chunk of the heap is never freed.
+ */
+rt_void rt_Heap::trim(rt_size size, rt_ui32 align)
+{
+    /* compute align */
+    rt_size mask = align > 0 ? align - 1 : 0;
+    rt_byte *ptr = (rt_byte *)(((rt_size)(head + 1) + mask) & ~mask);
+
+    if (head->next == RT_NULL || head->ptr > ptr
+    ||  (rt_size)(head->end - ptr) <= size * 2)
+    {
+        return;
+    }
+
+    rt_pntr *obj = &obj_head;
+
+    /* traverse the list of free objects */
+    while (*obj != RT_NULL)
+    {
+        /* remove free object from the chunk */
+        if (*obj >= head + 1 && *obj < head->end)
+        {
+            *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
+            *obj = *(rt_pntr *)*obj; /* remove object from the list */
+            continue;
+        }
+
+        /* move to the next object */
+        obj = (rt_pntr *)*obj;
+    }
+
+    /* release chunk */
+    rt_CHUNK *chunk = head->next;
+    f_free(head, head->size);
+    head = chunk;
+}
+
+/*
+ * Return size of the chunk where given "ptr" was reserved with given "align"
+ * if nothing precedes "ptr" in the chunk (chunk of its own), 0 otherwise.
+ */
+rt_size rt_Heap::chunk(rt_pntr ptr, rt_ui32 align)
+{
+    rt_CHUNK *chunk = head;
+
+    /* search chunk where "ptr" belongs */
+    while (chunk != RT_NULL && (ptr < chunk + 1 || ptr >= chunk->end))
+    {
+        chunk = chunk->next;
+    }
+
+    if (chunk != RT_NULL
+    &&  (rt_size)((rt_byte *)ptr - (rt_byte *)(chunk + 1)) < align)
+    {
+        return chunk->size;
+    }
+
+    return 0;
+}
+
+/*
+ * Exchange heap's list of chunks with given list "ptr" (a new one with
+ * a single chunk if NULL), so that allocs can be switched between lists
+ * released independently. Objects are never allocated in such lists.
+ * Return previous list of chunks.
+ */
+rt_pntr rt_Heap::chain(rt_pntr ptr)
+{
+    rt_CHUNK *chunk = head;
+
+    head = (rt_CHUNK *)ptr;
+
+    if (head == RT_NULL)
+    {
+        chunk_alloc(0, RT_ALIGN);
+    }
+
+    return chunk;
+}
+
+/*
+ * Free all chunks of given list "ptr" previously exchanged
+ * with heap's list of chunks, "ptr" must not be heap's current list.
+ */
+rt_void rt_Heap::unchain(rt_pntr ptr)
+{
+    rt_CHUNK *chunk = (rt_CHUNK *)ptr;
+
+    while (chunk != RT_NULL)
+    {
+        ptr = chunk->next;
+        f_free(chunk, chunk->size);
+        chunk = (rt_CHUNK *)ptr;
+    }
+}
+
 /*
  * Allocate given "size" bytes of memory with given "align",
  * search the list of free objects, move heap pointer otherwise.
@@ -136,6 +136,11 @@ class rt_Heap
     rt_pntr alloc(rt_size size, rt_ui32 align);
     rt_pntr reserve(rt_size size, rt_ui32 align);
     rt_pntr release(rt_pntr ptr);
+    rt_size usage(rt_pntr ptr);
+    rt_void trim(rt_size size, rt_ui32 align);
+    rt_size chunk(rt_pntr ptr, rt_ui32 align);
+    rt_pntr chain(rt_pntr ptr);
+    rt_void unchain(rt_pntr ptr);
 
     rt_pntr obj_alloc(rt_size size, rt_ui32 align);
     rt_pntr obj_free(rt_pntr ptr);
@@ -46,6 +46,7 @@
 #define RT_PLOT_FUNCS_REF           0   /* set to 1 to plot reference code */
 
 #define RT_FEAT_TILING              1
+#define RT_FEAT_TILING_DEPTH        1   /* early exit from sorted tile lists */
 #define RT_FEAT_ANTIALIASING        1   /* <- breaks AA in the engine if 0 */
 #define RT_FEAT_MULTITHREADING      1   /* <- breaks MT in the engine if 0 */
 #define RT_FEAT_CLIPPING_MINMAX     1   /* <- breaks BB in the engine if 0 */
@@ -2144,7 +2145,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNDX)
+        movxx_ld(Reax, Mebp, inf_FRM_I)
         movxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -2170,8 +2171,11 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_PT
 
-        subxx_ld(Reax, Mebp, inf_FRAME)
-        shlxx_ri(Reax, IB(L-1))
+        /* seeds start at span's column (FRM_J) for partial rows */
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
+        addxx_ld(Reax, Mebp, inf_FRM_J)
+        shlxx_ri(Reax, IB(L+1))
         shlxx_ld(Reax, Mebp, inf_FSAA)
         addxx_ld(Reax, Mebp, inf_PSEED)
         movxx_st(Reax, Mebp, inf_PRNGS)
@@ -2202,11 +2206,16 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         addxx_ri(Reax, IB(E))
         addxx_ld(Reax, Mebp, inf_TILES)
         movxx_st(Reax, Mebp, inf_TLS)
-        movxx_mi(Mebp, inf_TLS_X, IB(0))
+
+        movxx_ld(Reax, Mebp, inf_FRM_J)
+        prexx_xx()
+        divxx_xm(Mebp, inf_TILE_W)
+        movxx_st(Reax, Mebp, inf_TLS_X)
 
 #endif /* RT_FEAT_TILING */
 
-        movxx_mi(Mebp, inf_FRM_X, IB(0))
+        movxx_ld(Reax, Mebp, inf_FRM_J)
+        movxx_st(Reax, Mebp, inf_FRM_X)
 
     LBL(880676) /* XX_cyc */
 
@@ -2410,6 +2419,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movpx_st(Xmm2, Mecx, ctx_RAY_Y(0))      /* ray_y -> RAY_Y */
         movpx_st(Xmm3, Mecx, ctx_RAY_Z(0))      /* ray_z -> RAY_Z */
 
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_P, IB(1))        /* count primary packets */
+
+#endif /* RT_FEAT_STATS */
+
 /******************************************************************************/
 /********************************   OBJ LIST   ********************************/
 /******************************************************************************/
@@ -2438,6 +2453,32 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
         movxx_ld(Rebx, Mesi, elm_SIMD)
 
+#if RT_FEAT_TILING_DEPTH
+
+        /* only primary rays are checked
+         * against depth-sorted tile lists */
+        cmjxx_rm(Recx, Mebp, inf_CTX,
+                 NE_x, 990338f) /* OO_dpt */
+
+        /* leave the list if all rays have hits
+         * closer than the rest of the list */
+        movpx_ld(Xmm0, Mecx, ctx_T_BUF(0))      /* t_buf <- T_BUF */
+        cltps_ld(Xmm0, Mebx, srf_T_MIN)         /* t_buf <! T_MIN */
+        CHECK_MASK(990339f, FULL, Xmm0)         /* OO_dpx */
+
+        jmpxx_lb(990338f) /* OO_dpt */
+
+    LBL(990339) /* OO_dpx */
+
+        /* reset transform caching
+         * if left within trnode */
+        movxx_mi(Mecx, ctx_LOCAL(OBJ), IB(0))
+        jmpxx_lb(990923f) /* OO_out */
+
+    LBL(990338) /* OO_dpt */
+
+#endif /* RT_FEAT_TILING_DEPTH */
+
         /* use local (potentially adjusted)
          * hit point (from unused normal fields)
          * as local diff for secondary rays
@@ -2672,6 +2713,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #endif /* RT_FEAT_TRANSFORM_ARRAY */
 
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_Q, IB(1))        /* count packets' solves */
+
+#endif /* RT_FEAT_STATS */
+
         cmjwx_ri(Reax, IB(1),
                  EQ_x, 220231f) /* PL_ptr */
         cmjwx_ri(Reax, IB(2),
@@ -3239,6 +3286,22 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #endif /* RT_FEAT_CLIPPING_CUSTOM */
 
+#if RT_FEAT_STATS
+
+        /* count packets' solves with all roots rejected
+         * (depth test, near plane or clipping), packets
+         * with roots left in some of the lanes not counted */
+        CHECK_MASK(660735f, NONE, Xmm7)         /* CC_rej */
+        jmpxx_lb(660736f) /* CC_acn */
+
+    LBL(660735) /* CC_rej */
+
+        addwx_mi(Mebp, inf_CNT_C, IB(1))
+
+    LBL(660736) /* CC_acn */
+
+#endif /* RT_FEAT_STATS */
+
         movwx_ld(Reax, Mecx, ctx_LOCAL(PTR))
 
         cmjwx_ri(Reax, IB(0),
@@ -3415,6 +3478,77 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
         PAINT_SIMD(MT_rtx) /* destroys Reax, Xmm0, Xmm2, Xmm7; reads Xmm1 */
 
+#if RT_FEAT_PT
+
+        /* store primary hits' surface colors
+         * as denoiser's guide (if requested) */
+        cmjxx_mz(Mebp, inf_ALB_R,
+                 EQ_x, 330339f) /* MT_gde */
+        cmjxx_rm(Recx, Mebp, inf_CTX,
+                 NE_x, 330339f) /* MT_gde */
+
+#if RT_FEAT_BUFFERS
+
+        stack_st(Rebx)
+        xorxx_rr(Redi, Redi)
+
+    LBL(330676) /* MT_gcy */
+
+        movxx_rr(Reax, Redi)
+        movyx_ld(Rebx, Iecx, ctx_TMASK(0))
+        cmjyx_rz(Rebx,
+                 EQ_x, 330337f) /* MT_gnx */
+
+        movss_ld(Xmm0, Iecx, ctx_TEX_R)
+        movss_ld(Xmm2, Iecx, ctx_TEX_G)
+        movss_ld(Xmm7, Iecx, ctx_TEX_B)
+
+        movyx_ld(Rebx, Iecx, ctx_INDEX(0))
+        movxx_rr(Reax, Rebx)
+        shlxx_ri(Reax, IB(L+1))
+
+        movxx_ld(Rebx, Mebp, inf_ALB_R)
+        movss_st(Xmm0, Iebx, DP(0))
+        movxx_ld(Rebx, Mebp, inf_ALB_G)
+        movss_st(Xmm2, Iebx, DP(0))
+        movxx_ld(Rebx, Mebp, inf_ALB_B)
+        movss_st(Xmm7, Iebx, DP(0))
+
+    LBL(330337) /* MT_gnx */
+
+        addxx_ri(Redi, IB(4*L))
+        cmjxx_ri(Redi, IM(RT_SIMD_QUADS*16),
+                 LT_x, 330676b) /* MT_gcy */
+
+        stack_ld(Rebx)
+
+#else /* RT_FEAT_BUFFERS */
+
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
+        addxx_ld(Reax, Mebp, inf_FRM_X)
+        shlxx_ri(Reax, IB(L+1))
+        shlxx_ld(Reax, Mebp, inf_FSAA)
+
+        movxx_ld(Redi, Mebp, inf_ALB_R)
+        movpx_ld(Xmm2, Mecx, ctx_TEX_R)
+        movpx_ld(Xmm0, Mecx, ctx_TMASK(0))
+        mmvpx_st(Xmm2, Iedi, DP(0))
+        movxx_ld(Redi, Mebp, inf_ALB_G)
+        movpx_ld(Xmm2, Mecx, ctx_TEX_G)
+        movpx_ld(Xmm0, Mecx, ctx_TMASK(0))
+        mmvpx_st(Xmm2, Iedi, DP(0))
+        movxx_ld(Redi, Mebp, inf_ALB_B)
+        movpx_ld(Xmm2, Mecx, ctx_TEX_B)
+        movpx_ld(Xmm0, Mecx, ctx_TMASK(0))
+        mmvpx_st(Xmm2, Iedi, DP(0))
+
+#endif /* RT_FEAT_BUFFERS */
+
+    LBL(330339) /* MT_gde */
+
+#endif /* RT_FEAT_PT */
+
 /******************************************************************************/
 /*********************************   LIGHTS   *********************************/
 /******************************************************************************/
@@ -3754,6 +3888,13 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(4))   /* mark PT_ret with tag 4 */
+
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_D, IB(1))        /* count path-tracer packets */
+
+#endif /* RT_FEAT_STATS */
+
         movpx_st(Xmm0, Mecx, ctx_WMASK)         /* tmask -> WMASK */
 
         movxx_ld(Redx, Mebp, inf_CAM)
@@ -4056,6 +4197,13 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movxx_st(Redi, Mecx, ctx_PARAM(LST))    /* save light/shadow list */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(1))   /* mark LT_ret with tag 1 */
+
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_S, IB(1))        /* count shadow packets */
+
+#endif /* RT_FEAT_STATS */
+
         movpx_st(Xmm0, Mecx, ctx_WMASK)         /* tmask -> WMASK */
 
         movpx_ld(Xmm0, Medx, lgt_T_MAX)         /* tmp_v <- T_MAX */
@@ -4827,6 +4975,13 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(3))   /* mark TR_ret with tag 3 */
+
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_T, IB(1))        /* count refraction packets */
+
+#endif /* RT_FEAT_STATS */
+
         movpx_st(Xmm0, Mecx, ctx_WMASK)         /* tmask -> WMASK */
 
         movxx_ld(Redx, Mebp, inf_CAM)
@@ -5242,6 +5397,13 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(2))   /* mark RF_ret with tag 2 */
+
+#if RT_FEAT_STATS
+
+        addwx_mi(Mebp, inf_CNT_F, IB(1))        /* count reflection packets */
+
+#endif /* RT_FEAT_STATS */
+
         movpx_st(Xmm0, Mecx, ctx_WMASK)         /* tmask -> WMASK */
 
         movxx_ld(Redx, Mebp, inf_CAM)
@@ -6954,6 +7116,26 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movxx_ld(Rebx, Mebp, inf_FSAA)
         movxx_ri(Resi, IM(RT_SIMD_QUADS*16))
 
+#if RT_FEAT_BUFFERS == 0
+
+        /* store primary hits' depth for filters */
+        cmjxx_mz(Mebp, inf_PTR_T,
+                 EQ_x, 440338f) /* FF_dpt */
+
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
+        addxx_ld(Reax, Mebp, inf_FRM_X)
+        shlxx_ri(Reax, IB(L+1))
+        shlxx_rr(Reax, Rebx)
+
+        movxx_ld(Redx, Mebp, inf_PTR_T)
+        movpx_ld(Xmm0, Mecx, ctx_T_BUF(0))
+        movpx_st(Xmm0, Iedx, DP(0))
+
+    LBL(440338) /* FF_dpt */
+
+#endif /* RT_FEAT_BUFFERS == 0 */
+
 #if RT_FEAT_PT
 
         cmjxx_mz(Mebp, inf_PT_ON,
@@ -7223,7 +7405,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNUM)
+        movxx_ld(Reax, Mebp, inf_FRM_U)
         addxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -7380,7 +7562,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNDX)
+        movxx_ld(Reax, Mebp, inf_FRM_I)
         movxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -7404,7 +7586,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         addxx_ld(Reax, Mebp, inf_FRAME)
         movxx_st(Reax, Mebp, inf_FRM)
 
-        movxx_mi(Mebp, inf_FRM_X, IB(0))
+        movxx_ld(Reax, Mebp, inf_FRM_J)
+        movxx_st(Reax, Mebp, inf_FRM_X)
 
     LBL(380676) /* TX_cyc */
 
@@ -7597,7 +7780,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNUM)
+        movxx_ld(Reax, Mebp, inf_FRM_U)
         addxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -7621,6 +7804,530 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 #endif /* RT_RENDER_CODE */
 }
 
+/******************************************************************************/
+/*********************************   FILTER   *********************************/
+/******************************************************************************/
+
+/*
+ * Extract color channel at bit-offset "ch" from packed pixels
+ * in register "XG" into the lower byte of each element.
+ */
+#define CHANNEL_0(XG) /* the lowest channel isn't shifted */                 \
+        andpx_ld(W(XG), Mesi, flt_C_MSK)
+
+#define CHANNEL_8(XG)                                                        \
+        shrpx_ri(W(XG), IB(8))                                              \
+        andpx_ld(W(XG), Mesi, flt_C_MSK)
+
+#define CHANNEL_16(XG)                                                       \
+        shrpx_ri(W(XG), IB(16))                                             \
+        andpx_ld(W(XG), Mesi, flt_C_MSK)
+
+/*
+ * Check color channel at bit-offset "ch" of history pixels (P_COL)
+ * against the range of staged traced neighbors extended by tolerance,
+ * accumulate rejection mask (P_MSK) and sums of differences between
+ * opposite neighbors per direction (P_DLR, P_DUD).
+ */
+#define CBRD_CHAN(ch) /* destroys Xmm0-Xmm6, Redx; reads Reax, Resi */      \
+        movpx_ld(Xmm0, Mesi, flt_P_COL)                                     \
+        CHANNEL_##ch(Xmm0)                                                  \
+        movxx_ld(Redx, Mesi, flt_ROW_U)                                     \
+        movpx_ld(Xmm1, Iedx, DP(0))                                         \
+        CHANNEL_##ch(Xmm1)                                                  \
+        movxx_ld(Redx, Mesi, flt_ROW_D)                                     \
+        movpx_ld(Xmm2, Iedx, DP(0))                                         \
+        CHANNEL_##ch(Xmm2)                                                  \
+        movxx_ld(Redx, Mesi, flt_ROW_L)                                     \
+        movpx_ld(Xmm3, Iedx, DP(0))                                         \
+        CHANNEL_##ch(Xmm3)                                                  \
+        movxx_ld(Redx, Mesi, flt_ROW_R)                                     \
+        movpx_ld(Xmm4, Iedx, DP(0))                                         \
+        CHANNEL_##ch(Xmm4)                                                  \
+        /* differences of opposite neighbors */                             \
+        movpx_rr(Xmm5, Xmm3)                                                \
+        maxpx_rr(Xmm5, Xmm4)                                                \
+        movpx_rr(Xmm6, Xmm3)                                                \
+        minpx_rr(Xmm6, Xmm4)                                                \
+        subpx_rr(Xmm5, Xmm6)                                                \
+        addpx_ld(Xmm5, Mesi, flt_P_DLR)                                     \
+        movpx_st(Xmm5, Mesi, flt_P_DLR)                                     \
+        movpx_rr(Xmm5, Xmm1)                                                \
+        maxpx_rr(Xmm5, Xmm2)                                                \
+        movpx_rr(Xmm6, Xmm1)                                                \
+        minpx_rr(Xmm6, Xmm2)                                                \
+        subpx_rr(Xmm5, Xmm6)                                                \
+        addpx_ld(Xmm5, Mesi, flt_P_DUD)                                     \
+        movpx_st(Xmm5, Mesi, flt_P_DUD)                                     \
+        /* range of neighbors */                                            \
+        movpx_rr(Xmm5, Xmm1)                                                \
+        minpx_rr(Xmm5, Xmm2)                                                \
+        minpx_rr(Xmm5, Xmm3)                                                \
+        minpx_rr(Xmm5, Xmm4)                                                \
+        maxpx_rr(Xmm1, Xmm2)                                                \
+        maxpx_rr(Xmm1, Xmm3)                                                \
+        maxpx_rr(Xmm1, Xmm4)                                                \
+        /* reject history out of range */                                   \
+        movpx_ld(Xmm6, Mesi, flt_C_TOL)                                     \
+        movpx_rr(Xmm2, Xmm0)                                                \
+        addpx_rr(Xmm2, Xmm6)                                                \
+        cgtpn_rr(Xmm5, Xmm2)                                                \
+        subpx_rr(Xmm0, Xmm6)                                                \
+        cgtpn_rr(Xmm0, Xmm1)                                                \
+        orrpx_rr(Xmm0, Xmm5)                                                \
+        orrpx_ld(Xmm0, Mesi, flt_P_MSK)                                     \
+        movpx_st(Xmm0, Mesi, flt_P_MSK)
+
+/*
+ * Average packed pixels in registers "XG" and "XS" per color channel,
+ * result is placed in "XG" (also used in variable-rate upsampling).
+ */
+#define CBRD_AVRG(XG, XS) /* destroys Xmm7 */                               \
+        movpx_rr(Xmm7, W(XG))                                               \
+        xorpx_rr(Xmm7, W(XS))                                               \
+        andpx_ld(Xmm7, Mesi, flt_C_AVG)                                     \
+        shrpx_ri(Xmm7, IB(1))                                               \
+        andpx_rr(W(XG), W(XS))                                              \
+        addpx_rr(W(XG), Xmm7)
+
+/*
+ * Accumulate denoiser's tap from rows at "cp" (colors, then guide's colors
+ * with channels' stride "st") with weights of tap's row "hr" and column "hc"
+ * masked by "cm", edge-stopping functions fall off with squared differences
+ * of luminance and guide's colors from the center pixel's ones.
+ */
+#define DNSE_TAP(cp, st, hr, hc, cm) /* destroys Xmm0-Xmm7, Redx, Redi */   \
+        movxx_ld(Redx, Mesi, flt_##cp)                                      \
+        movxx_ld(Redi, Mesi, flt_##st)                                      \
+        movpx_ld(Xmm1, Iedx, DP(0))                                         \
+        addxx_rr(Redx, Redi)                                                \
+        movpx_ld(Xmm2, Iedx, DP(0))                                         \
+        addxx_rr(Redx, Redi)                                                \
+        movpx_ld(Xmm3, Iedx, DP(0))                                         \
+        /* difference of luminance */                                       \
+        movpx_ld(Xmm0, Mesi, flt_L_RED)                                     \
+        mulps_rr(Xmm0, Xmm1)                                                \
+        movpx_ld(Xmm4, Mesi, flt_L_GRN)                                     \
+        mulps_rr(Xmm4, Xmm2)                                                \
+        addps_rr(Xmm0, Xmm4)                                                \
+        movpx_ld(Xmm4, Mesi, flt_L_BLU)                                     \
+        mulps_rr(Xmm4, Xmm3)                                                \
+        addps_rr(Xmm0, Xmm4)                                                \
+        minps_ld(Xmm0, Mebp, inf_GPC01)                                     \
+        subps_ld(Xmm0, Mesi, flt_P_LUM)                                     \
+        mulps_rr(Xmm0, Xmm0)                                                \
+        mulps_ld(Xmm0, Mesi, flt_I_LUM)                                     \
+        /* difference of guide's colors */                                  \
+        addxx_rr(Redx, Redi)                                                \
+        movpx_ld(Xmm4, Iedx, DP(0))                                         \
+        subps_ld(Xmm4, Mesi, flt_P_GDR)                                     \
+        mulps_rr(Xmm4, Xmm4)                                                \
+        addxx_rr(Redx, Redi)                                                \
+        movpx_ld(Xmm5, Iedx, DP(0))                                         \
+        subps_ld(Xmm5, Mesi, flt_P_GDG)                                     \
+        mulps_rr(Xmm5, Xmm5)                                                \
+        addps_rr(Xmm4, Xmm5)                                                \
+        addxx_rr(Redx, Redi)                                                \
+        movpx_ld(Xmm5, Iedx, DP(0))                                         \
+        subps_ld(Xmm5, Mesi, flt_P_GDB)                                     \
+        mulps_rr(Xmm5, Xmm5)                                                \
+        addps_rr(Xmm4, Xmm5)                                                \
+        mulps_ld(Xmm4, Mesi, flt_I_GDE)                                     \
+        /* edge-stopping weight of the tap */                               \
+        movpx_ld(Xmm5, Mebp, inf_GPC01)                                     \
+        movpx_rr(Xmm6, Xmm5)                                                \
+        subps_rr(Xmm5, Xmm0)                                                \
+        subps_rr(Xmm6, Xmm4)                                                \
+        xorpx_rr(Xmm7, Xmm7)                                                \
+        maxps_rr(Xmm5, Xmm7)                                                \
+        maxps_rr(Xmm6, Xmm7)                                                \
+        mulps_rr(Xmm5, Xmm6)                                                \
+        mulps_ld(Xmm5, Mesi, flt_##hr)                                      \
+        mulps_ld(Xmm5, Mesi, flt_##hc)                                      \
+        andpx_ld(Xmm5, Mesi, flt_##cm)                                      \
+        /* accumulate weighted colors */                                    \
+        movpx_ld(Xmm7, Mesi, flt_P_SUM)                                     \
+        addps_rr(Xmm7, Xmm5)                                                \
+        movpx_st(Xmm7, Mesi, flt_P_SUM)                                     \
+        mulps_rr(Xmm1, Xmm5)                                                \
+        addps_ld(Xmm1, Mesi, flt_P_ACR)                                     \
+        movpx_st(Xmm1, Mesi, flt_P_ACR)                                     \
+        mulps_rr(Xmm2, Xmm5)                                                \
+        addps_ld(Xmm2, Mesi, flt_P_ACG)                                     \
+        movpx_st(Xmm2, Mesi, flt_P_ACG)                                     \
+        mulps_rr(Xmm3, Xmm5)                                                \
+        addps_ld(Xmm3, Mesi, flt_P_ACB)                                     \
+        movpx_st(Xmm3, Mesi, flt_P_ACB)
+
+/*
+ * Backend's global entry point (hence 0).
+ * Filter a row of pixels staged by the engine
+ * in the mode given in the filter's structure.
+ */
+rt_void filter0(rt_SIMD_INFOX *s_inf)
+{
+#ifdef RT_RENDER_CODE
+
+    ASM_ENTER(s_inf)
+
+        movxx_ld(Resi, Mebp, inf_FLT)
+
+        cmjxx_mi(Mesi, flt_MODE, IB(RT_FILT_DNSE),
+                 EQ_x, 620191f) /* DN_ini */
+
+        cmjxx_mi(Mesi, flt_MODE, IB(RT_FILT_VRUP),
+                 EQ_x, 630191f) /* VR_ini */
+
+        cmjxx_mz(Mesi, flt_MODE,
+                 NE_x, 420598f) /* FL_end */
+
+/******************************************************************************/
+/******************************   CHECKERBOARD   ******************************/
+/******************************************************************************/
+
+        /* untraced pixels of the row are reprojected
+         * by their neighbors' depth onto history's screen,
+         * lanes without hits are reprojected by rotation */
+        xorxx_rr(Reax, Reax)
+
+    LBL(610676) /* CB_cyc */
+
+        movxx_ld(Redx, Mesi, flt_ROW_T)
+        movpx_ld(Xmm0, Iedx, DP(0))             /* t_val <- ROW_T */
+        movpx_ld(Xmm6, Mesi, flt_T_MAX)
+        cgtps_rr(Xmm6, Xmm0)                    /* t_max >! t_val */
+        andpx_rr(Xmm0, Xmm6)
+        movpx_ld(Xmm7, Mebp, inf_GPC01)
+        andpx_rr(Xmm6, Xmm7)                    /* k_val <- 1 or 0 */
+        subps_rr(Xmm7, Xmm6)
+        addps_rr(Xmm0, Xmm7)                    /* t_val <- t or 1 */
+
+        movpx_ld(Xmm1, Mesi, flt_X_POS)         /* x_pos <- X_POS */
+
+        /* distance to history's screen */
+        movpx_ld(Xmm2, Mesi, flt_A_NRM)
+        mulps_rr(Xmm2, Xmm1)
+        addps_ld(Xmm2, Mesi, flt_O_NRM)
+        mulps_rr(Xmm2, Xmm0)
+        movpx_ld(Xmm3, Mesi, flt_D_NRM)
+        mulps_rr(Xmm3, Xmm6)
+        addps_rr(Xmm2, Xmm3)
+        movpx_ld(Xmm7, Mesi, flt_S_NRM)
+        divps_rr(Xmm7, Xmm2)                    /* s_val <- scale */
+        xorpx_rr(Xmm5, Xmm5)
+        cltps_rr(Xmm5, Xmm7)                    /* valid mask (front) */
+
+        /* history's horizontal index */
+        movpx_ld(Xmm2, Mesi, flt_A_HOR)
+        mulps_rr(Xmm2, Xmm1)
+        addps_ld(Xmm2, Mesi, flt_O_HOR)
+        mulps_rr(Xmm2, Xmm0)
+        movpx_ld(Xmm3, Mesi, flt_D_HOR)
+        mulps_rr(Xmm3, Xmm6)
+        addps_rr(Xmm2, Xmm3)
+        mulps_rr(Xmm2, Xmm7)
+        subps_ld(Xmm2, Mesi, flt_S_HOR)
+        mulps_ld(Xmm2, Mesi, flt_I_HOR)
+        xorpx_rr(Xmm3, Xmm3)
+        cleps_rr(Xmm3, Xmm2)
+        andpx_rr(Xmm5, Xmm3)
+        movpx_rr(Xmm3, Xmm2)
+        cltps_ld(Xmm3, Mesi, flt_X_RES)
+        andpx_rr(Xmm5, Xmm3)
+        cvmps_rr(Xmm4, Xmm2)                    /* h_idx ii h_pos */
+
+        /* history's vertical index */
+        movpx_ld(Xmm2, Mesi, flt_A_VER)
+        mulps_rr(Xmm2, Xmm1)
+        addps_ld(Xmm2, Mesi, flt_O_VER)
+        mulps_rr(Xmm2, Xmm0)
+        movpx_ld(Xmm3, Mesi, flt_D_VER)
+        mulps_rr(Xmm3, Xmm6)
+        addps_rr(Xmm2, Xmm3)
+        mulps_rr(Xmm2, Xmm7)
+        subps_ld(Xmm2, Mesi, flt_S_VER)
+        mulps_ld(Xmm2, Mesi, flt_I_VER)
+        xorpx_rr(Xmm3, Xmm3)
+        cleps_rr(Xmm3, Xmm2)
+        andpx_rr(Xmm5, Xmm3)
+        movpx_rr(Xmm3, Xmm2)
+        cltps_ld(Xmm3, Mesi, flt_Y_RES)
+        andpx_rr(Xmm5, Xmm3)
+        cvmps_rr(Xmm2, Xmm2)                    /* v_idx ii v_pos */
+
+        /* invalid lanes fetch the first pixel */
+        mulpx_ld(Xmm2, Mesi, flt_X_ROW)
+        addpx_rr(Xmm2, Xmm4)
+        andpx_rr(Xmm2, Xmm5)
+        movpx_st(Xmm2, Mesi, flt_P_IDX)
+
+        annpx_ld(Xmm5, Mebp, inf_GPC07)
+        movpx_st(Xmm5, Mesi, flt_P_MSK)         /* reject invalid lanes */
+
+        xorpx_rr(Xmm0, Xmm0)
+        movpx_st(Xmm0, Mesi, flt_P_DLR)
+        movpx_st(Xmm0, Mesi, flt_P_DUD)
+
+        /* fetch history's pixels */
+        movxx_st(Reax, Mesi, flt_R_OFF)
+        movxx_ri(Redi, IM(RT_SIMD_QUADS*16))
+        xorxx_rr(Reax, Reax)
+
+    LBL(610853) /* CB_hst */
+
+        movyx_ld(Redx, Iesi, flt_P_IDX)
+        shlxx_ri(Redx, IB(2))
+        addxx_ld(Redx, Mesi, flt_HST_P)
+        movwx_ld(Redx, Medx, DP(0))
+        movyx_st(Redx, Iesi, flt_P_COL)
+
+        subxx_ri(Redi, IB(4*L))
+        addxx_ri(Reax, IB(4*L))
+
+        cmjxx_rz(Redi,
+                 NE_x, 610853b) /* CB_hst */
+
+        movxx_ld(Reax, Mesi, flt_R_OFF)
+
+        /* check history against traced neighbors */
+        CBRD_CHAN(0)
+        CBRD_CHAN(8)
+        CBRD_CHAN(16)
+
+        /* interpolate along the direction of least change */
+        movxx_ld(Redx, Mesi, flt_ROW_L)
+        movpx_ld(Xmm1, Iedx, DP(0))
+        movxx_ld(Redx, Mesi, flt_ROW_R)
+        movpx_ld(Xmm2, Iedx, DP(0))
+        CBRD_AVRG(Xmm1, Xmm2)
+        movxx_ld(Redx, Mesi, flt_ROW_U)
+        movpx_ld(Xmm3, Iedx, DP(0))
+        movxx_ld(Redx, Mesi, flt_ROW_D)
+        movpx_ld(Xmm4, Iedx, DP(0))
+        CBRD_AVRG(Xmm3, Xmm4)
+
+        movpx_ld(Xmm0, Mesi, flt_P_DLR)
+        cgtpx_ld(Xmm0, Mesi, flt_P_DUD)
+        andpx_rr(Xmm3, Xmm0)
+        annpx_rr(Xmm0, Xmm1)
+        orrpx_rr(Xmm0, Xmm3)
+
+        /* keep history if not rejected */
+        movpx_ld(Xmm5, Mesi, flt_P_MSK)
+        andpx_rr(Xmm0, Xmm5)
+        annpx_ld(Xmm5, Mesi, flt_P_COL)
+        orrpx_rr(Xmm0, Xmm5)
+
+        movxx_ld(Redx, Mesi, flt_ROW_O)
+        movpx_st(Xmm0, Iedx, DP(0))
+
+        /* advance pixels horizontally */
+        movpx_ld(Xmm1, Mesi, flt_X_POS)         /* x_pos <- X_POS */
+        addps_ld(Xmm1, Mesi, flt_X_STP)         /* x_pos += X_STP */
+        movpx_st(Xmm1, Mesi, flt_X_POS)         /* x_pos -> X_POS */
+
+        addxx_ri(Reax, IM(RT_SIMD_QUADS*16))
+
+        cmjxx_rm(Reax, Mesi, flt_ROW_N,
+                 LT_x, 610676b) /* CB_cyc */
+
+        jmpxx_lb(420598f) /* FL_end */
+
+/******************************************************************************/
+/********************************   DENOISER   ********************************/
+/******************************************************************************/
+
+    LBL(620191) /* DN_ini */
+
+        /* a-trous wavelet's pass takes 3x3 taps
+         * at the step's distance from the pixel,
+         * normalizes by the sum of their weights */
+        movpx_ld(Xmm0, Mebp, inf_GPC07)
+        movpx_st(Xmm0, Mesi, flt_M_CTR)
+
+        xorxx_rr(Reax, Reax)
+
+    LBL(620676) /* DN_cyc */
+
+        /* center pixel's luminance and guide */
+        movxx_ld(Redx, Mesi, flt_TAP_C)
+        movxx_ld(Redi, Mesi, flt_P_STR)
+        movpx_ld(Xmm1, Iedx, DP(0))
+        mulps_ld(Xmm1, Mesi, flt_L_RED)
+        addxx_rr(Redx, Redi)
+        movpx_ld(Xmm2, Iedx, DP(0))
+        mulps_ld(Xmm2, Mesi, flt_L_GRN)
+        addps_rr(Xmm1, Xmm2)
+        addxx_rr(Redx, Redi)
+        movpx_ld(Xmm2, Iedx, DP(0))
+        mulps_ld(Xmm2, Mesi, flt_L_BLU)
+        addps_rr(Xmm1, Xmm2)
+        minps_ld(Xmm1, Mebp, inf_GPC01)
+        movpx_st(Xmm1, Mesi, flt_P_LUM)
+
+        addxx_rr(Redx, Redi)
+        movpx_ld(Xmm1, Iedx, DP(0))
+        movpx_st(Xmm1, Mesi, flt_P_GDR)
+        addxx_rr(Redx, Redi)
+        movpx_ld(Xmm1, Iedx, DP(0))
+        movpx_st(Xmm1, Mesi, flt_P_GDG)
+        addxx_rr(Redx, Redi)
+        movpx_ld(Xmm1, Iedx, DP(0))
+        movpx_st(Xmm1, Mesi, flt_P_GDB)
+
+        /* side taps outside of the frame are masked */
+        movpx_ld(Xmm1, Mesi, flt_X_POS)         /* x_pos <- X_POS */
+        movpx_rr(Xmm2, Xmm1)
+        subps_ld(Xmm2, Mesi, flt_S_STP)
+        xorpx_rr(Xmm3, Xmm3)
+        cleps_rr(Xmm3, Xmm2)
+        movpx_st(Xmm3, Mesi, flt_M_LFT)
+        addps_ld(Xmm1, Mesi, flt_S_STP)
+        cltps_ld(Xmm1, Mesi, flt_X_RES)
+        movpx_st(Xmm1, Mesi, flt_M_RGT)
+
+        xorpx_rr(Xmm0, Xmm0)
+        movpx_st(Xmm0, Mesi, flt_P_SUM)
+        movpx_st(Xmm0, Mesi, flt_P_ACR)
+        movpx_st(Xmm0, Mesi, flt_P_ACG)
+        movpx_st(Xmm0, Mesi, flt_P_ACB)
+
+        DNSE_TAP(TAP_U, P_STR, H_RWU, H_CTR, M_CTR)
+        DNSE_TAP(LFT_U, S_STR, H_RWU, H_SID, M_LFT)
+        DNSE_TAP(RGT_U, S_STR, H_RWU, H_SID, M_RGT)
+        DNSE_TAP(TAP_C, P_STR, H_RWC, H_CTR, M_CTR)
+        DNSE_TAP(LFT_C, S_STR, H_RWC, H_SID, M_LFT)
+        DNSE_TAP(RGT_C, S_STR, H_RWC, H_SID, M_RGT)
+        DNSE_TAP(TAP_D, P_STR, H_RWD, H_CTR, M_CTR)
+        DNSE_TAP(LFT_D, S_STR, H_RWD, H_SID, M_LFT)
+        DNSE_TAP(RGT_D, S_STR, H_RWD, H_SID, M_RGT)
+
+        /* the center tap always has non-zero weight */
+        movpx_ld(Xmm0, Mesi, flt_P_SUM)
+        movpx_ld(Xmm1, Mesi, flt_P_ACR)
+        divps_rr(Xmm1, Xmm0)
+        movpx_ld(Xmm2, Mesi, flt_P_ACG)
+        divps_rr(Xmm2, Xmm0)
+        movpx_ld(Xmm3, Mesi, flt_P_ACB)
+        divps_rr(Xmm3, Xmm0)
+
+        movxx_ld(Redx, Mesi, flt_OUT_C)
+        movxx_ld(Redi, Mesi, flt_P_STR)
+        movpx_st(Xmm1, Iedx, DP(0))
+        addxx_rr(Redx, Redi)
+        movpx_st(Xmm2, Iedx, DP(0))
+        addxx_rr(Redx, Redi)
+        movpx_st(Xmm3, Iedx, DP(0))
+
+        /* the last pass converts colors
+         * to pixels (to 1.0 limit) */
+        cmjxx_mz(Mesi, flt_OUT_F,
+                 EQ_x, 620693f) /* DN_nxt */
+
+        movpx_ld(Xmm4, Mebp, inf_GPC01)
+        minps_rr(Xmm1, Xmm4)
+        minps_rr(Xmm2, Xmm4)
+        minps_rr(Xmm3, Xmm4)
+
+        cmjxx_mz(Mesi, flt_G_SQR,
+                 EQ_x, 620318f) /* DN_gam */
+
+        sqrps_rr(Xmm1, Xmm1)
+        sqrps_rr(Xmm2, Xmm2)
+        sqrps_rr(Xmm3, Xmm3)
+
+    LBL(620318) /* DN_gam */
+
+        movpx_ld(Xmm4, Mesi, flt_C_CLP)
+        mulps_rr(Xmm1, Xmm4)
+        cvnps_rr(Xmm1, Xmm1)
+        shlpx_ri(Xmm1, IB(16))
+        mulps_rr(Xmm2, Xmm4)
+        cvnps_rr(Xmm2, Xmm2)
+        shlpx_ri(Xmm2, IB(8))
+        mulps_rr(Xmm3, Xmm4)
+        cvnps_rr(Xmm3, Xmm3)
+        orrpx_rr(Xmm1, Xmm2)
+        orrpx_rr(Xmm1, Xmm3)
+
+        movxx_ld(Redx, Mesi, flt_OUT_F)
+        movpx_st(Xmm1, Iedx, DP(0))
+
+    LBL(620693) /* DN_nxt */
+
+        /* advance pixels horizontally */
+        movpx_ld(Xmm1, Mesi, flt_X_POS)         /* x_pos <- X_POS */
+        addps_ld(Xmm1, Mesi, flt_X_STP)         /* x_pos += X_STP */
+        movpx_st(Xmm1, Mesi, flt_X_POS)         /* x_pos -> X_POS */
+
+        addxx_ri(Reax, IM(RT_SIMD_QUADS*16))
+
+        cmjxx_rm(Reax, Mesi, flt_ROW_N,
+                 LT_x, 620676b) /* DN_cyc */
+
+        jmpxx_lb(420598f) /* FL_end */
+
+/******************************************************************************/
+/******************************   VARIABLE-RATE   *****************************/
+/******************************************************************************/
+
+    LBL(630191) /* VR_ini */
+
+        /* pixels of the first and the second rows
+         * are mixed per channel by quarters of the second:
+         * 0 - first, 1 - average of first and middle,
+         * 2 - middle (average), 3 - average of middle and second */
+        xorxx_rr(Reax, Reax)
+
+    LBL(630676) /* VR_cyc */
+
+        movxx_ld(Redx, Mesi, flt_ROW_U)
+        movpx_ld(Xmm0, Iedx, DP(0))             /* c_fst <- ROW_U */
+        movxx_ld(Redx, Mesi, flt_ROW_D)
+        movpx_ld(Xmm2, Iedx, DP(0))             /* c_snd <- ROW_D */
+        movpx_rr(Xmm1, Xmm0)
+        CBRD_AVRG(Xmm1, Xmm2)                   /* c_mid <- middle */
+
+        /* quarters' bits to masks */
+        movxx_ld(Redx, Mesi, flt_ROW_Q)
+        movpx_ld(Xmm3, Iedx, DP(0))
+        movpx_rr(Xmm4, Xmm3)
+        shlpx_ri(Xmm3, IB(RT_ELEMENT-2))
+        shrpn_ri(Xmm3, IB(RT_ELEMENT-1))        /* m_hlf <- 2 or 3 */
+        shlpx_ri(Xmm4, IB(RT_ELEMENT-1))
+        shrpn_ri(Xmm4, IB(RT_ELEMENT-1))        /* m_qrt <- 1 or 3 */
+
+        /* odd quarters average middle with nearer row */
+        andpx_rr(Xmm2, Xmm3)
+        movpx_rr(Xmm5, Xmm3)
+        annpx_rr(Xmm5, Xmm0)
+        orrpx_rr(Xmm5, Xmm2)
+        CBRD_AVRG(Xmm5, Xmm1)
+
+        /* even quarters take first row or middle */
+        andpx_rr(Xmm1, Xmm3)
+        annpx_rr(Xmm3, Xmm0)
+        orrpx_rr(Xmm1, Xmm3)
+
+        andpx_rr(Xmm5, Xmm4)
+        annpx_rr(Xmm4, Xmm1)
+        orrpx_rr(Xmm5, Xmm4)
+
+        movxx_ld(Redx, Mesi, flt_ROW_O)
+        movpx_st(Xmm5, Iedx, DP(0))
+
+        addxx_ri(Reax, IM(RT_SIMD_QUADS*16))
+
+        cmjxx_rm(Reax, Mesi, flt_ROW_N,
+                 LT_x, 630676b) /* VR_cyc */
+
+    LBL(420598) /* FL_end */
+
+    ASM_LEAVE(s_inf)
+
+#endif /* RT_RENDER_CODE */
+}
+
 /*
  * Fresnel code was inspired by 2006--degreve--reflection_refraction.pdf paper.
  * Almost identical code is used for calculations in render0 routine above.
@@ -8825,6 +9532,235 @@ rt_void rt_Platform::render0(rt_SIMD_INFOX *s_inf)
     }
 }
 
+/******************************************************************************/
+/*********************************   FILTER   *********************************/
+/******************************************************************************/
+
+namespace rt_simd_128v1
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_128v2
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_128v4
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_128v8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_256v4_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_256v1
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_256v2
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_256v4
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_256v8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v1_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v2_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v1
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v2
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v4
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_512v8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_1K4v1
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_1K4v2
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_1K4v4
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_2K8v1_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_2K8v2_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+namespace rt_simd_2K8v4_r8
+{
+rt_void filter0(rt_SIMD_INFOX *s_inf);
+}
+
+/*
+ * Backend's global entry point (hence 0).
+ * Filter a row of pixels staged by the engine
+ * in the mode given in the filter's structure.
+ */
+rt_void rt_Platform::filter0(rt_SIMD_INFOX *s_inf)
+{
+    switch (s_mode)
+    {
+#if (RT_2K8_R8 & 4)
+        case 0x40000000:
+        rt_simd_2K8v4_r8::filter0(s_inf);
+        break;
+#endif /* RT_2K8_R8 & 4 */
+#if (RT_2K8_R8 & 2)
+        case 0x20000000:
+        rt_simd_2K8v2_r8::filter0(s_inf);
+        break;
+#endif /* RT_2K8_R8 & 2 */
+#if (RT_2K8_R8 & 1)
+        case 0x10000000:
+        rt_simd_2K8v1_r8::filter0(s_inf);
+        break;
+#endif /* RT_2K8_R8 & 1 */
+#if (RT_1K4 & 4)
+        case 0x04000000:
+        rt_simd_1K4v4::filter0(s_inf);
+        break;
+#endif /* RT_1K4 & 4 */
+#if (RT_1K4 & 2)
+        case 0x02000000:
+        rt_simd_1K4v2::filter0(s_inf);
+        break;
+#endif /* RT_1K4 & 2 */
+#if (RT_1K4 & 1)
+        case 0x01000000:
+        rt_simd_1K4v1::filter0(s_inf);
+        break;
+#endif /* RT_1K4 & 1 */
+#if (RT_512 & 8)
+        case 0x00080000:
+        rt_simd_512v8::filter0(s_inf);
+        break;
+#endif /* RT_512 & 8 */
+#if (RT_512 & 4)
+        case 0x00040000:
+        rt_simd_512v4::filter0(s_inf);
+        break;
+#endif /* RT_512 & 4 */
+#if (RT_512 & 2)
+        case 0x00020000:
+        rt_simd_512v2::filter0(s_inf);
+        break;
+#endif /* RT_512 & 2 */
+#if (RT_512 & 1)
+        case 0x00010000:
+        rt_simd_512v1::filter0(s_inf);
+        break;
+#endif /* RT_512 & 1 */
+#if (RT_512_R8 & 2)
+        case 0x00002000:
+        rt_simd_512v2_r8::filter0(s_inf);
+        break;
+#endif /* RT_512_R8 & 2 */
+#if (RT_512_R8 & 1)
+        case 0x00001000:
+        rt_simd_512v1_r8::filter0(s_inf);
+        break;
+#endif /* RT_512_R8 & 1 */
+#if (RT_256 & 8)
+        case 0x00000800:
+        rt_simd_256v8::filter0(s_inf);
+        break;
+#endif /* RT_256 & 8 */
+#if (RT_256 & 4)
+        case 0x00000400:
+        rt_simd_256v4::filter0(s_inf);
+        break;
+#endif /* RT_256 & 4 */
+#if (RT_256 & 2)
+        case 0x00000200:
+        rt_simd_256v2::filter0(s_inf);
+        break;
+#endif /* RT_256 & 2 */
+#if (RT_256 & 1)
+        case 0x00000100:
+        rt_simd_256v1::filter0(s_inf);
+        break;
+#endif /* RT_256 & 1 */
+#if (RT_256_R8 & 4)
+        case 0x00000040:
+        rt_simd_256v4_r8::filter0(s_inf);
+        break;
+#endif /* RT_256_R8 & 4 */
+#if (RT_128 & 8)
+        case 0x00000008:
+        rt_simd_128v8::filter0(s_inf);
+        break;
+#endif /* RT_128 & 8 */
+#if (RT_128 & 4)
+        case 0x00000004:
+        rt_simd_128v4::filter0(s_inf);
+        break;
+#endif /* RT_128 & 4 */
+#if (RT_128 & 2)
+        case 0x00000002:
+        rt_simd_128v2::filter0(s_inf);
+        break;
+#endif /* RT_128 & 2 */
+#if (RT_128 & 1)
+        case 0x00000001:
+        rt_simd_128v1::filter0(s_inf);
+        break;
+#endif /* RT_128 & 1 */
+
+        default:
+        break;
+    }
+}
+
 #endif /* RT_SIMD_CODE */
 
 /******************************************************************************/
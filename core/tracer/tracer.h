@@ -50,6 +50,10 @@
 
 #define RT_STACK_DEPTH          10 /* context stack depth for secondary rays */
 
+#ifndef RT_FEAT_STATS
+#define RT_FEAT_STATS           0  /* count rays and solves per frame if 1 */
+#endif /* RT_FEAT_STATS */
+
 #define LCG16                   16
 #define LCG24                   24
 #define LCG32                   32 /* applicable to 64-bit SIMD elements only */
@@ -102,6 +106,7 @@ struct rt_SIMD_INFOX;
 
 struct rt_SIMD_CONTEXT;
 struct rt_SIMD_CAMERA;
+struct rt_SIMD_FILTER;
 struct rt_SIMD_LIGHT;
 struct rt_SIMD_SURFACE;
 
@@ -112,7 +117,7 @@ struct rt_SIMD_MATERIAL;
 /******************************************************************************/
 
 /*
- * Backend's global entry points (switch0, update0, render0)
+ * Backend's global entry points (switch0, update0, render0, filter0)
  * are now defined within rt_Platform class in engine.h file.
  */
 
@@ -246,8 +251,60 @@ struct rt_SIMD_INFOX : public rt_SIMD_INFO
     rt_word srf_s;
 #define inf_SRF_S           DP(Q*0x100+0x06C*P+E)
 
-    rt_word pad11[36];
-#define inf_PAD11           DP(Q*0x100+0x070*P+E)
+    /* external parameters (rows) */
+
+    rt_word frm_i;
+#define inf_FRM_I           DP(Q*0x100+0x070*P+E)
+
+    rt_word frm_u;
+#define inf_FRM_U           DP(Q*0x100+0x074*P+E)
+
+    rt_word frm_j;
+#define inf_FRM_J           DP(Q*0x100+0x078*P+E)
+
+    /* ray packet counters, +1 per SIMD packet
+     * regardless of active lanes (RT_FEAT_STATS) */
+
+    rt_word cnt_p;
+#define inf_CNT_P           DP(Q*0x100+0x07C*P+E)
+
+    rt_word cnt_s;
+#define inf_CNT_S           DP(Q*0x100+0x080*P+E)
+
+    rt_word cnt_f;
+#define inf_CNT_F           DP(Q*0x100+0x084*P+E)
+
+    rt_word cnt_t;
+#define inf_CNT_T           DP(Q*0x100+0x088*P+E)
+
+    rt_word cnt_d;
+#define inf_CNT_D           DP(Q*0x100+0x08C*P+E)
+
+    rt_word cnt_q;
+#define inf_CNT_Q           DP(Q*0x100+0x090*P+E)
+
+    rt_word cnt_c;
+#define inf_CNT_C           DP(Q*0x100+0x094*P+E)
+
+    /* external parameters (filters) */
+
+    rt_pntr ptr_t;
+#define inf_PTR_T           DP(Q*0x100+0x098*P+E)
+
+    rt_pntr flt;
+#define inf_FLT             DP(Q*0x100+0x09C*P+E)
+
+    rt_pntr alb_r;
+#define inf_ALB_R           DP(Q*0x100+0x0A0*P+E)
+
+    rt_pntr alb_g;
+#define inf_ALB_G           DP(Q*0x100+0x0A4*P+E)
+
+    rt_pntr alb_b;
+#define inf_ALB_B           DP(Q*0x100+0x0A8*P+E)
+
+    rt_word pad11[21];
+#define inf_PAD11           DP(Q*0x100+0x0AC*P+E)
 
     rt_uelm prngf[S];
 #define inf_PRNGF           DP(Q*0x100+0x100*P)
@@ -957,6 +1014,296 @@ struct rt_SIMD_CAMERA
 
 };
 
+/******************************************************************************/
+/*********************************   FILTER   *********************************/
+/******************************************************************************/
+
+/*
+ * Filter modes.
+ */
+#define RT_FILT_CBRD        0   /* checkerboard's reconstruction */
+#define RT_FILT_DNSE        1   /* denoiser's wavelet pass */
+#define RT_FILT_VRUP        2   /* variable-rate upsampling */
+
+/*
+ * SIMD filter structure with parameters for image-space passes
+ * over rows of pixels staged by the engine (one row per call),
+ * contains filter's internal variables.
+ * Structure is read-write in backend.
+ */
+struct rt_SIMD_FILTER
+{
+    /* staged rows of traced neighbors
+     * (up, down, left, right) */
+
+    rt_pntr row_u[R/P];
+#define flt_ROW_U           DP(Q*0x000+E)
+
+    rt_pntr row_d[R/P];
+#define flt_ROW_D           DP(Q*0x010+E)
+
+    rt_pntr row_l[R/P];
+#define flt_ROW_L           DP(Q*0x020+E)
+
+    rt_pntr row_r[R/P];
+#define flt_ROW_R           DP(Q*0x030+E)
+
+    /* staged row of depths, output row */
+
+    rt_pntr row_t[R/P];
+#define flt_ROW_T           DP(Q*0x040+E)
+
+    rt_pntr row_o[R/P];
+#define flt_ROW_O           DP(Q*0x050+E)
+
+    /* history frame, row's length (in bytes), mode */
+
+    rt_pntr hst_p[R/P];
+#define flt_HST_P           DP(Q*0x060+E)
+
+    rt_word row_n[R/P];
+#define flt_ROW_N           DP(Q*0x070+E)
+
+    rt_word mode[R/P];
+#define flt_MODE            DP(Q*0x080+E)
+
+    /* pixels' horizontal coords and update */
+
+    rt_real x_pos[S];
+#define flt_X_POS           DP(Q*0x090)
+
+    rt_real x_stp[S];
+#define flt_X_STP           DP(Q*0x0A0)
+
+    /* depth max value */
+
+    rt_real t_max[S];
+#define flt_T_MAX           DP(Q*0x0B0)
+
+    /* reprojected vector's products with history's screen
+     * (normal, horizontal, vertical): row's origin, addend
+     * per pixel, camera's offset, history's own products */
+
+    rt_real o_nrm[S];
+#define flt_O_NRM           DP(Q*0x0C0)
+
+    rt_real a_nrm[S];
+#define flt_A_NRM           DP(Q*0x0D0)
+
+    rt_real d_nrm[S];
+#define flt_D_NRM           DP(Q*0x0E0)
+
+    rt_real s_nrm[S];
+#define flt_S_NRM           DP(Q*0x0F0)
+
+    rt_real o_hor[S];
+#define flt_O_HOR           DP(Q*0x100)
+
+    rt_real a_hor[S];
+#define flt_A_HOR           DP(Q*0x110)
+
+    rt_real d_hor[S];
+#define flt_D_HOR           DP(Q*0x120)
+
+    rt_real s_hor[S];
+#define flt_S_HOR           DP(Q*0x130)
+
+    rt_real o_ver[S];
+#define flt_O_VER           DP(Q*0x140)
+
+    rt_real a_ver[S];
+#define flt_A_VER           DP(Q*0x150)
+
+    rt_real d_ver[S];
+#define flt_D_VER           DP(Q*0x160)
+
+    rt_real s_ver[S];
+#define flt_S_VER           DP(Q*0x170)
+
+    /* history's pixel scales, frame's dimensions */
+
+    rt_real i_hor[S];
+#define flt_I_HOR           DP(Q*0x180)
+
+    rt_real i_ver[S];
+#define flt_I_VER           DP(Q*0x190)
+
+    rt_real x_res[S];
+#define flt_X_RES           DP(Q*0x1A0)
+
+    rt_real y_res[S];
+#define flt_Y_RES           DP(Q*0x1B0)
+
+    rt_elem x_row[S];
+#define flt_X_ROW           DP(Q*0x1C0)
+
+    /* color tolerance and masks */
+
+    rt_elem c_tol[S];
+#define flt_C_TOL           DP(Q*0x1D0)
+
+    rt_elem c_msk[S];
+#define flt_C_MSK           DP(Q*0x1E0)
+
+    rt_elem c_avg[S];
+#define flt_C_AVG           DP(Q*0x1F0)
+
+    /* internal variables */
+
+    rt_elem p_idx[S];
+#define flt_P_IDX           DP(Q*0x200)
+
+    rt_elem p_col[S];
+#define flt_P_COL           DP(Q*0x210)
+
+    rt_elem p_msk[S];
+#define flt_P_MSK           DP(Q*0x220)
+
+    rt_elem p_dlr[S];
+#define flt_P_DLR           DP(Q*0x230)
+
+    rt_elem p_dud[S];
+#define flt_P_DUD           DP(Q*0x240)
+
+    rt_word r_off[R/P];
+#define flt_R_OFF           DP(Q*0x250+E)
+
+    /* denoiser's rows of taps (up, center, down)
+     * in color-planes and staged shifted by step
+     * to the left and to the right */
+
+    rt_pntr tap_u[R/P];
+#define flt_TAP_U           DP(Q*0x260+E)
+
+    rt_pntr tap_c[R/P];
+#define flt_TAP_C           DP(Q*0x270+E)
+
+    rt_pntr tap_d[R/P];
+#define flt_TAP_D           DP(Q*0x280+E)
+
+    rt_pntr lft_u[R/P];
+#define flt_LFT_U           DP(Q*0x290+E)
+
+    rt_pntr lft_c[R/P];
+#define flt_LFT_C           DP(Q*0x2A0+E)
+
+    rt_pntr lft_d[R/P];
+#define flt_LFT_D           DP(Q*0x2B0+E)
+
+    rt_pntr rgt_u[R/P];
+#define flt_RGT_U           DP(Q*0x2C0+E)
+
+    rt_pntr rgt_c[R/P];
+#define flt_RGT_C           DP(Q*0x2D0+E)
+
+    rt_pntr rgt_d[R/P];
+#define flt_RGT_D           DP(Q*0x2E0+E)
+
+    /* output rows of colors and pixels (if last pass),
+     * strides of channels in planes and staged rows,
+     * linear-to-gamma conversion of pixels */
+
+    rt_pntr out_c[R/P];
+#define flt_OUT_C           DP(Q*0x2F0+E)
+
+    rt_pntr out_f[R/P];
+#define flt_OUT_F           DP(Q*0x300+E)
+
+    rt_cell p_str[R/P];
+#define flt_P_STR           DP(Q*0x310+E)
+
+    rt_cell s_str[R/P];
+#define flt_S_STR           DP(Q*0x320+E)
+
+    rt_word g_sqr[R/P];
+#define flt_G_SQR           DP(Q*0x330+E)
+
+    /* step of taps, weights of taps' rows
+     * (zero outside of the frame) and columns */
+
+    rt_real s_stp[S];
+#define flt_S_STP           DP(Q*0x340)
+
+    rt_real h_rwu[S];
+#define flt_H_RWU           DP(Q*0x350)
+
+    rt_real h_rwc[S];
+#define flt_H_RWC           DP(Q*0x360)
+
+    rt_real h_rwd[S];
+#define flt_H_RWD           DP(Q*0x370)
+
+    rt_real h_sid[S];
+#define flt_H_SID           DP(Q*0x380)
+
+    rt_real h_ctr[S];
+#define flt_H_CTR           DP(Q*0x390)
+
+    /* edge-stopping inverse squared sigmas
+     * (luminance, guide), luminance weights,
+     * pixels' channel scale */
+
+    rt_real i_lum[S];
+#define flt_I_LUM           DP(Q*0x3A0)
+
+    rt_real i_gde[S];
+#define flt_I_GDE           DP(Q*0x3B0)
+
+    rt_real l_red[S];
+#define flt_L_RED           DP(Q*0x3C0)
+
+    rt_real l_grn[S];
+#define flt_L_GRN           DP(Q*0x3D0)
+
+    rt_real l_blu[S];
+#define flt_L_BLU           DP(Q*0x3E0)
+
+    rt_real c_clp[S];
+#define flt_C_CLP           DP(Q*0x3F0)
+
+    /* internal variables */
+
+    rt_elem m_lft[S];
+#define flt_M_LFT           DP(Q*0x400)
+
+    rt_elem m_ctr[S];
+#define flt_M_CTR           DP(Q*0x410)
+
+    rt_elem m_rgt[S];
+#define flt_M_RGT           DP(Q*0x420)
+
+    rt_real p_lum[S];
+#define flt_P_LUM           DP(Q*0x430)
+
+    rt_real p_gdr[S];
+#define flt_P_GDR           DP(Q*0x440)
+
+    rt_real p_gdg[S];
+#define flt_P_GDG           DP(Q*0x450)
+
+    rt_real p_gdb[S];
+#define flt_P_GDB           DP(Q*0x460)
+
+    rt_real p_sum[S];
+#define flt_P_SUM           DP(Q*0x470)
+
+    rt_real p_acr[S];
+#define flt_P_ACR           DP(Q*0x480)
+
+    rt_real p_acg[S];
+#define flt_P_ACG           DP(Q*0x490)
+
+    rt_real p_acb[S];
+#define flt_P_ACB           DP(Q*0x4A0)
+
+    /* variable-rate render's quarters per pixel
+     * of the second row (down) mixed into the first (up) */
+
+    rt_pntr row_q[R/P];
+#define flt_ROW_Q           DP(Q*0x4B0+E)
+
+};
+
 /******************************************************************************/
 /**********************************   LIGHT   *********************************/
 /******************************************************************************/
@@ -1166,19 +1513,24 @@ struct rt_SIMD_SURFACE
     rt_elem srf_i[S];
 #define srf_SRF_I           DP(Q*0x250)
 
+    /* nearest depth bound (primary rays) */
+
+    rt_real t_min[S];
+#define srf_T_MIN           DP(Q*0x260)
+
     /* misc tags/pointers */
 
     rt_si32 srf_t[4];
-#define srf_SRF_T(nx)       DP(Q*0x260 + nx)
+#define srf_SRF_T(nx)       DP(Q*0x270 + nx)
 
     rt_pntr msc_p[4];
-#define srf_MSC_P(nx)       DP(Q*0x260+0x010+0x000*P+E + (nx)*P)
+#define srf_MSC_P(nx)       DP(Q*0x270+0x010+0x000*P+E + (nx)*P)
 
     rt_pntr mat_p[4];
-#define srf_MAT_P(nx)       DP(Q*0x260+0x010+0x010*P+E + (nx)*P)
+#define srf_MAT_P(nx)       DP(Q*0x270+0x010+0x010*P+E + (nx)*P)
 
     rt_pntr lst_p[4];
-#define srf_LST_P(nx)       DP(Q*0x260+0x010+0x020*P+E + (nx)*P)
+#define srf_LST_P(nx)       DP(Q*0x270+0x010+0x020*P+E + (nx)*P)
 
 };
 
@@ -67,6 +67,7 @@ rt_time     b_time      = 0;        /* time-begins-(ms) (from command-line) */
 rt_time     e_time      =-1;        /* time-ending-(ms) (from command-line) */
 rt_si32     m_num       = 1;        /* frames-in-update (from command-line) */
 rt_si32     f_num       =-1;        /* number-of-frames (from command-line) */
+rt_si32     v_num       = 0;        /* PT-convergence-1/n (from command-line) */
 rt_time     f_time      =-1;        /* frame-delta-(ms) (from command-line) */
 rt_si32     n_simd      = 0;        /* SIMD native size (from command-line) */
 rt_si32     k_size      = 0;        /* SIMD size-factor (from command-line) */
@@ -93,6 +94,7 @@ rt_bool     q_mode      = RT_FALSE;       /* quake mode (from command-line) */
 rt_bool     q_test      = RT_FALSE;       /* quake mode (from actual scene) */
 rt_si32     u_mode      = 0; /* update/render threadoff (from command-line) */
 rt_bool     o_mode      = RT_FALSE;        /* offscreen (from command-line) */
+rt_bool     z_mode      = RT_FALSE;        /* timermode (from command-line) */
 rt_si32     a_mode      = RT_FSAA_NO;      /* FSAA mode (from command-line) */
 
 /******************************************************************************/
@@ -106,6 +108,11 @@ rt_si32     a_mode      = RT_FSAA_NO;      /* FSAA mode (from command-line) */
  */
 rt_time get_time();
 
+/*
+ * Get monotonic time in nanoseconds (for per-phase timers).
+ */
+rt_time get_tick();
+
 /*
  * Allocate memory from system heap.
  */
@@ -143,6 +150,24 @@ rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
  */
 rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row);
 
+/*
+ * Initialize platform-specific I/O thread, which writes frames
+ * captured to platform's ring of "num" frames to files.
+ */
+rt_pntr init_capture(rt_si32 num, rt_Platform *pfm);
+
+/*
+ * Terminate platform-specific I/O thread,
+ * block until all captured frames are written.
+ */
+rt_void term_capture(rt_pntr cdata);
+
+/*
+ * Capture scene's frame for platform-specific I/O thread,
+ * block only if all frames in the ring are yet to be written.
+ */
+rt_void capture_frame(rt_pntr cdata, rt_Scene *scn, rt_si32 index);
+
 /******************************************************************************/
 /*******************************   EVENT-LOOP   *******************************/
 /******************************************************************************/
@@ -207,6 +232,9 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row);
 rt_si32  eout = 0, emax = 0;
 rt_pstr *estr = RT_NULL;
 
+/* frame capture's I/O thread */
+rt_pntr  cdata = RT_NULL;
+
 /* state tracking variables */
 rt_si32 d_prev = -1;        /* prev demo-scene */
 rt_si32 c_prev = -1;        /* prev camera-idx */
@@ -265,6 +293,64 @@ rt_void print_avgfps()
     RT_LOGI("AVG   = %9.2f\n", avg);
 }
 
+/*
+ * Print per-phase timers of the last frame (in us): main thread's time,
+ * threads' average and maximum busy time, the longest barrier wait.
+ */
+rt_void print_timers()
+{
+    static rt_pstr name[RT_TMRS_NUM] =
+    {
+        "seq", "0.5", "1st", "2nd", "2.5", "3rd", "tls", "rnd"
+    };
+
+    rt_TMRS *tmr = sc[d]->get_tmrs(0);
+    rt_si32 i, k;
+
+    if (tmr == RT_NULL)
+    {
+        return;
+    }
+
+    for (k = 0; k < RT_TMRS_NUM; k++)
+    {
+        rt_time sum = 0, max = 0, min = tmr->wall[k];
+
+        for (i = 0; i < tmr->thnum; i++)
+        {
+            rt_time t = tmr->busy[i * RT_TMRS_NUM + k];
+
+            sum += t;
+            max = RT_MAX(max, t);
+            min = RT_MIN(min, t);
+        }
+
+        RT_LOGI("TMR %s = %7d us, busy avg %7d max %7d, wait max %7d\n",
+                name[k], (rt_si32)(tmr->wall[k] / 1000),
+                (rt_si32)(sum / tmr->thnum / 1000), (rt_si32)(max / 1000),
+                (rt_si32)((tmr->wall[k] - min) / 1000));
+    }
+}
+
+/*
+ * Print ray packet counters of the last frame (SIMD packets,
+ * not rays), if the backend is built with RT_FEAT_STATS.
+ */
+rt_void print_stats()
+{
+#if RT_FEAT_STATS
+    RT_LOGI("STS pkts = prm %9d, shd %9d, rfl %9d, rfr %9d, ptr %9d\n",
+            (rt_si32)sc[d]->get_stat(RT_STAT_PRM),
+            (rt_si32)sc[d]->get_stat(RT_STAT_SHD),
+            (rt_si32)sc[d]->get_stat(RT_STAT_RFL),
+            (rt_si32)sc[d]->get_stat(RT_STAT_RFR),
+            (rt_si32)sc[d]->get_stat(RT_STAT_PTR));
+    RT_LOGI("STS srfs = solves %9d, rejected %9d\n",
+            (rt_si32)sc[d]->get_stat(RT_STAT_SRF),
+            (rt_si32)sc[d]->get_stat(RT_STAT_CLP));
+#endif /* RT_FEAT_STATS */
+}
+
 /*
  * Print current target config.
  */
@@ -298,6 +384,27 @@ rt_void print_target()
 
 rt_pstr str = "--------------------------------------------------------";
 
+/*
+ * Save scene's frame to an image on platform's I/O thread,
+ * which is started along with its ring of frames on first use.
+ */
+rt_void frame_to_file(rt_Scene *scn, rt_si32 index)
+{
+    if (cdata == RT_NULL)
+    {
+        pfm->set_capt(RT_CAPT_NUM, x_res, y_res);
+        cdata = init_capture(RT_CAPT_NUM, pfm);
+    }
+
+    capture_frame(cdata, scn, index);
+
+    /* timer mode saves tiles' render cost too */
+    if (z_mode)
+    {
+        scn->save_heat(index);
+    }
+}
+
 /*
  * Event loop's main step.
  */
@@ -314,7 +421,7 @@ rt_si32 main_step()
     {
         if (T_KEYS(RK_F4) || T_KEYS(RK_4))
         {
-            sc[d]->save_frame(scr_id++);
+            frame_to_file(sc[d], scr_id++);
             switched = 1;
         }
         if (T_KEYS(RK_F5) || T_KEYS(RK_L))
@@ -520,6 +627,12 @@ rt_si32 main_step()
             if (!l_mode)
             {
                 RT_LOGI("FPS   = %9.2f\n", fps);
+
+                if (z_mode)
+                {
+                    print_timers();
+                    print_stats();
+                }
             }
         }
         if (e_time >= 0 && anim_time >= e_time)
@@ -530,6 +643,10 @@ rt_si32 main_step()
         {
             return 0;
         }
+        if (v_num > 0 && q_test && sc[d]->get_ptcv() == 0)
+        {
+            return 0;
+        }
 
 #if RT_OPTS_UPDATE_EXT0 != 0
         if (u_mode <= 4 && !p_mode)
@@ -681,7 +798,7 @@ rt_si32 main_step()
 
         if (switched && img_id >= 0 && img_id <= 999)
         {
-            sc[g]->save_frame(img_id++);
+            frame_to_file(sc[g], img_id++);
         }
 
         if (switched)
@@ -724,6 +841,9 @@ rt_si32 main_step()
         cnt++;
         ttl++;
 
+        /* follow platform's current render target, if rotated */
+        sc[d]->set_frame(frame);
+
         sc[d]->render(f_time >= 0 ? b_time + f_time * ttl : anim_time);
 
         if (!h_mode)
@@ -734,6 +854,20 @@ rt_si32 main_step()
             sc[d]->render_num(      30, 10, +1, 2, n_simd * 128);
             sc[d]->render_num(      10, 10, +1, 2, k_size);
             sc[d]->render_num(      10, 34, +1, 2, s_type);
+#if RT_FEAT_STATS
+            if (z_mode) /* ray packets traced in the frame (in thousands) */
+            {
+                rt_si32 i;
+                rt_word rays = 0;
+
+                for (i = RT_STAT_PRM; i <= RT_STAT_PTR; i++)
+                {
+                    rays += sc[d]->get_stat(i);
+                }
+
+                sc[d]->render_num(x_res-10, 58, -1, 2, (rt_ui32)(rays/1000));
+            }
+#endif /* RT_FEAT_STATS */
         }
     }
     catch (rt_Exception e)
@@ -782,6 +916,7 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -e n, specify time (ms) at which testing ends, n >= min\n");
         RT_LOGI(" -m n, specify # of path-tracer frames in update, n >= 1\n");
         RT_LOGI(" -f n, specify # of consecutive frames to render, n >= 0\n");
+        RT_LOGI(" -v n, stop when path-tracer's error is below 1/n, n>=1\n");
         RT_LOGI(" -g n, specify delta (ms) for consecutive frames, n >= 0\n");
         RT_LOGI(" -n n, override SIMD native size, where new simd is 1.16\n");
         RT_LOGI(" -k n, override SIMD size-factor, where new size is 1..4\n");
@@ -800,6 +935,8 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -t, trace mode, toggles path-tracing for quality lights\n");
         RT_LOGI(" -u n, 1-3/4 serial update/render, 5/6 update/render off\n");
         RT_LOGI(" -o, offscreen-frame mode, turns off window-rect updates\n");
+        RT_LOGI(" -z, timer mode, logs per-phase and per-thread times too\n");
+        RT_LOGI("     ray counters if built in, tiles' cost heatmap image\n");
         RT_LOGI(" -a, enable 4x antialiasing by default, 8x not supported\n");
         RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
         RT_LOGI("options -d n  ... ... ... ... ...  -a n can all be mixed\n");
@@ -910,6 +1047,23 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
                 return 0;
             }
         }
+        if (k < argc && strcmp(argv[k], "-v") == 0 && ++k < argc)
+        {
+            for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
+            {
+                t += (argv[k][l-1] - '0') * r;
+            }
+            if (t >= 1)
+            {
+                RT_LOGI("PT-convergence-1/n: %d\n", t);
+                v_num = t;
+            }
+            else
+            {
+                RT_LOGI("PT-convergence-1/n value out of range\n");
+                return 0;
+            }
+        }
         if (k < argc && strcmp(argv[k], "-g") == 0 && ++k < argc)
         {
             for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
@@ -1156,6 +1310,11 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
             o_mode = RT_TRUE;
             RT_LOGI("Offscreen-frame mode: %d\n", o_mode);
         }
+        if (k < argc && strcmp(argv[k], "-z") == 0 && !z_mode)
+        {
+            z_mode = RT_TRUE;
+            RT_LOGI("Timer mode: %d\n", z_mode);
+        }
         if (k < argc && strcmp(argv[k], "-a") == 0)
         {
             rt_si32 aa_map[10] =
@@ -1226,6 +1385,13 @@ rt_si32 main_init()
         {
             sc[i] = new(pfm) rt_Scene(sc_rt[i],
                                       x_res, y_res, x_row, frame, pfm);
+
+            /* path-tracer's adaptive sampling (if requested) */
+            sc[i]->set_ptcv(v_num > 0 ? 1.0f / (rt_real)v_num : 0.0f);
+
+            /* per-phase timers and tiles' cost (if requested) */
+            sc[i]->set_tmrs(z_mode ? 16 : 0, get_tick);
+            sc[i]->set_heat(z_mode, get_tick);
         }
 
         pfm->set_cur_scene(sc[d]);
@@ -1318,7 +1484,14 @@ rt_si32 main_term()
 {
     if (img_id >= 0 && img_id <= 999)
     {
-        sc[d]->save_frame(img_id++);
+        frame_to_file(sc[d], img_id++);
+    }
+
+    /* wait for captured frames to be written */
+    if (cdata != RT_NULL)
+    {
+        term_capture(cdata);
+        cdata = RT_NULL;
     }
 
     print_avgfps();
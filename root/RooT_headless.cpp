@@ -0,0 +1,767 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2026 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#include "RooT.h"
+
+/******************************************************************************/
+/**************************   PLATFORM - HEADLESS   ***************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <pthread.h>
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef __APPLE__
+
+#undef  RT_SETAFFINITY /* setting thread affinity is not present on macOS */
+#define RT_SETAFFINITY 0
+
+/*
+ * Custom implementation of pthread barriers for macOS found at:
+ * http://blog.albertarmea.com/post/47089939939/using-pthreadbarrier-on-mac-os-x
+ * copied as is with minor format adjustments.
+ */
+#include <errno.h>
+
+typedef int pthread_barrierattr_t;
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;
+    int tripCount;
+} pthread_barrier_t;
+
+int pthread_barrier_init(pthread_barrier_t *barrier,
+                         const pthread_barrierattr_t *attr, unsigned int count)
+{
+    if(count == 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if(pthread_mutex_init(&barrier->mutex, 0) < 0)
+    {
+        return -1;
+    }
+    if(pthread_cond_init(&barrier->cond, 0) < 0)
+    {
+        pthread_mutex_destroy(&barrier->mutex);
+        return -1;
+    }
+    barrier->tripCount = count;
+    barrier->count = 0;
+
+    return 0;
+}
+
+int pthread_barrier_destroy(pthread_barrier_t *barrier)
+{
+    pthread_cond_destroy(&barrier->cond);
+    pthread_mutex_destroy(&barrier->mutex);
+    return 0;
+}
+
+int pthread_barrier_wait(pthread_barrier_t *barrier)
+{
+    pthread_mutex_lock(&barrier->mutex);
+    ++(barrier->count);
+    if(barrier->count >= barrier->tripCount)
+    {
+        barrier->count = 0;
+        pthread_cond_broadcast(&barrier->cond);
+        pthread_mutex_unlock(&barrier->mutex);
+        return 1;
+    }
+    else
+    {
+        pthread_cond_wait(&barrier->cond, &(barrier->mutex));
+        pthread_mutex_unlock(&barrier->mutex);
+        return 0;
+    }
+}
+
+#endif /* __APPLE__ */
+
+/******************************************************************************/
+/**********************************   MAIN   **********************************/
+/******************************************************************************/
+
+rt_si32 main_init();
+rt_si32 main_loop();
+rt_si32 main_term();
+
+/* stream frames to stdout,
+ * logs then go to stderr */
+rt_bool     s_mode      = RT_FALSE;
+
+/*
+ * Print log into stderr and default log file.
+ */
+rt_void print_log_hdls(rt_pstr format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    va_start(args, format);
+    g_log_file.vprint(format, args);
+    va_end(args);
+}
+
+/*
+ * Print err into stderr and default err file.
+ */
+rt_void print_err_hdls(rt_pstr format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    va_start(args, format);
+    g_err_file.vprint(format, args);
+    va_end(args);
+}
+
+/*
+ * Terminate the event loop on signals as if Escape was pressed,
+ * so that frames captured with -i are written before exit.
+ */
+rt_void signal_hdls(rt_si32 sig)
+{
+    t_keys[r_to_p[RK_ESCAPE]] = 1;
+}
+
+/*
+ * Program's main entry point.
+ */
+rt_si32 main(rt_si32 argc, rt_char *argv[])
+{
+    /* workaround for out of memory on older Macs with SIMD buffers enabled */
+#ifdef __APPLE__
+    thnum               = RT_THREADS_NUM / 8; /* limit threads to fix allocs */
+#endif /* __APPLE__ */
+
+    /* fill in platform's keymap,
+     * only Escape is delivered (from signals),
+     * other keys map to (never set) zero index */
+    r_to_p[RK_ESCAPE]   = KEY_MASK & 0x1B;
+
+    /* frames are streamed to stdout if redirected,
+     * raw 32-bit pixels (bgr0) row by row for each frame */
+    if (isatty(STDOUT_FILENO) == 0)
+    {
+        s_mode = RT_TRUE;
+        f_print_log = print_log_hdls;
+        f_print_err = print_err_hdls;
+    }
+
+    /* init internal variables from command-line args */
+    rt_si32 ret;
+    ret = args_init(argc, argv);
+    if (ret == 0)
+    {
+        return 1;
+    }
+
+    /* inherit framebuffer's dimensions,
+     * no screen to fill in with -w 0 */
+    x_win = x_res;
+    y_win = y_res;
+
+    signal(SIGINT, signal_hdls);
+    signal(SIGTERM, signal_hdls);
+
+    /* init sys_alloc's mutex */
+    pthread_mutex_init(&mutex, NULL);
+
+    /* run main loop */
+    ret = main_init();
+    if (ret == 0)
+    {
+        return 1;
+    }
+    ret = main_loop();
+    ret = main_term();
+
+    /* destroy sys_alloc's mutex */
+    pthread_mutex_destroy(&mutex);
+
+    fflush(stdout);
+
+    return 0;
+}
+
+/*
+ * Get system time in milliseconds.
+ */
+rt_time get_time()
+{
+    timeval tm;
+    gettimeofday(&tm, NULL);
+    return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
+}
+
+/*
+ * Get monotonic time in nanoseconds.
+ */
+rt_time get_tick()
+{
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return (rt_time)tm.tv_sec * 1000000000 + (rt_time)tm.tv_nsec;
+}
+
+
+#if RT_POINTER == 64
+#if RT_ADDRESS == 32
+
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000040000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)0x0000000080000000)
+
+#else /* RT_ADDRESS == 64 */
+
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000140000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)0x0000080000000000)
+
+#endif /* RT_ADDRESS */
+
+static
+rt_byte *s_ptr = RT_ADDRESS_MIN;
+
+#endif /* RT_POINTER */
+
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+#include <sys/mman.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON  /* workaround for macOS compilation */
+#endif /* macOS still cannot allocate with mmap within 32-bit range */
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+/*
+ * Allocate memory from system heap.
+ */
+rt_pntr sys_alloc(rt_size size)
+{
+    pthread_mutex_lock(&mutex);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    /* loop around RT_ADDRESS_MAX boundary */
+    /* in 64/32-bit hybrid mode addresses can't have sign bit
+     * as MIPS64 sign-extends all 32-bit mem-loads by default */
+    if (s_ptr >= RT_ADDRESS_MAX - size)
+    {
+        s_ptr  = RT_ADDRESS_MIN;
+    }
+
+    rt_pntr ptr = mmap(s_ptr, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    /* advance with allocation granularity */
+    /* in case when page-size differs from default 4096 bytes
+     * mmap should round toward closest correct page boundary */
+    s_ptr = (rt_byte *)ptr + ((size + 4095) / 4096) * 4096;
+
+#else /* (RT_POINTER - RT_ADDRESS) */
+
+    rt_pntr ptr = malloc(size);
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+#if RT_DEBUG >= 2
+
+    RT_LOGI("ALLOC PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
+
+#endif /* RT_DEBUG */
+
+    pthread_mutex_unlock(&mutex);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
+    {
+        throw rt_Exception("address exceeded allowed range in sys_alloc");
+    }
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+    if (ptr == RT_NULL)
+    {
+        throw rt_Exception("alloc failed with NULL address in sys_alloc");
+    }
+
+    return ptr;
+}
+
+/*
+ * Free memory from system heap.
+ */
+rt_void sys_free(rt_pntr ptr, rt_size size)
+{
+    pthread_mutex_lock(&mutex);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    munmap(ptr, size);
+
+#else /* (RT_POINTER - RT_ADDRESS) */
+
+    free(ptr);
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+#if RT_DEBUG >= 2
+
+    RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
+
+#endif /* RT_DEBUG */
+
+    pthread_mutex_unlock(&mutex);
+}
+
+/******************************************************************************/
+/*****************************   MULTI-THREADING   ****************************/
+/******************************************************************************/
+
+struct rt_THREAD;
+
+/* platform-specific pool
+ * of "thnum" threads */
+struct rt_THREAD_POOL
+{
+    rt_Platform        *pfm;
+    rt_si32             cmd;
+    rt_si32             thnum;
+    rt_THREAD          *thread;
+    pthread_barrier_t   barr[2];
+};
+
+/* platform-specific thread */
+struct rt_THREAD
+{
+    rt_THREAD_POOL     *tpool;
+    rt_si32             index;
+    pthread_t           pthr;
+};
+
+/*
+ * Worker thread's entry point.
+ */
+rt_pntr worker_thread(rt_pntr p)
+{
+    rt_THREAD *thread = (rt_THREAD *)p;
+    rt_si32 ti = thread->index;
+
+    while (thread->tpool->cmd < 0) /* <- wait for barriers */
+    {
+        sched_yield();
+    }
+
+    while (1)
+    {
+        /* every worker-thread waits signal from main thread */
+        pthread_barrier_wait(&thread->tpool->barr[0]);
+
+        rt_Platform *pfm = thread->tpool->pfm;
+
+        if (pfm == RT_NULL)
+        {
+            break;
+        }
+
+        rt_si32 cmd = thread->tpool->cmd;
+
+        /* if one thread throws an exception,
+         * other threads are still allowed to proceed
+         * in the same run, but not in the next one */
+        if (eout == 0)
+        try
+        {
+            rt_Scene *scene = pfm->get_cur_scene();
+
+            switch (cmd & 0x3)
+            {
+                case 1:
+                scene->update_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                case 2:
+                scene->render_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                default:
+                break;
+            };
+        }
+        catch (rt_Exception e)
+        {
+            estr[ti] = e.err;
+            eout = 1;
+        }
+
+        /* every worker-thread signals to main thread when done */
+        pthread_barrier_wait(&thread->tpool->barr[1]);
+    }
+
+    /* every worker-thread signals to main thread when done */
+    pthread_barrier_wait(&thread->tpool->barr[1]);
+
+    return RT_NULL;
+}
+
+/*
+ * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ */
+rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
+{
+    rt_bool feedback = thnum < 0 ? RT_FALSE : RT_TRUE;
+    thnum = thnum < 0 ? -thnum : thnum;
+
+    eout = 0; emax = thnum;
+    estr = (rt_pstr *)malloc(sizeof(rt_pstr) * thnum);
+
+    if (estr == RT_NULL)
+    {
+        throw rt_Exception("out of memory for estr in init_threads");
+    }
+
+    memset(estr, 0, sizeof(rt_pstr) * thnum);
+
+#if RT_SETAFFINITY
+
+    cpu_set_t cpuset_pr, cpuset_th;
+    pthread_t pthr = pthread_self();
+    pthread_getaffinity_np(pthr, sizeof(cpu_set_t), &cpuset_pr);
+
+#endif /* RT_SETAFFINITY */
+
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)malloc(sizeof(rt_THREAD_POOL));
+
+    if (tpool == RT_NULL)
+    {
+        throw rt_Exception("out of memory for tpool in init_threads");
+    }
+
+    tpool->pfm = pfm;
+    tpool->cmd = -1;
+    tpool->thnum = thnum;
+    tpool->thread = (rt_THREAD *)malloc(sizeof(rt_THREAD) * thnum);
+
+    if (tpool->thread == RT_NULL)
+    {
+        throw rt_Exception("out of memory for thread data in init_threads");
+    }
+
+    rt_si32 i, a;
+
+    for (i = 0, a = 0; i < thnum; i++, a++)
+    {
+#if RT_SETAFFINITY
+
+        while (!CPU_ISSET(a, &cpuset_pr))
+        {
+            a++;
+            if (a == CPU_SETSIZE)
+            {
+                if (feedback)
+                {
+                    thnum = i;
+                    break;
+                }
+                else
+                {
+                    a = 0;
+                }
+            }
+        }
+        if (thnum == i)
+        {
+            break;
+        }
+
+#endif /* RT_SETAFFINITY */
+
+        rt_THREAD *thread = tpool->thread;
+
+        thread[i].tpool = tpool;
+        thread[i].index = i;
+        pthread_create(&thread[i].pthr, NULL, worker_thread, &thread[i]);
+
+#if RT_SETAFFINITY
+
+        CPU_ZERO(&cpuset_th);
+        CPU_SET(a, &cpuset_th);
+        pthread_setaffinity_np(thread[i].pthr, sizeof(cpu_set_t), &cpuset_th);
+
+#endif /* RT_SETAFFINITY */
+    }
+
+    pthread_barrier_init(&tpool->barr[0], NULL, thnum + 1);
+    pthread_barrier_init(&tpool->barr[1], NULL, thnum + 1);
+
+    if (feedback)
+    {
+        pfm->set_thnum(thnum);
+    }
+    tpool->thnum = thnum;
+    tpool->cmd = 0;
+
+    return tpool;
+}
+
+/*
+ * Terminate platform-specific pool of "thnum" threads.
+ */
+rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
+{
+    rt_si32 i;
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to terminate */
+    tpool->cmd = 0;
+    tpool->pfm = RT_NULL;
+    pthread_barrier_wait(&tpool->barr[0]);
+    /* wait for all worker-threads to finish */
+    pthread_barrier_wait(&tpool->barr[1]);
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        rt_THREAD *thread = tpool->thread;
+
+        pthread_join(thread[i].pthr, NULL);
+    }
+
+    pthread_barrier_destroy(&tpool->barr[0]);
+    pthread_barrier_destroy(&tpool->barr[1]);
+
+    free(tpool->thread);
+    free(tpool);
+
+    free(estr);
+    estr = RT_NULL;
+    eout = emax = 0;
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to update scene */
+    tpool->cmd = 1 | ((phase & 0xFF) << 2);
+    pthread_barrier_wait(&tpool->barr[0]);
+    /* wait for all worker-threads to finish */
+    pthread_barrier_wait(&tpool->barr[1]);
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to render scene */
+    tpool->cmd = 2 | ((phase & 0xFF) << 2);
+    pthread_barrier_wait(&tpool->barr[0]);
+    /* wait for all worker-threads to finish */
+    pthread_barrier_wait(&tpool->barr[1]);
+}
+
+/******************************************************************************/
+
+/* platform-specific I/O thread
+ * writing captured frames */
+struct rt_CAPTURE
+{
+    rt_Platform        *pfm;
+    rt_si32             num;
+    rt_bool             quit;
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond[2]; /* 0 - frame queued, 1 - frame written */
+    pthread_t           pthr;
+};
+
+/*
+ * I/O thread's entry point.
+ */
+rt_pntr capture_thread(rt_pntr p)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)p;
+
+    pthread_mutex_lock(&capt->mutex);
+
+    while (1)
+    {
+        if (capt->pfm->get_capt() == 0)
+        {
+            if (capt->quit)
+            {
+                break;
+            }
+
+            pthread_cond_wait(&capt->cond[0], &capt->mutex);
+            continue;
+        }
+
+        /* write outside of the lock,
+         * so that capture isn't blocked */
+        pthread_mutex_unlock(&capt->mutex);
+        capt->pfm->write_capt();
+        pthread_mutex_lock(&capt->mutex);
+
+        /* signal main thread if waiting for a free frame */
+        pthread_cond_signal(&capt->cond[1]);
+    }
+
+    pthread_mutex_unlock(&capt->mutex);
+
+    return RT_NULL;
+}
+
+/*
+ * Initialize platform-specific I/O thread, which writes frames
+ * captured to platform's ring of "num" frames to files.
+ */
+rt_pntr init_capture(rt_si32 num, rt_Platform *pfm)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)malloc(sizeof(rt_CAPTURE));
+
+    if (capt == RT_NULL)
+    {
+        throw rt_Exception("out of memory for capt in init_capture");
+    }
+
+    capt->pfm = pfm;
+    capt->num = num;
+    capt->quit = RT_FALSE;
+
+    pthread_mutex_init(&capt->mutex, NULL);
+    pthread_cond_init(&capt->cond[0], NULL);
+    pthread_cond_init(&capt->cond[1], NULL);
+
+    pthread_create(&capt->pthr, NULL, capture_thread, capt);
+
+    return capt;
+}
+
+/*
+ * Terminate platform-specific I/O thread,
+ * block until all captured frames are written.
+ */
+rt_void term_capture(rt_pntr cdata)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    /* signal I/O thread to terminate once the ring is empty */
+    pthread_mutex_lock(&capt->mutex);
+    capt->quit = RT_TRUE;
+    pthread_cond_signal(&capt->cond[0]);
+    pthread_mutex_unlock(&capt->mutex);
+
+    pthread_join(capt->pthr, NULL);
+
+    pthread_cond_destroy(&capt->cond[0]);
+    pthread_cond_destroy(&capt->cond[1]);
+    pthread_mutex_destroy(&capt->mutex);
+
+    free(capt);
+}
+
+/*
+ * Capture scene's frame for platform-specific I/O thread,
+ * block only if all frames in the ring are yet to be written.
+ */
+rt_void capture_frame(rt_pntr cdata, rt_Scene *scn, rt_si32 index)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    /* frame is copied outside of the lock */
+    while (scn->capt_frame(index) == 0)
+    {
+        pthread_mutex_lock(&capt->mutex);
+        while (capt->pfm->get_capt() >= capt->num)
+        {
+            pthread_cond_wait(&capt->cond[1], &capt->mutex);
+        }
+        pthread_mutex_unlock(&capt->mutex);
+    }
+
+    /* signal I/O thread */
+    pthread_mutex_lock(&capt->mutex);
+    pthread_cond_signal(&capt->cond[0]);
+    pthread_mutex_unlock(&capt->mutex);
+}
+
+/******************************************************************************/
+/*******************************   EVENT-LOOP   *******************************/
+/******************************************************************************/
+
+/*
+ * Set current frame to screen,
+ * stream it to stdout if redirected.
+ */
+rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+{
+    if (frame == RT_NULL || s_mode == RT_FALSE)
+    {
+        return;
+    }
+
+    rt_si32 i;
+
+    for (i = 0; i < y_res; i++)
+    {
+        if (fwrite(frame + i * x_row, sizeof(rt_ui32), x_res, stdout)
+                                                        != (rt_size)x_res)
+        {
+            RT_LOGE("Couldn't write frame to stdout, streaming stopped\n");
+            s_mode = RT_FALSE;
+            break;
+        }
+    }
+}
+
+/*
+ * Implementation of the event loop.
+ */
+rt_si32 main_loop()
+{
+    /* event loop */
+    while (1)
+    {
+        rt_si32 ret;
+
+        ret = main_step();
+
+        if (ret == 0)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
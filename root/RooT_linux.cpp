@@ -11,6 +11,7 @@
 /******************************************************************************/
 
 #include <sys/time.h>
+#include <time.h>
 
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
@@ -29,7 +30,17 @@ rt_si32     depth;
 #include <sys/shm.h>
 #include <X11/extensions/XShm.h>
 
-XShmSegmentInfo shminfo;
+#ifndef RT_XSHM_NUM
+#define RT_XSHM_NUM 3 /* number of XShm images rotated as render targets */
+#endif /* RT_XSHM_NUM */
+
+XShmSegmentInfo shminfo[RT_XSHM_NUM];
+XImage     *xshm_img[RT_XSHM_NUM];
+rt_si32     xshm_num    = 0;
+
+/* presentation thread's own
+ * connection to X server */
+Display    *pdisp       = NULL;
 #endif /* RT_XSHM */
 
 rt_bool     xshm        = RT_FALSE;
@@ -124,6 +135,9 @@ rt_si32 main_init();
 rt_si32 main_loop();
 rt_si32 main_term();
 
+rt_void init_present();
+rt_void term_present();
+
 /*
  * Program's main entry point.
  */
@@ -297,53 +311,73 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     XSync(disp, False);
 
 #if RT_XSHM
-    do
+    /* open separate connection for presentation thread,
+     * which waits for ShmCompletion events on rotated images,
+     * so that the event loop doesn't contend for main connection */
+    pdisp = RT_XSHM_NUM > 1 ? XOpenDisplay(NULL) : NULL;
+    Display *sdisp = pdisp != NULL ? pdisp : disp;
+
+    while (xshm_num < (pdisp != NULL ? RT_XSHM_NUM : 1))
     {
+        XShmSegmentInfo *sinfo = &shminfo[xshm_num];
+
         /* create image,
          * use preconfigured x_res, y_res for rendering,
          * window resizing in runtime is not supported for now */
-        ximage = XShmCreateImage(disp,
-                                 DefaultVisual(disp, scr_id),
+        ximage = XShmCreateImage(sdisp,
+                                 DefaultVisual(sdisp, scr_id),
                                  depth,
-                                 ZPixmap, NULL, &shminfo,
+                                 ZPixmap, NULL, sinfo,
                                  x_row, y_res);
         if (ximage == NULL)
         {
             RT_LOGE("Couldn't create XShm image\n");
-            RT_LOGE("defaulting to (slower) non-XShm fallback\n");
             break;
         }
 
         /* get shared memory */
-        shminfo.shmid = shmget(IPC_PRIVATE,
-                               ximage->bytes_per_line * ximage->height,
-                               IPC_CREAT|0777);
-        if (shminfo.shmid < 0)
+        sinfo->shmid = shmget(IPC_PRIVATE,
+                              ximage->bytes_per_line * ximage->height,
+                              IPC_CREAT|0777);
+        if (sinfo->shmid < 0)
         {
             RT_LOGE("shmget failed with size = %d bytes\n",
                                  ximage->bytes_per_line * ximage->height);
-            RT_LOGE("defaulting to (slower) non-XShm fallback\n");
             XDestroyImage(ximage);
             break;
         }
 
         /* attach shared memory */
-        shminfo.shmaddr = ximage->data = (rt_char *)shmat(shminfo.shmid, 0, 0);
-        if (shminfo.shmaddr == (rt_char *)-1)
+        sinfo->shmaddr = ximage->data = (rt_char *)shmat(sinfo->shmid, 0, 0);
+        if (sinfo->shmaddr == (rt_char *)-1)
         {
             RT_LOGE("shmat failed\n");
-            RT_LOGE("defaulting to (slower) non-XShm fallback\n");
             XDestroyImage(ximage);
             break;
         }
 
-        shminfo.readOnly = False;
-        XShmAttach(disp, &shminfo);
-        shmctl(shminfo.shmid, IPC_RMID, 0);
+        sinfo->readOnly = False;
+        XShmAttach(sdisp, sinfo);
+        shmctl(sinfo->shmid, IPC_RMID, 0);
+
+        xshm_img[xshm_num++] = ximage;
+    }
+
+    if (xshm_num == 0)
+    {
+        RT_LOGE("defaulting to (slower) non-XShm fallback\n");
 
+        if (pdisp != NULL)
+        {
+            XCloseDisplay(pdisp);
+            pdisp = NULL;
+        }
+    }
+    else
+    {
+        ximage = xshm_img[0];
         xshm = RT_TRUE;
     }
-    while (0);
 #endif /* RT_XSHM */
 
     if (xshm == RT_FALSE)
@@ -372,6 +406,14 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     gc = XCreateGC(disp, win, 0, &gc_values);
     XSync(disp, False);
 
+#if RT_XSHM
+    if (pdisp != NULL)
+    {
+        /* start presentation thread */
+        init_present();
+    }
+#endif /* RT_XSHM */
+
     /* use true-color target directly */
     if (depth > 16)
     {
@@ -401,13 +443,31 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     }
 
 #if RT_XSHM
+    if (pdisp != NULL)
+    {
+        /* stop presentation thread,
+         * once queued image is on the screen */
+        term_present();
+    }
+
     if (xshm == RT_TRUE)
     {
-        /* destroy image,
-         * detach shared memory */
-        XShmDetach(disp, &shminfo);
-        XDestroyImage(ximage);
-        shmdt(shminfo.shmaddr);
+        rt_si32 i;
+
+        for (i = 0; i < xshm_num; i++)
+        {
+            /* destroy image,
+             * detach shared memory */
+            XShmDetach(sdisp, &shminfo[i]);
+            XDestroyImage(xshm_img[i]);
+            shmdt(shminfo[i].shmaddr);
+        }
+    }
+
+    if (pdisp != NULL)
+    {
+        /* close presentation thread's connection */
+        XCloseDisplay(pdisp);
     }
 #endif /* RT_XSHM */
 
@@ -438,6 +498,16 @@ rt_time get_time()
     return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
 }
 
+/*
+ * Get monotonic time in nanoseconds.
+ */
+rt_time get_tick()
+{
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return (rt_time)tm.tv_sec * 1000000000 + (rt_time)tm.tv_nsec;
+}
+
 
 #if RT_POINTER == 64
 #if RT_ADDRESS == 32
@@ -804,27 +874,270 @@ rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 }
 
 /******************************************************************************/
-/*******************************   EVENT-LOOP   *******************************/
+
+/* platform-specific I/O thread
+ * writing captured frames */
+struct rt_CAPTURE
+{
+    rt_Platform        *pfm;
+    rt_si32             num;
+    rt_bool             quit;
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond[2]; /* 0 - frame queued, 1 - frame written */
+    pthread_t           pthr;
+};
+
+/*
+ * I/O thread's entry point.
+ */
+rt_pntr capture_thread(rt_pntr p)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)p;
+
+    pthread_mutex_lock(&capt->mutex);
+
+    while (1)
+    {
+        if (capt->pfm->get_capt() == 0)
+        {
+            if (capt->quit)
+            {
+                break;
+            }
+
+            pthread_cond_wait(&capt->cond[0], &capt->mutex);
+            continue;
+        }
+
+        /* write outside of the lock,
+         * so that capture isn't blocked */
+        pthread_mutex_unlock(&capt->mutex);
+        capt->pfm->write_capt();
+        pthread_mutex_lock(&capt->mutex);
+
+        /* signal main thread if waiting for a free frame */
+        pthread_cond_signal(&capt->cond[1]);
+    }
+
+    pthread_mutex_unlock(&capt->mutex);
+
+    return RT_NULL;
+}
+
+/*
+ * Initialize platform-specific I/O thread, which writes frames
+ * captured to platform's ring of "num" frames to files.
+ */
+rt_pntr init_capture(rt_si32 num, rt_Platform *pfm)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)malloc(sizeof(rt_CAPTURE));
+
+    if (capt == RT_NULL)
+    {
+        throw rt_Exception("out of memory for capt in init_capture");
+    }
+
+    capt->pfm = pfm;
+    capt->num = num;
+    capt->quit = RT_FALSE;
+
+    pthread_mutex_init(&capt->mutex, NULL);
+    pthread_cond_init(&capt->cond[0], NULL);
+    pthread_cond_init(&capt->cond[1], NULL);
+
+    pthread_create(&capt->pthr, NULL, capture_thread, capt);
+
+    return capt;
+}
+
+/*
+ * Terminate platform-specific I/O thread,
+ * block until all captured frames are written.
+ */
+rt_void term_capture(rt_pntr cdata)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    /* signal I/O thread to terminate once the ring is empty */
+    pthread_mutex_lock(&capt->mutex);
+    capt->quit = RT_TRUE;
+    pthread_cond_signal(&capt->cond[0]);
+    pthread_mutex_unlock(&capt->mutex);
+
+    pthread_join(capt->pthr, NULL);
+
+    pthread_cond_destroy(&capt->cond[0]);
+    pthread_cond_destroy(&capt->cond[1]);
+    pthread_mutex_destroy(&capt->mutex);
+
+    free(capt);
+}
+
+/*
+ * Capture scene's frame for platform-specific I/O thread,
+ * block only if all frames in the ring are yet to be written.
+ */
+rt_void capture_frame(rt_pntr cdata, rt_Scene *scn, rt_si32 index)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    /* frame is copied outside of the lock */
+    while (scn->capt_frame(index) == 0)
+    {
+        pthread_mutex_lock(&capt->mutex);
+        while (capt->pfm->get_capt() >= capt->num)
+        {
+            pthread_cond_wait(&capt->cond[1], &capt->mutex);
+        }
+        pthread_mutex_unlock(&capt->mutex);
+    }
+
+    /* signal I/O thread */
+    pthread_mutex_lock(&capt->mutex);
+    pthread_cond_signal(&capt->cond[0]);
+    pthread_mutex_unlock(&capt->mutex);
+}
+
 /******************************************************************************/
 
+#if RT_XSHM
+
+/* platform-specific presentation thread
+ * putting rotated XShm images to the screen */
+struct rt_PRESENT
+{
+    GC                  gc;
+    rt_si32             shm_ev;  /* ShmCompletion event's type */
+    rt_si32             queue;   /* image queued for presentation or -1 */
+    rt_si32             busy[RT_XSHM_NUM]; /* queued or being presented */
+    rt_bool             quit;
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond[2]; /* 0 - image queued, 1 - image dequeued */
+    pthread_t           pthr;
+};
+
+rt_PRESENT  present;
+
 /*
- * Set current frame to screen.
+ * Presentation thread's entry point.
  */
-rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+rt_pntr present_thread(rt_pntr p)
 {
-    if (frame == RT_NULL)
+    rt_PRESENT *pres = (rt_PRESENT *)p;
+    XEvent event;
+    rt_si32 k;
+
+    pthread_mutex_lock(&pres->mutex);
+
+    while (1)
     {
-        return;
+        if (pres->queue < 0)
+        {
+            if (pres->quit)
+            {
+                break;
+            }
+
+            pthread_cond_wait(&pres->cond[0], &pres->mutex);
+            continue;
+        }
+
+        k = pres->queue;
+        pres->queue = -1;
+
+        /* signal main thread if waiting to queue next image */
+        pthread_cond_signal(&pres->cond[1]);
+
+        /* present outside of the lock,
+         * so that rendering isn't blocked */
+        pthread_mutex_unlock(&pres->mutex);
+
+        XShmPutImage(pdisp, win, pres->gc, xshm_img[k],
+                     0, 0, 0, 0, x_res, y_res, True);
+
+        /* wait until X server is done reading the image,
+         * only ShmCompletion events are delivered to "pdisp" */
+        do
+        {
+            XNextEvent(pdisp, &event);
+        }
+        while (event.type != pres->shm_ev);
+
+        pthread_mutex_lock(&pres->mutex);
+        pres->busy[k] = 0;
+
+        /* signal main thread if waiting for a free image */
+        pthread_cond_signal(&pres->cond[1]);
     }
 
+    pthread_mutex_unlock(&pres->mutex);
+
+    return RT_NULL;
+}
+
+/*
+ * Initialize platform-specific presentation thread,
+ * which puts images queued by "frame_to_screen" to the screen.
+ */
+rt_void init_present()
+{
+    rt_PRESENT *pres = &present;
+
+    pres->gc = XCreateGC(pdisp, win, 0, &gc_values);
+    pres->shm_ev = XShmGetEventBase(pdisp) + ShmCompletion;
+    pres->queue = -1;
+    memset(pres->busy, 0, sizeof(pres->busy));
+    pres->quit = RT_FALSE;
+
+    pthread_mutex_init(&pres->mutex, NULL);
+    pthread_cond_init(&pres->cond[0], NULL);
+    pthread_cond_init(&pres->cond[1], NULL);
+
+    pthread_create(&pres->pthr, NULL, present_thread, pres);
+}
+
+/*
+ * Terminate platform-specific presentation thread,
+ * block until queued image is put to the screen.
+ */
+rt_void term_present()
+{
+    rt_PRESENT *pres = &present;
+
+    /* signal presentation thread to terminate once the queue is empty */
+    pthread_mutex_lock(&pres->mutex);
+    pres->quit = RT_TRUE;
+    pthread_cond_signal(&pres->cond[0]);
+    pthread_mutex_unlock(&pres->mutex);
+
+    pthread_join(pres->pthr, NULL);
+
+    pthread_cond_destroy(&pres->cond[0]);
+    pthread_cond_destroy(&pres->cond[1]);
+    pthread_mutex_destroy(&pres->mutex);
+
+    XFreeGC(pdisp, pres->gc);
+}
+
+#endif /* RT_XSHM */
+
+/******************************************************************************/
+/*******************************   EVENT-LOOP   *******************************/
+/******************************************************************************/
+
+/*
+ * Convert or copy frame to "image" unless rendered to it directly.
+ */
+rt_void frame_to_image(XImage *image, rt_ui32 *frame, rt_si32 x_row)
+{
     if (depth == 16)
     {
         rt_si32 i, j;
 
         for (i = 0; i < y_res; i++)
         {
-            rt_ui16 *idata = (rt_ui16 *)ximage->data +
-                             i * (ximage->bytes_per_line / 2);
+            rt_ui16 *idata = (rt_ui16 *)image->data +
+                             i * (image->bytes_per_line / 2);
 
             for (j = 0; j < x_res; j++)
             {
@@ -835,18 +1148,122 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
         }
     }
     else
-    if (frame != ::frame)
+    if (frame != (rt_ui32 *)image->data)
     {
         rt_si32 i;
 
         for (i = 0; i < y_res; i++)
         {
-            rt_ui32 *idata = (rt_ui32 *)ximage->data +
-                             i * (ximage->bytes_per_line / 4);
+            rt_ui32 *idata = (rt_ui32 *)image->data +
+                             i * (image->bytes_per_line / 4);
 
             memcpy(idata, frame + i * x_row, x_res * sizeof(rt_ui32));
         }
     }
+}
+
+#if RT_XSHM
+
+/*
+ * Wait for an image which is neither queued nor being presented,
+ * return its index (called with presentation thread's mutex locked).
+ */
+rt_si32 wait_image(rt_PRESENT *pres)
+{
+    rt_si32 k;
+
+    while (1)
+    {
+        for (k = 0; k < xshm_num; k++)
+        {
+            if (pres->busy[k] == 0)
+            {
+                return k;
+            }
+        }
+
+        pthread_cond_wait(&pres->cond[1], &pres->mutex);
+    }
+}
+
+/*
+ * Queue frame for presentation thread and rotate render target,
+ * block only if all images are yet to be put to the screen.
+ */
+rt_void present_frame(rt_ui32 *frame, rt_si32 x_row)
+{
+    rt_PRESENT *pres = &present;
+    rt_si32 k, n;
+
+    /* find the image rendered to directly (if any) */
+    for (k = 0; k < xshm_num; k++)
+    {
+        if (frame == (rt_ui32 *)xshm_img[k]->data)
+        {
+            break;
+        }
+    }
+
+    n = k; /* "xshm_num" if not rendered to directly */
+
+    pthread_mutex_lock(&pres->mutex);
+
+    if (n == xshm_num)
+    {
+        k = wait_image(pres);
+
+        /* convert or copy outside of the lock,
+         * only main thread marks images as busy */
+        pthread_mutex_unlock(&pres->mutex);
+        frame_to_image(xshm_img[k], frame, x_row);
+        pthread_mutex_lock(&pres->mutex);
+    }
+
+    /* wait for previously queued image to be dequeued */
+    while (pres->queue >= 0)
+    {
+        pthread_cond_wait(&pres->cond[1], &pres->mutex);
+    }
+
+    pres->queue = k;
+    pres->busy[k] = 1;
+
+    /* signal presentation thread */
+    pthread_cond_signal(&pres->cond[0]);
+
+    if (n < xshm_num)
+    {
+        /* render next frame to a free image directly */
+        k = wait_image(pres);
+
+        ::frame = (rt_ui32 *)xshm_img[k]->data;
+    }
+
+    pthread_mutex_unlock(&pres->mutex);
+}
+
+#endif /* RT_XSHM */
+
+/*
+ * Set current frame to screen.
+ */
+rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+{
+    if (frame == RT_NULL)
+    {
+        return;
+    }
+
+#if RT_XSHM
+    if (pdisp != NULL)
+    {
+        /* put image to the screen on presentation thread */
+        present_frame(frame, x_row);
+        return;
+    }
+#endif /* RT_XSHM */
+
+    frame_to_image(ximage, frame, x_row);
 
 #if RT_XSHM
     if (xshm == RT_TRUE)
@@ -29,6 +29,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_a32
 
@@ -48,6 +54,17 @@ RooT_a32:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.a32
 
 
+headless: RooT_a32h
+
+RooT_a32h:
+	g++ -O3 -g -pthread -mabi=ilp32 \
+        -DRT_LINUX -DRT_A32 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.a32h
+
+
 clang: RooT.a32
 
 RooT.a32:
@@ -69,6 +86,10 @@ RooT.a32:
 # ./RooT.a32 (on AArch64 host or QEMU system mode with ILP32 X11/Xext libs)
 # (hasn't been verified yet due to lack of available libs)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_a32.mk headless
+# ./RooT.a32h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build should theoretically work too (not tested):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang g++-multilib (plus X11/Xext libs for ILP32 ABI)
@@ -38,9 +38,16 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: build_a64 build_a64sve
 clang: clang_a64 clang_a64sve
+headless: RooT_a64_32h RooT_a64_64h RooT_a64f32h RooT_a64f64h
 
 strip:
 	strip RooT.a64*
@@ -100,6 +107,39 @@ RooT_a64f64:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.a64f64
 
 
+RooT_a64_32h:
+	g++ -O3 -g -pthread \
+        -DRT_LINUX -DRT_A64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.a64_32h
+
+RooT_a64_64h:
+	g++ -O3 -g -pthread \
+        -DRT_LINUX -DRT_A64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.a64_64h
+
+RooT_a64f32h:
+	g++ -O3 -g -pthread \
+        -DRT_LINUX -DRT_A64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.a64f32h
+
+RooT_a64f64h:
+	g++ -O3 -g -pthread \
+        -DRT_LINUX -DRT_A64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.a64f64h
+
+
 build_a64sve: RooT_a64_32sve RooT_a64_64sve \
               RooT_a64f32sve RooT_a64f64sve
 
@@ -226,6 +266,11 @@ RooT.a64f64sve:
 # (has been tested on Raspberry Pi 3 target host system with Devuan/openSUSE)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_a64.mk headless
+# ./RooT.a64f32h -f 300 -i 0 (saves image at the end of the run)
+# (runs in QEMU linux-user mode, frames are streamed to redirected stdout)
+
 # Clang native build works too (takes much longer prior to 3.8):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on AArch64 host or QEMU system mode)
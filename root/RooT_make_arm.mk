@@ -29,6 +29,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_arm_v1
 
@@ -48,6 +54,17 @@ RooT_arm_v1:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.arm_v1
 
 
+headless: RooT_arm_v1h
+
+RooT_arm_v1h:
+	g++ -O3 -g -pthread -march=armv7-a -marm \
+        -DRT_LINUX -DRT_ARM -DRT_128=1 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.arm_v1h
+
+
 clang: RooT.arm_v1
 
 RooT.arm_v1:
@@ -133,6 +150,10 @@ RooT.arm_rpi3:
 # (has been tested on Raspberry Pi 2/3 target host system with Raspbian/Ubuntu)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_arm.mk headless
+# ./RooT.arm_v1h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build works too (takes much longer prior to 3.8):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on ARMv7 host or QEMU system mode)
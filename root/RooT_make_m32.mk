@@ -29,6 +29,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_m32Lr5
 
@@ -48,6 +54,17 @@ RooT_m32Lr5:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.m32Lr5
 
 
+headless: RooT_m32Lr5h
+
+RooT_m32Lr5h:
+	g++ -O3 -g -pthread -mips32r5 -mmsa -mnan=2008 \
+        -DRT_LINUX -DRT_M32 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.m32Lr5h
+
+
 clang: RooT.m32Lr5
 
 RooT.m32Lr5:
@@ -70,6 +87,10 @@ RooT.m32Lr5:
 # (hasn't been verified yet due to lack of target host system)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_m32.mk headless
+# ./RooT.m32Lr5h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build should theoretically work too (not tested):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on MIPS32 host or QEMU system mode)
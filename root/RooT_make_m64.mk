@@ -29,6 +29,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_m64_32Lr6 RooT_m64_64Lr6 RooT_m64f32Lr6 RooT_m64f64Lr6
 
@@ -72,6 +78,41 @@ RooT_m64f64Lr6:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.m64f64Lr6
 
 
+headless: RooT_m64_32Lr6h RooT_m64_64Lr6h RooT_m64f32Lr6h RooT_m64f64Lr6h
+
+RooT_m64_32Lr6h:
+	g++ -O3 -g -pthread -mmsa \
+        -DRT_LINUX -DRT_M64=6 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.m64_32Lr6h
+
+RooT_m64_64Lr6h:
+	g++ -O3 -g -pthread -mmsa \
+        -DRT_LINUX -DRT_M64=6 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.m64_64Lr6h
+
+RooT_m64f32Lr6h:
+	g++ -O3 -g -pthread -mmsa \
+        -DRT_LINUX -DRT_M64=6 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.m64f32Lr6h
+
+RooT_m64f64Lr6h:
+	g++ -O3 -g -pthread -mmsa \
+        -DRT_LINUX -DRT_M64=6 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.m64f64Lr6h
+
+
 clang: RooT.m64_32Lr6 RooT.m64_64Lr6 RooT.m64f32Lr6 RooT.m64f64Lr6
 
 RooT.m64_32Lr6:
@@ -118,6 +159,10 @@ RooT.m64f64Lr6:
 # (hasn't been verified yet due to lack of target host system)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_m64.mk headless
+# ./RooT.m64f32Lr6h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build should theoretically work too (not tested):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on MIPS64 host or QEMU system mode)
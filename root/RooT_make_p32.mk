@@ -28,6 +28,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_p32Bg4
 
@@ -47,6 +53,17 @@ RooT_p32Bg4:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.p32Bg4
 
 
+headless: RooT_p32Bg4h
+
+RooT_p32Bg4h:
+	g++ -O3 -g -pthread \
+        -DRT_LINUX -DRT_P32 -DRT_128=4 -DRT_256_R8=4 -DRT_SIMD_COMPAT_VSX=0 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=1 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p32Bg4h
+
+
 clang: RooT.p32Bg4
 
 RooT.p32Bg4:
@@ -70,6 +87,10 @@ RooT.p32Bg4:
 # (hasn't been verified yet due to lack of target host system)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_p32.mk headless
+# ./RooT.p32Bg4h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build should theoretically work too (not tested):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on PowerPC host or QEMU system mode)
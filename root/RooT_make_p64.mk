@@ -35,6 +35,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: build_p8 build_p9
 
@@ -118,6 +124,78 @@ RooT_p64f64Lp9:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.p64f64Lp9
 
 
+headless: headless_p8 headless_p9
+
+headless_p8: RooT_p64_32Lp8h RooT_p64_64Lp8h RooT_p64f32Lp8h RooT_p64f64Lp8h
+
+RooT_p64_32Lp8h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64_32Lp8h
+
+RooT_p64_64Lp8h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64_64Lp8h
+
+RooT_p64f32Lp8h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64f32Lp8h
+
+RooT_p64f64Lp8h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1 -DRT_256=1 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64f64Lp8h
+
+
+headless_p9: RooT_p64_32Lp9h RooT_p64_64Lp9h RooT_p64f32Lp9h RooT_p64f64Lp9h
+
+RooT_p64_32Lp9h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1+2 -DRT_256=1+2 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64_32Lp9h
+
+RooT_p64_64Lp9h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1+2 -DRT_256=1+2 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64_64Lp9h
+
+RooT_p64f32Lp9h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1+2 -DRT_256=1+2 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64f32Lp9h
+
+RooT_p64f64Lp9h:
+	g++ -O2 -g -pthread -mcpu=power8 \
+        -DRT_LINUX -DRT_P64 -DRT_128=1+2 -DRT_256=1+2 \
+        -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.p64f64Lp9h
+
+
 clang: clang_p8 clang_p9
 
 clang_p8: RooT.p64_32Lp8 RooT.p64_64Lp8 RooT.p64f32Lp8 RooT.p64f64Lp8
@@ -202,6 +280,10 @@ RooT.p64f64Lp9:
 # (has been tested on Tyan TN71-BP012 POWER8 with Ubuntu Server 16.04/18.04)
 # (SIMD and CORE tests pass in QEMU linux-user mode, check test subfolder)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_p64.mk headless
+# ./RooT.p64f32Lp8h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build works too (takes much longer prior to 3.8):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on POWER host or QEMU system mode)
@@ -43,6 +43,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_x32
 
@@ -63,6 +69,18 @@ RooT_x32:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.x32
 
 
+headless: RooT_x32h
+
+RooT_x32h:
+	g++ -O3 -g -pthread -mx32 \
+        -DRT_LINUX -DRT_X32 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_SIMD_COMPAT_SSE=2 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.x32h
+
+
 clang: RooT.x32
 
 RooT.x32:
@@ -86,6 +104,10 @@ RooT.x32:
 # ./RooT.x32
 # (hasn't been verified yet due to lack of available libs, SIMD/CORE tests pass)
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_x32.mk headless
+# ./RooT.x32h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build should theoretically work too (not tested):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang g++-multilib (plus X11/Xext libs for x32 ABI)
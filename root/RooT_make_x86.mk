@@ -36,6 +36,12 @@ LIB_LIST =                                  \
         -lXext                              \
         -lpthread
 
+SRC_HDLS = ${SRC_LIST:RooT_linux.cpp=RooT_headless.cpp}
+
+LIB_HDLS =                                  \
+        -lm                                 \
+        -lpthread
+
 
 build: RooT_x86
 
@@ -64,6 +70,17 @@ RooT_x86:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT.x86
 
 
+headless: RooT_x86h
+
+RooT_x86h:
+	g++ -O3 -g -pthread -m32 \
+        -DRT_LINUX -DRT_X86 -DRT_128=1+2+4+8 -DRT_256=1+2 -DRT_512=1+2 \
+        -DRT_POINTER=32 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_PATH="../" -DRT_FULLSCREEN=0 \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_HDLS} ${LIB_PATH} ${LIB_HDLS} -o RooT.x86h
+
+
 clang: RooT.x86
 
 RooT.x86:
@@ -86,6 +103,10 @@ RooT.x86:
 # make -f RooT_make_x86.mk
 # ./RooT.x86
 
+# Headless build (no X11) for display-less render nodes:
+# make -f RooT_make_x86.mk headless
+# ./RooT.x86h -f 300 -i 0 (saves image at the end of the run)
+
 # Clang native build works too (takes much longer prior to 3.8):
 # sudo apt-get update (on Ubuntu add "universe" to "main" /etc/apt/sources.list)
 # sudo apt-get install clang libxext-dev (on x86 host) or if libs are present:
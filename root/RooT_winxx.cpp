@@ -279,6 +279,19 @@ rt_time get_time()
     return (rt_time)(tm.QuadPart * 1000 / fr.QuadPart);
 }
 
+/*
+ * Get monotonic time in nanoseconds.
+ */
+rt_time get_tick()
+{
+    LARGE_INTEGER fr;
+    QueryPerformanceFrequency(&fr);
+    LARGE_INTEGER tm;
+    QueryPerformanceCounter(&tm);
+    return (rt_time)(tm.QuadPart / fr.QuadPart * 1000000000 +
+                     tm.QuadPart % fr.QuadPart * 1000000000 / fr.QuadPart);
+}
+
 
 #if RT_POINTER == 64
 #if RT_ADDRESS == 32
@@ -833,6 +846,111 @@ rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
     tpool->windex = 1 - tpool->windex;
 }
 
+/******************************************************************************/
+
+/* platform-specific I/O thread
+ * writing captured frames */
+struct rt_CAPTURE
+{
+    rt_Platform        *pfm;
+    rt_si32             num;
+    volatile rt_bool    quit;
+    HANDLE              cevent[2]; /* 0 - frame queued, 1 - frame written */
+    HANDLE              pthr;
+};
+
+/*
+ * I/O thread's entry point.
+ */
+DWORD WINAPI capture_thread(rt_pntr p)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)p;
+
+    while (1)
+    {
+        if (capt->pfm->write_capt() < 0)
+        {
+            if (capt->quit)
+            {
+                break;
+            }
+
+            /* auto-reset event stays signaled
+             * if set before waiting */
+            WaitForSingleObject(capt->cevent[0], INFINITE);
+            continue;
+        }
+
+        /* signal main thread if waiting for a free frame */
+        SetEvent(capt->cevent[1]);
+    }
+
+    return 0;
+}
+
+/*
+ * Initialize platform-specific I/O thread, which writes frames
+ * captured to platform's ring of "num" frames to files.
+ */
+rt_pntr init_capture(rt_si32 num, rt_Platform *pfm)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)malloc(sizeof(rt_CAPTURE));
+
+    if (capt == RT_NULL)
+    {
+        throw rt_Exception("out of memory for capt in init_capture");
+    }
+
+    capt->pfm = pfm;
+    capt->num = num;
+    capt->quit = RT_FALSE;
+
+    capt->cevent[0] = CreateEvent(NULL, FALSE, FALSE, NULL);
+    capt->cevent[1] = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+    capt->pthr = CreateThread(NULL, 0, capture_thread, capt, 0, NULL);
+
+    return capt;
+}
+
+/*
+ * Terminate platform-specific I/O thread,
+ * block until all captured frames are written.
+ */
+rt_void term_capture(rt_pntr cdata)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    /* signal I/O thread to terminate once the ring is empty */
+    capt->quit = RT_TRUE;
+    SetEvent(capt->cevent[0]);
+
+    WaitForSingleObject(capt->pthr, INFINITE);
+
+    CloseHandle(capt->pthr);
+    CloseHandle(capt->cevent[0]);
+    CloseHandle(capt->cevent[1]);
+
+    free(capt);
+}
+
+/*
+ * Capture scene's frame for platform-specific I/O thread,
+ * block only if all frames in the ring are yet to be written.
+ */
+rt_void capture_frame(rt_pntr cdata, rt_Scene *scn, rt_si32 index)
+{
+    rt_CAPTURE *capt = (rt_CAPTURE *)cdata;
+
+    while (scn->capt_frame(index) == 0)
+    {
+        WaitForSingleObject(capt->cevent[1], INFINITE);
+    }
+
+    /* signal I/O thread */
+    SetEvent(capt->cevent[0]);
+}
+
 /******************************************************************************/
 /*******************************   EVENT-LOOP   *******************************/
 /******************************************************************************/
@@ -31,7 +31,8 @@ SRC_LIST =                                  \
 LIB_PATH =
 
 LIB_LIST =                                  \
-        -lm
+        -lm                                 \
+        -lpthread
 
 
 build: build_a64 build_a64sve
@@ -24,7 +24,8 @@ SRC_LIST =                                  \
 LIB_PATH =
 
 LIB_LIST =                                  \
-        -lm
+        -lm                                 \
+        -lpthread
 
 
 build: core_test_arm_v1 core_test_arm_v2
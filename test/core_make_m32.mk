@@ -24,7 +24,8 @@ SRC_LIST =                                  \
 LIB_PATH =
 
 LIB_LIST =                                  \
-        -lm
+        -lm                                 \
+        -lpthread
 
 
 build: core_test_m32Lr5 core_test_m32Br5
@@ -24,7 +24,8 @@ SRC_LIST =                                  \
 LIB_PATH =
 
 LIB_LIST =                                  \
-        -lm
+        -lm                                 \
+        -lpthread
 
 
 build: build_le build_be
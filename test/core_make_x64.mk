@@ -38,11 +38,13 @@ SRC_LIST =                                  \
 LIB_PATH =
 
 LIB_LIST =                                  \
-        -lm
+        -lm                                 \
+        -lpthread
 
 
 build: core_test_x64_32 core_test_x64_64 core_test_x64f32 core_test_x64f64
 clang: core_test.x64_32 core_test.x64_64 core_test.x64f32 core_test.x64f64
+stats: core_test_x64s32
 
 strip:
 	strip core_test.x64*
@@ -99,6 +101,15 @@ core_test_x64f64:
         -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o core_test.x64f64
 
+core_test_x64s32:
+	g++ -O3 -g \
+        -DRT_LINUX -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_SIMD_COMPAT_SSE=2 \
+        -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
+        -DRT_DEBUG=0 -DRT_FEAT_STATS=1 -DRT_PATH="../" \
+        -DRT_EMBED_STDOUT=0 -DRT_EMBED_FILEIO=0 -DRT_EMBED_TEX=1 \
+        ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o core_test.x64s32
+
 
 core_test.x64_32:
 	clang++ -O3 -g \
@@ -155,6 +166,10 @@ core_test.x64f64:
 # ./core_test.x64f32 -i -a -c 1
 # (should produce antialiased "-a" images "-i" in the ../dump subfolder)
 # Use "-c 1" option to reduce test time when emulating with Intel SDE
+#
+# Ray packet counters (RT_FEAT_STATS) are built out by default, to test them:
+# make -f core_make_x64.mk stats
+# ./core_test.x64s32 -m 12
 
 # Clang native build works too (takes much longer prior to 3.8), use (replace):
 # clang++ (in place of g++)
@@ -16,6 +16,8 @@
 
 #define SUB_TEST            18
 #define CYC_SIZE            3
+#define PTCV_TOL            0.02f
+#define DNSE_NUM            3
 
 #define RT_X_RES            800
 #define RT_Y_RES            480
@@ -61,7 +63,55 @@ rt_bool     l_mode      = RT_FALSE;     /* log-off mode (from command-line) */
 rt_bool     o_mode      = RT_FALSE;     /* optimal mode (from command-line) */
 rt_bool     q_mode      = RT_FALSE;     /* quality mode (from command-line) */
 rt_bool     q_test      = RT_FALSE;     /* quality mode (from actual scene) */
+rt_bool     u_mode      = RT_FALSE;     /* autotune mode (from command-line) */
 rt_si32     a_mode      = RT_FSAA_NO;   /* antialiasing (from command-line) */
+rt_si32     m_mode      = 0;            /* render mode  (from command-line) */
+rt_si32     j_size      = 1;            /* threads num  (from command-line) */
+
+/* render modes of test runs: 0 - full frames,
+ * 1 - optimized run within 2 regions of interest,
+ * 2 - path-tracer's adaptive sampling in both runs,
+ * 3 - optimized run with tiles' cost heatmap (single tiles),
+ * 4 - optimized run with static-frame cache (RT_OPTS_STATIC),
+ * 5 - optimized run with progressive render (row per call),
+ * 6 - optimized run in a batch with the next test's scene,
+ * 7 - optimized run in checkerboard mode (traced pixels),
+ * 8 - optimized run with variable-rate render at full rate,
+ * 9 - adaptive antialiasing in both runs (-a n),
+ * 10 - path-tracer's denoiser in both runs (-q),
+ * 11 - optimized run with frame timers (records' ages),
+ * 12 - optimized run with ray packet counters (RT_FEAT_STATS),
+ * 13 - optimized run with frame capture (image read back),
+ * 14 - optimized run in the pipeline (update overlaps render),
+ * 15 - optimized run with automatic bvnodes (RT_OPTS_VARRAY_EXT1),
+ * 16 - optimized run with variable-rate render at low rates,
+ * reference run is optimized too if mode isn't 0 */
+
+/* regions of interest for render mode 1,
+ * 2 rectangles sharing the same rows of tiles */
+rt_si32     m_rect[8];
+
+/* reservations of per-frame pools (main thread's first)
+ * before the last frame of the reference run, which
+ * rebuilds lists and reserves pools in every frame */
+rt_ui32    *m_size      = RT_NULL;
+rt_si32     m_thnum     = 0;
+
+/* scene of the next test paired with the test's scene
+ * in render mode 6, ray packets counted in the last frame
+ * of the reference run for render mode 12 */
+rt_Scene   *m_pair      = RT_NULL;
+rt_word     m_stat[RT_STAT_NUM];
+
+/* automatic bvnodes built in scenes' constructors
+ * of the optimized run in render mode 15 */
+rt_bool     m_varr      = RT_FALSE;
+
+/*
+ * Common instance of platform container,
+ * created once the number of threads is known.
+ */
+rt_Platform *pfm = RT_NULL;
 
 /*
  * Get system time in milliseconds.
@@ -78,6 +128,28 @@ rt_pntr sys_alloc(rt_size size);
  */
 rt_void sys_free(rt_pntr ptr, rt_size size);
 
+/*
+ * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ */
+rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm);
+
+/*
+ * Terminate platform-specific pool of "thnum" threads.
+ */
+rt_void term_threads(rt_pntr tdata, rt_si32 thnum);
+
+/*
+ * Task platform-specific pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
+
+/*
+ * Task platform-specific pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
+
 /*
  * Copy frames.
  */
@@ -92,6 +164,485 @@ rt_void frame_cpy(rt_ui32 *fd, rt_ui32 *fs)
     }
 }
 
+/*
+ * Shading rate of the tile with pixel "x", "y" in render mode 16,
+ * rates repeat diagonally over tiles (full, 1/2, 1/4, 1/16).
+ */
+rt_si32 rate_get(rt_si32 x, rt_si32 y)
+{
+    return (x / pfm->get_tile_w() + y / pfm->get_tile_h()) % 4;
+}
+
+/*
+ * Set tiles' shading rates of variable-rate render in render mode 16.
+ */
+rt_void rate_set()
+{
+    rt_si32 tw = pfm->get_tile_w(), th = pfm->get_tile_h();
+    rt_si32 n = (x_res + tw - 1) / tw, m = (y_res + th - 1) / th;
+    rt_si32 *rate = (rt_si32 *)sys_alloc(n * m * sizeof(rt_si32));
+    rt_si32 i, j;
+
+    for (i = 0; i < m; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            rate[i * n + j] = rate_get(j * tw, i * th);
+        }
+    }
+
+    scene->set_rates(rate);
+
+    sys_free(rate, n * m * sizeof(rt_si32));
+}
+
+/*
+ * Set render mode for test "run" (0 - reference, 1 - optimized).
+ */
+rt_void mode_set(rt_si32 run)
+{
+    if (m_mode == 1 && run == 1)
+    {
+        scene->set_rects(2, m_rect);
+    }
+    if (m_mode == 2)
+    {
+        scene->set_ptcv(PTCV_TOL);
+    }
+    if (m_mode == 3 && run == 1)
+    {
+        scene->set_heat(1, get_time);
+    }
+    if (m_mode == 7 && run == 1)
+    {
+        scene->set_cbon(1);
+    }
+    if (m_mode == 8 && run == 1)
+    {
+        scene->set_focus(x_res / 2, y_res / 2, x_res + y_res);
+    }
+    if (m_mode == 9)
+    {
+        pfm->set_fsaa(RT_FSAA_NO);
+        scene->set_adaa(a_mode);
+    }
+    if (m_mode == 10)
+    {
+        scene->set_dnse(DNSE_NUM);
+    }
+    if (m_mode == 11 && run == 1)
+    {
+        scene->set_tmrs(CYC_SIZE, get_time);
+    }
+    if (m_mode == 16)
+    {
+        /* antialiasing samples of traced pixels below full rate
+         * are spread over the rate's steps, thus they can't be exact */
+        pfm->set_fsaa(RT_FSAA_NO);
+    }
+    if (m_mode == 16 && run == 1)
+    {
+        rate_set();
+    }
+}
+
+/*
+ * Render frame for a given "time" in render mode of test "run"
+ * (0 - reference, 1 - optimized), the test's scene is rendered
+ * for the same "time" in every mode.
+ */
+rt_void mode_run(rt_si32 run, rt_time time)
+{
+    rt_Scene *scn[2] = {scene, m_pair};
+    rt_si32 k = 1;
+
+    /* camera turns in every frame of render mode 14,
+     * so that frames overlapped in the pipeline differ */
+    if (m_mode == 14)
+    {
+        scene->update(time, RT_CAMERA_ROTATE_LEFT);
+    }
+
+    if (m_mode == 5 && run == 1)
+    {
+        /* zero budget renders a row of tiles per call */
+        while (k != 0)
+        {
+            k = scene->render_part(time, 0, get_time);
+        }
+    }
+    else
+    if (m_mode == 6 && run == 1)
+    {
+        pfm->render_batch(scn, 2, time);
+    }
+    else
+    if (m_mode == 14 && run == 1)
+    {
+        /* renders frame of the previous call */
+        pfm->render_pipe(scene, time);
+    }
+    else
+    {
+        scene->render(time);
+    }
+}
+
+/*
+ * Set automatic bvnodes in scene definition "scn" before construction,
+ * as they are built once in arrays' constructors (render mode 15).
+ */
+rt_SCENE *mode_scn(rt_SCENE *scn)
+{
+    if (m_varr)
+    {
+        scn->opts |= RT_OPTS_VARRAY_EXT1;
+    }
+    else
+    {
+        scn->opts &= ~RT_OPTS_VARRAY_EXT1;
+    }
+
+    return scn;
+}
+
+/*
+ * Copy pixels outside of regions of interest,
+ * which keep previous contents in render mode 1.
+ */
+rt_void frame_roi(rt_ui32 *fd, rt_ui32 *fs)
+{
+    rt_si32 i, j, k;
+
+    for (j = 0; j < y_res; j++)
+    {
+        for (i = 0; i < x_res; i++)
+        {
+            for (k = 0; k < 8; k += 4)
+            {
+                if (i >= m_rect[k + 0] && i < m_rect[k + 2]
+                &&  j >= m_rect[k + 1] && j < m_rect[k + 3])
+                {
+                    break;
+                }
+            }
+            if (k == 8)
+            {
+                fd[j*x_row + i] = fs[j*x_row + i];
+            }
+        }
+    }
+}
+
+/*
+ * Copy pixels reconstructed in render mode 7, traced pixels
+ * of the last frame form one of the two checkerboard patterns,
+ * the one with fewer pixels differing from the reference.
+ */
+rt_void frame_cbrd(rt_ui32 *fd, rt_ui32 *fs)
+{
+    rt_si32 i, j, k, d[2] = {0, 0};
+
+    for (j = 0; j < y_res; j++)
+    {
+        for (i = 0; i < x_res; i++)
+        {
+            if (!PEQ(fd[j*x_row + i], fs[j*x_row + i]))
+            {
+                d[(i + j) & 1]++;
+            }
+        }
+    }
+
+    k = d[0] > d[1] ? 0 : 1;
+
+    for (j = 0; j < y_res; j++)
+    {
+        for (i = 0; i < x_res; i++)
+        {
+            if (((i + j) & 1) == k)
+            {
+                fd[j*x_row + i] = fs[j*x_row + i];
+            }
+        }
+    }
+}
+
+/*
+ * Check pixels of variable-rate render in render mode 16, pixels traced
+ * at every rate (each 4th pixel of each 4th row of tiles below full rate)
+ * must be exact, upsampled pixels must be within the range (extended by
+ * diff-threshold) of the reference's pixels around their cell of 4x4
+ * pixels, upsampled pixels are then copied from the reference.
+ */
+rt_si32 frame_rate(rt_ui32 *fd, rt_ui32 *fs)
+{
+    rt_si32 i, j, k, l, c, x, y, v, lo, hi, ret = 0;
+    rt_si32 th = pfm->get_tile_h();
+
+    for (j = 0; j < y_res; j++)
+    {
+        for (i = 0; i < x_res; i++)
+        {
+            /* cell's origin */
+            x = i - i % 4;
+            y = j - j % th % 4;
+
+            if (rate_get(i, j) == 0 || (x == i && y == j))
+            {
+                if (fd[j*x_row + i] == fs[j*x_row + i])
+                {
+                    continue;
+                }
+
+                if (!l_mode && (v_mode || ret == 0))
+                RT_LOGI("Traced pixels differ (%06X %06X) at x = %d, y = %d\n",
+                            fd[j*x_row + i], fs[j*x_row + i], i, j);
+
+                ret = 1;
+                continue;
+            }
+
+            for (c = 0; c < 24; c += 8)
+            {
+                lo = 0xFF;
+                hi = 0x00;
+
+                for (l = y; l <= RT_MIN(y + 4, y_res - 1); l++)
+                {
+                    for (k = x; k <= RT_MIN(x + 4, x_res - 1); k++)
+                    {
+                        v = (fs[l*x_row + k] >> c) & 0xFF;
+                        lo = RT_MIN(lo, v);
+                        hi = RT_MAX(hi, v);
+                    }
+                }
+
+                v = (fd[j*x_row + i] >> c) & 0xFF;
+
+                if (v < lo - t_diff || v > hi + t_diff)
+                {
+                    break;
+                }
+            }
+
+            if (c == 24)
+            {
+                fd[j*x_row + i] = fs[j*x_row + i];
+                continue;
+            }
+
+            if (!l_mode && (v_mode || ret == 0))
+            RT_LOGI("Upsampled pixels differ (%06X %06X) at x = %d, y = %d\n",
+                        fd[j*x_row + i], fs[j*x_row + i], i, j);
+
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * Check frame timers of the optimized run in render mode 11,
+ * each of the last frames (up to the number of records) must have
+ * a record with its frame's time, in which no thread is busy
+ * in a slot for longer than the main thread's time in the slot.
+ */
+rt_si32 tmrs_cmp()
+{
+    rt_si32 i, j, k, n = RT_MIN(r_test, CYC_SIZE), ret = 0;
+
+    for (i = 0; i <= n; i++)
+    {
+        rt_TMRS *tmrs = scene->get_tmrs(i);
+
+        if ((tmrs == RT_NULL) == (i < n))
+        {
+            ret = 1;
+
+            if (!l_mode)
+            RT_LOGI("Timers' record of age %d is %s\n", i,
+                                    i < n ? "missing" : "extra");
+        }
+        if (tmrs == RT_NULL)
+        {
+            continue;
+        }
+
+        if (tmrs->time != (q_test ? 0 : (r_test - 1 - i) * f_time))
+        {
+            ret = 1;
+
+            if (!l_mode)
+            RT_LOGI("Timers' record of age %d has time %d\n", i,
+                                                    (rt_si32)tmrs->time);
+        }
+
+        for (j = 0; j < tmrs->thnum; j++)
+        {
+            for (k = 0; k < RT_TMRS_NUM; k++)
+            {
+                if (tmrs->busy[j * RT_TMRS_NUM + k] <= tmrs->wall[k])
+                {
+                    continue;
+                }
+
+                ret = 1;
+
+                if (!l_mode)
+                RT_LOGI("Timers differ (%d %d) in slot %d of thread %d\n",
+                                (rt_si32)tmrs->wall[k],
+                                (rt_si32)tmrs->busy[j * RT_TMRS_NUM + k], k, j);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * Check ray packet counters of the optimized run in render mode 12,
+ * the last frame must trace as many packets as the reference,
+ * one primary packet per SIMD-width of samples in every row
+ * in a build with RT_FEAT_STATS (make stats), else all zeros.
+ */
+rt_si32 stat_cmp()
+{
+    rt_si32 i, ret = 0;
+    rt_word prm = 0;
+
+#if RT_FEAT_STATS
+    rt_si32 n = n_simd * k_size * 128 / RT_ELEMENT;
+    prm = (rt_word)y_res * (((x_res << a_mode) + n - 1) / n);
+#endif /* RT_FEAT_STATS */
+
+    for (i = 0; i < RT_STAT_NUM; i++)
+    {
+        if (scene->get_stat(i) == m_stat[i])
+        {
+            continue;
+        }
+
+        if (!l_mode)
+        RT_LOGI("Counters differ (%ld %ld) for packets %d\n",
+                 (long)m_stat[i], (long)scene->get_stat(i), i);
+
+        ret = 1;
+    }
+
+    if (scene->get_stat(RT_STAT_PRM) != prm
+    ||  scene->get_stat(RT_STAT_SRF) < prm
+    ||  scene->get_stat(RT_STAT_CLP) > scene->get_stat(RT_STAT_SRF))
+    {
+        if (!l_mode)
+        RT_LOGI("Counters wrong (%ld %ld %ld) for primary packets %ld\n",
+                 (long)scene->get_stat(RT_STAT_PRM),
+                 (long)scene->get_stat(RT_STAT_SRF),
+                 (long)scene->get_stat(RT_STAT_CLP), (long)prm);
+
+        ret = 1;
+    }
+
+    return ret;
+}
+
+/*
+ * Capture the last frame of the optimized run in render mode 13
+ * under "index", write it to an image and compare the image,
+ * read back from the file, with the frame.
+ */
+rt_si32 capt_cmp(rt_si32 index)
+{
+    rt_si32 ret = 0;
+
+#if RT_EMBED_FILEIO == 0
+
+    rt_si32 i, j;
+    rt_ui32 *f = scene->get_frame();
+
+    if (scene->capt_frame(index) == 0 || pfm->write_capt() != 0)
+    {
+        if (!l_mode) RT_LOGI("Frame capture failed\n");
+        return 1;
+    }
+
+    /* captured image is loaded relative to textures' path */
+    rt_char name[] = "../../dump/scrXXX.bmp";
+    name[16] = '0' + (index / 1 % 10);
+    name[15] = '0' + (index / 10 % 10);
+    name[14] = '0' + (index / 100 % 10);
+
+    rt_Heap *hp = new rt_Heap(sys_alloc, sys_free);
+    rt_TEX tx;
+    load_image(hp, name, &tx);
+
+    for (j = 0; j < y_res; j++)
+    {
+        for (i = 0; i < x_res; i++)
+        {
+            rt_ui32 p = ((rt_ui32 *)tx.ptex)[j*x_res + i];
+
+            if (((p ^ f[j*x_row + i]) & 0x00FFFFFF) != 0)
+            {
+                ret = 1;
+
+                if (!l_mode)
+                RT_LOGI("Capture differs (%06X %06X) at x = %d, y = %d\n",
+                    p & 0x00FFFFFF, f[j*x_row + i] & 0x00FFFFFF, i, j);
+
+                j = y_res - 1;
+                break;
+            }
+        }
+    }
+
+    delete hp;
+
+#endif /* RT_EMBED_FILEIO */
+
+    return ret;
+}
+
+/*
+ * Save reservations of per-frame pools before the last frame.
+ */
+rt_void pool_get()
+{
+    rt_si32 i;
+
+    for (i = -1; i < m_thnum; i++)
+    {
+        m_size[i + 1] = scene->get_msize(i);
+    }
+}
+
+/*
+ * Check that per-frame pools with chunks of their own don't hold
+ * more than twice their reservations (plus chunk's granularity),
+ * as chunks are returned to the system once reservations shrink.
+ */
+rt_si32 pool_cmp()
+{
+    rt_si32 i, ret = 0;
+
+    for (i = -1; i < m_thnum; i++)
+    {
+        rt_ui32 c = scene->get_mchunk(i);
+
+        if (c > m_size[i + 1] * 2 + RT_CHUNK_SIZE)
+        {
+            ret = 1;
+
+            if (!l_mode)
+            RT_LOGI("Pool chunk oversized (%d > 2 * %d) in thread %d\n",
+                                                c, m_size[i + 1], i);
+        }
+    }
+
+    return ret;
+}
+
 /*
  * Compare frames.
  */
@@ -181,11 +732,6 @@ rt_void frame_max(rt_ui32 *fd)
     }
 }
 
-/*
- * Common instance of platform container.
- */
-rt_Platform pfm(sys_alloc, sys_free);
-
 /******************************************************************************/
 /*******************************   SUB TEST  1   ******************************/
 /******************************************************************************/
@@ -196,8 +742,8 @@ rt_Platform pfm(sys_alloc, sys_free);
 
 rt_void o_test01()
 {
-    scene = new(&pfm) rt_Scene(&scn_test01::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test01::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  1 */
@@ -212,8 +758,8 @@ rt_void o_test01()
 
 rt_void o_test02()
 {
-    scene = new(&pfm) rt_Scene(&scn_test02::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test02::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  2 */
@@ -228,8 +774,8 @@ rt_void o_test02()
 
 rt_void o_test03()
 {
-    scene = new(&pfm) rt_Scene(&scn_test03::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test03::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  3 */
@@ -244,8 +790,8 @@ rt_void o_test03()
 
 rt_void o_test04()
 {
-    scene = new(&pfm) rt_Scene(&scn_test04::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test04::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  4 */
@@ -260,8 +806,8 @@ rt_void o_test04()
 
 rt_void o_test05()
 {
-    scene = new(&pfm) rt_Scene(&scn_test05::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test05::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  5 */
@@ -276,8 +822,8 @@ rt_void o_test05()
 
 rt_void o_test06()
 {
-    scene = new(&pfm) rt_Scene(&scn_test06::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test06::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  6 */
@@ -292,8 +838,8 @@ rt_void o_test06()
 
 rt_void o_test07()
 {
-    scene = new(&pfm) rt_Scene(&scn_test07::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test07::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  7 */
@@ -308,8 +854,8 @@ rt_void o_test07()
 
 rt_void o_test08()
 {
-    scene = new(&pfm) rt_Scene(&scn_test08::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test08::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  8 */
@@ -324,8 +870,8 @@ rt_void o_test08()
 
 rt_void o_test09()
 {
-    scene = new(&pfm) rt_Scene(&scn_test09::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test09::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST  9 */
@@ -340,8 +886,8 @@ rt_void o_test09()
 
 rt_void o_test10()
 {
-    scene = new(&pfm) rt_Scene(&scn_test10::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test10::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 10 */
@@ -356,8 +902,8 @@ rt_void o_test10()
 
 rt_void o_test11()
 {
-    scene = new(&pfm) rt_Scene(&scn_test11::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test11::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 11 */
@@ -372,8 +918,8 @@ rt_void o_test11()
 
 rt_void o_test12()
 {
-    scene = new(&pfm) rt_Scene(&scn_test12::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test12::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 12 */
@@ -388,8 +934,8 @@ rt_void o_test12()
 
 rt_void o_test13()
 {
-    scene = new(&pfm) rt_Scene(&scn_test13::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test13::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 13 */
@@ -404,8 +950,8 @@ rt_void o_test13()
 
 rt_void o_test14()
 {
-    scene = new(&pfm) rt_Scene(&scn_test14::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test14::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 14 */
@@ -420,8 +966,8 @@ rt_void o_test14()
 
 rt_void o_test15()
 {
-    scene = new(&pfm) rt_Scene(&scn_test15::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test15::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 15 */
@@ -436,8 +982,8 @@ rt_void o_test15()
 
 rt_void o_test16()
 {
-    scene = new(&pfm) rt_Scene(&scn_test16::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test16::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 16 */
@@ -452,8 +998,8 @@ rt_void o_test16()
 
 rt_void o_test17()
 {
-    scene = new(&pfm) rt_Scene(&scn_test17::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test17::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 17 */
@@ -468,8 +1014,8 @@ rt_void o_test17()
 
 rt_void o_test18()
 {
-    scene = new(&pfm) rt_Scene(&scn_test18::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = new(pfm) rt_Scene(mode_scn(&scn_test18::sc_root),
+                              x_res, y_res, x_row, RT_NULL, pfm);
 }
 
 #endif /* SUB_TEST 18 */
@@ -587,6 +1133,8 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -y n, override y-resolution, where new y-value <= 65535\n");
         RT_LOGI(" -d n, override diff-threshold for qualification, n >= 0\n");
         RT_LOGI(" -c n, override counter of redundant test cycles, n >= 1\n");
+        RT_LOGI(" -m n, override render mode of test runs, n is 0..16\n");
+        RT_LOGI(" -j n, specify # of render threads in test runs, 1..64\n");
         RT_LOGI(" -i n, append image-idx within imaging mode, 0 <= n <= 9\n");
         RT_LOGI(" -v, enable verbose mode, print all pixel spots (> diff)\n");
         RT_LOGI(" -p, enable pixhunt mode, print isolated pixels (> diff)\n");
@@ -595,6 +1143,7 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -l, enable log-off mode, no printing to file and screen\n");
         RT_LOGI(" -o, enable optimal mode, omit unoptimized rendering run\n");
         RT_LOGI(" -q, enable quality mode, activate path-tracing lighting\n");
+        RT_LOGI(" -u, enable autotune mode, time tile sizes for each test\n");
         RT_LOGI(" -a, enable 4x antialiasing by default, 8x not supported\n");
         RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
         RT_LOGI(" -t tex1 tex2 texn, convert images in data/textures/tex*\n");
@@ -606,12 +1155,14 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     if (argc >= 2 && strcmp(argv[1], "-z") == 0)
     {
         if (!l_mode) RT_LOGI("Plotting samples/functions: ");
+        pfm = new rt_Platform(sys_alloc, sys_free);
         o_test[0]();
         scene->plot_frags();
         scene->plot_funcs();
         scene->plot_trigs();
         delete scene;
         scene = RT_NULL;
+        delete pfm;
         if (!l_mode) RT_LOGI("Done!\n");
         return 0;
     }
@@ -838,6 +1389,40 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
                 return 0;
             }
         }
+        if (k < argc && strcmp(argv[k], "-m") == 0 && ++k < argc)
+        {
+            for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
+            {
+                t += (argv[k][l-1] - '0') * r;
+            }
+            if (t >= 0 && t <= 16)
+            {
+                if (!l_mode) RT_LOGI("Render mode overridden: %d\n", t);
+                m_mode = t;
+            }
+            else
+            {
+                if (!l_mode) RT_LOGI("Render mode value out of range\n");
+                return 0;
+            }
+        }
+        if (k < argc && strcmp(argv[k], "-j") == 0 && ++k < argc)
+        {
+            for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
+            {
+                t += (argv[k][l-1] - '0') * r;
+            }
+            if (t >= 1 && t <= 64)
+            {
+                if (!l_mode) RT_LOGI("Threads number overridden: %d\n", t);
+                j_size = t;
+            }
+            else
+            {
+                if (!l_mode) RT_LOGI("Threads number value out of range\n");
+                return 0;
+            }
+        }
         if (k < argc && strcmp(argv[k], "-v") == 0 && !v_mode)
         {
             v_mode = RT_TRUE;
@@ -876,6 +1461,11 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
             o_mode = RT_TRUE;
             if (!l_mode) RT_LOGI("Optimal mode enabled: %d\n", o_mode);
         }
+        if (k < argc && strcmp(argv[k], "-u") == 0 && !u_mode)
+        {
+            u_mode = RT_TRUE;
+            if (!l_mode) RT_LOGI("Autotune mode enabled: %d\n", u_mode);
+        }
         if (k < argc && strcmp(argv[k], "-q") == 0 && !q_mode)
         {
             q_mode = RT_TRUE;
@@ -925,17 +1515,36 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     y_res = y_res * (w_size != 0 ? w_size : 1);
     x_row = (x_res+RT_SIMD_WIDTH-1) & ~(RT_SIMD_WIDTH-1);
 
+    /* left and right quarters apart, spans of the same rows */
+    m_rect[0] = x_res * 1 / 8;  m_rect[1] = y_res * 1 / 4;
+    m_rect[2] = x_res * 3 / 8;  m_rect[3] = y_res * 3 / 4;
+    m_rect[4] = x_res * 5 / 8;  m_rect[5] = y_res * 1 / 4;
+    m_rect[6] = x_res * 7 / 8;  m_rect[7] = y_res * 3 / 4;
+
+    /* single-threaded runs use platform's sequential stubs */
+    if (j_size > 1)
+    {
+        pfm = new rt_Platform(sys_alloc, sys_free, j_size,
+                              init_threads, term_threads,
+                              update_scene, render_scene);
+    }
+    else
+    {
+        pfm = new rt_Platform(sys_alloc, sys_free);
+    }
+
     rt_si32 tile_w = 0;
     rt_si32 size, type, simd = 0;
 
-    simd = (&pfm)->set_simd(simd_init(n_simd, s_type, k_size));
-    if (a_mode != (&pfm)->set_fsaa(a_mode))
+    simd = pfm->set_simd(simd_init(n_simd, s_type, k_size));
+    if (a_mode != pfm->set_fsaa(a_mode))
     {
         if (!l_mode)
         RT_LOGI("Requested antialiasing mode not supported, check options\n");
+        delete pfm;
         return 0;
     }
-    tile_w = (&pfm)->get_tile_w();
+    tile_w = pfm->get_tile_w();
 
     size = (simd >> 16) & 0xFF;
     type = (simd >> 8) & 0xFF;
@@ -948,6 +1557,7 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     {
         if (!l_mode)
         RT_LOGI("Chosen SIMD target not supported, check -n/-k/-s options\n");
+        delete pfm;
         return 0;
     }
 
@@ -958,6 +1568,14 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
     frame = (rt_ui32 *)sys_alloc(x_row * y_res * sizeof(rt_ui32));
 
+    m_thnum = pfm->get_thnum();
+    m_size = (rt_ui32 *)sys_alloc((m_thnum + 1) * sizeof(rt_ui32));
+
+    if (m_mode == 13)
+    {
+        pfm->set_capt(1, x_res, y_res);
+    }
+
     if (!l_mode)
     {
         RT_LOGI("------------------  TARGET CONFIG  ---------------------\n");
@@ -980,30 +1598,54 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
                     i+1, RT_POINTER, RT_ADDRESS == 32 ? "_" : "f", RT_ELEMENT);
         try
         {
-            (&pfm)->set_simd(simd_init(n_simd, s_type, k_size));
-            a_mode = (&pfm)->get_fsaa();
+            /* restore antialiasing turned off in render mode 9 */
+            if (m_mode == 9)
+            {
+                pfm->set_fsaa(a_mode);
+            }
+
+            pfm->set_simd(simd_init(n_simd, s_type, k_size));
+            a_mode = pfm->get_fsaa();
 
             if (!o_mode)
             { /* -->---->-- skip run0 -->---->-- */
 
             /* ------------ test run0 ---------- */
 
+            m_varr = RT_FALSE;
             o_test[i]();
 
-            scene->set_opts(RT_OPTS_NONE);
+            scene->set_opts(m_mode != 0 ? RT_OPTS_FULL : RT_OPTS_NONE);
             q_test = scene->set_pton(q_mode);
 
+            mode_set(0);
+
             time1 = get_time();
 
             for (j = 0; j < r_test; j++)
             {
-                scene->render(q_test ? 0 : j * f_time);
+                if (j == r_test - 1)
+                {
+                    pool_get();
+                }
+
+                mode_run(0, q_test ? 0 : j * f_time);
             }
 
             time2 = get_time();
             tN = time2 - time1;
             if (!l_mode) RT_LOGI("Time N   = %6d\n", (rt_si32)tN);
 
+            for (k = 0; k < RT_STAT_NUM; k++)
+            {
+                m_stat[k] = scene->get_stat(k);
+            }
+
+            if (r_test > 0)
+            {
+                pool_cmp();
+            }
+
             if (h_mode)
             {
                 scene->render_num(x_res-30, 10, -1, 2, 0);
@@ -1028,16 +1670,48 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             /* ------------ test run1 ---------- */
 
+            m_varr = m_mode == 15;
             o_test[i]();
 
-            scene->set_opts(RT_OPTS_FULL);
+            scene->set_opts(m_mode == 4 ? RT_OPTS_FULL | RT_OPTS_STATIC :
+                                          RT_OPTS_FULL);
             q_test = scene->set_pton(q_mode);
 
+            mode_set(1);
+
+            /* pair test's scene with the next test's scene */
+            if (m_mode == 6)
+            {
+                m_pair = scene;
+                o_test[(i + 1) % SUB_TEST]();
+                rt_Scene *scn = scene;
+                scene = m_pair;
+                m_pair = scn;
+
+                m_pair->set_opts(scene->get_opts());
+                m_pair->set_pton(q_mode);
+            }
+
+            if (u_mode)
+            {
+                pfm->tune_tile(scene, 0, get_time);
+                tile_w = pfm->get_tile_w();
+                if (!l_mode) RT_LOGI("Tile W/H = %2d/%2d\n",
+                                     tile_w, pfm->get_tile_h());
+            }
+
             time1 = get_time();
 
             for (j = 0; j < r_test; j++)
             {
-                scene->render(q_test ? 0 : j * f_time);
+                mode_run(1, q_test ? 0 : j * f_time);
+            }
+
+            /* render the last frame pending in the pipeline,
+             * path-tracer's frames are rendered in place */
+            if (m_mode == 14 && !q_test)
+            {
+                pfm->render_pipe(scene, (r_test - 1) * f_time);
             }
 
             time2 = get_time();
@@ -1062,8 +1736,34 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
             if (!o_mode)
             { /* -->---->-- skip diff -->---->-- */
 
+            if (m_mode == 1)
+            {
+                frame_roi(scene->get_frame(), frame);
+            }
+            if (m_mode == 7)
+            {
+                frame_cbrd(scene->get_frame(), frame);
+            }
+            if (m_mode == 16)
+            {
+                frame_rate(scene->get_frame(), frame);
+            }
+
             frame_cmp(frame, scene->get_frame());
 
+            if (m_mode == 11)
+            {
+                tmrs_cmp();
+            }
+            if (m_mode == 12)
+            {
+                stat_cmp();
+            }
+            if (m_mode == 13)
+            {
+                capt_cmp((i+1) * 10 + 4);
+            }
+
             /* ------------ test diff ---------- */
 
             frame_dff(scene->get_frame(), frame);
@@ -1080,12 +1780,25 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             } /* --<----<-- skip diff --<----<-- */
 
+            if (m_pair != RT_NULL)
+            {
+                delete m_pair;
+                m_pair = RT_NULL;
+            }
+
             delete scene;
             scene = RT_NULL;
         }
         catch (rt_Exception e)
         {
             if (!l_mode) RT_LOGE("Exception in test %d: %s\n", i+1, e.err);
+
+            /* release paired scene's data for its own test */
+            if (m_pair != RT_NULL)
+            {
+                delete m_pair;
+                m_pair = RT_NULL;
+            }
         }
         if (!l_mode)
         RT_LOGI("--%s%s%s------------------------------- simd = %4dx%dv%d -\n",
@@ -1093,8 +1806,11 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
                             q_test ? "q " : "--", n_simd * 128, k_size, s_type);
     }
 
+    sys_free(m_size, (m_thnum + 1) * sizeof(rt_ui32));
     sys_free(frame, x_row * y_res * sizeof(rt_ui32));
 
+    delete pfm;
+
 #if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
 
     if (!l_mode)
@@ -1135,6 +1851,9 @@ rt_byte *s_ptr = RT_ADDRESS_MIN;
 
 #include <windows.h>
 
+CRITICAL_SECTION critSec;
+rt_bool critInit = RT_FALSE;
+
 /*
  * Get system time in milliseconds.
  */
@@ -1153,10 +1872,18 @@ SYSTEM_INFO s_sys = {0};
 
 /*
  * Allocate memory from system heap.
- * Not thread-safe due to common static ptr.
  */
 rt_pntr sys_alloc(rt_size size)
 {
+    /* first call comes from main thread before worker-threads start */
+    if (!critInit)
+    {
+        InitializeCriticalSection(&critSec);
+        critInit = RT_TRUE;
+    }
+
+    EnterCriticalSection(&critSec);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     /* loop around RT_ADDRESS_MAX boundary */
@@ -1190,6 +1917,8 @@ rt_pntr sys_alloc(rt_size size)
 
 #endif /* RT_DEBUG */
 
+    LeaveCriticalSection(&critSec);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
@@ -1212,6 +1941,8 @@ rt_pntr sys_alloc(rt_size size)
  */
 rt_void sys_free(rt_pntr ptr, rt_size size)
 {
+    EnterCriticalSection(&critSec);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     VirtualFree(ptr, 0, MEM_RELEASE);
@@ -1228,11 +1959,206 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
     RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
 
 #endif /* RT_DEBUG */
+
+    LeaveCriticalSection(&critSec);
+}
+
+/******************************************************************************/
+
+/* platform-specific pool
+ * of "thnum" threads */
+struct rt_THREAD_POOL
+{
+    rt_Platform        *pfm;
+    rt_si32             cmd; /* 0 - quit, 1 - update, 2 - render */
+    rt_si32             thnum;
+    rt_pstr             estr; /* first exception in current run */
+    HANDLE             *pthr;
+    HANDLE             *wevent; /* per-thr wrkr-events */
+    HANDLE             *cevent; /* per-thr ctl-events */
+};
+
+/* platform-specific thread */
+struct rt_THREAD
+{
+    rt_THREAD_POOL     *tpool;
+    rt_si32             index;
+};
+
+/*
+ * Worker thread's entry point.
+ */
+DWORD WINAPI worker_thread(rt_pntr p)
+{
+    rt_THREAD *thread = (rt_THREAD *)p;
+    rt_THREAD_POOL *tpool = thread->tpool;
+    rt_si32 ti = thread->index;
+
+    while (1)
+    {
+        /* every worker-thread waits signal from main thread */
+        WaitForSingleObject(tpool->wevent[ti], INFINITE);
+
+        rt_si32 cmd = tpool->cmd;
+
+        if (cmd == 0)
+        {
+            break;
+        }
+
+        try
+        {
+            rt_Scene *scene = tpool->pfm->get_cur_scene();
+
+            switch (cmd & 0x3)
+            {
+                case 1:
+                scene->update_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                case 2:
+                scene->render_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                default:
+                break;
+            };
+        }
+        catch (rt_Exception e)
+        {
+            EnterCriticalSection(&critSec);
+            if (tpool->estr == RT_NULL)
+            {
+                tpool->estr = e.err;
+            }
+            LeaveCriticalSection(&critSec);
+        }
+
+        /* every worker-thread signals to main thread when done */
+        SetEvent(tpool->cevent[ti]);
+    }
+
+    delete thread;
+
+    return 0;
+}
+
+/*
+ * Signal all worker-threads with "cmd", block until finished,
+ * rethrow the first exception caught in worker-threads.
+ */
+static
+rt_void run_threads(rt_THREAD_POOL *tpool, rt_si32 cmd)
+{
+    rt_si32 i;
+
+    tpool->cmd = cmd;
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        SetEvent(tpool->wevent[i]);
+    }
+
+    if (cmd == 0)
+    {
+        WaitForMultipleObjects(tpool->thnum, tpool->pthr, TRUE, INFINITE);
+        return;
+    }
+
+    WaitForMultipleObjects(tpool->thnum, tpool->cevent, TRUE, INFINITE);
+
+    if (tpool->estr != RT_NULL)
+    {
+        rt_pstr estr = tpool->estr;
+        tpool->estr = RT_NULL;
+        throw rt_Exception(estr);
+    }
+}
+
+/*
+ * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ */
+rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
+{
+    rt_si32 i;
+
+    /* no feedback, the number of threads is fixed from command-line */
+    thnum = thnum < 0 ? -thnum : thnum;
+
+    rt_THREAD_POOL *tpool = new rt_THREAD_POOL;
+
+    tpool->pfm = pfm;
+    tpool->cmd = 0;
+    tpool->thnum = thnum;
+    tpool->estr = RT_NULL;
+    tpool->pthr = new HANDLE[thnum];
+    tpool->wevent = new HANDLE[thnum];
+    tpool->cevent = new HANDLE[thnum];
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_THREAD *thread = new rt_THREAD;
+
+        thread->tpool = tpool;
+        thread->index = i;
+
+        tpool->wevent[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+        tpool->cevent[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+        tpool->pthr[i]   = CreateThread(NULL, 0, worker_thread,
+                                        thread, 0, NULL);
+    }
+
+    return tpool;
+}
+
+/*
+ * Terminate platform-specific pool of "thnum" threads.
+ */
+rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
+{
+    rt_si32 i;
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to terminate, wait for exit */
+    run_threads(tpool, 0);
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        CloseHandle(tpool->pthr[i]);
+        CloseHandle(tpool->wevent[i]);
+        CloseHandle(tpool->cevent[i]);
+    }
+
+    delete [] tpool->pthr;
+    delete [] tpool->wevent;
+    delete [] tpool->cevent;
+    delete tpool;
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    run_threads((rt_THREAD_POOL *)tdata, 1 | ((phase & 0xFF) << 2));
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    run_threads((rt_THREAD_POOL *)tdata, 2 | ((phase & 0xFF) << 2));
 }
 
 #elif (defined RT_LINUX) /* Linux, GCC -------------------------------------- */
 
 #include <sys/time.h>
+#include <pthread.h>
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * Get system time in milliseconds.
@@ -1256,10 +2182,11 @@ rt_time get_time()
 
 /*
  * Allocate memory from system heap.
- * Not thread-safe due to common static ptr.
  */
 rt_pntr sys_alloc(rt_size size)
 {
+    pthread_mutex_lock(&mutex);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     /* loop around RT_ADDRESS_MAX boundary */
@@ -1291,6 +2218,8 @@ rt_pntr sys_alloc(rt_size size)
 
 #endif /* RT_DEBUG */
 
+    pthread_mutex_unlock(&mutex);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
@@ -1313,6 +2242,8 @@ rt_pntr sys_alloc(rt_size size)
  */
 rt_void sys_free(rt_pntr ptr, rt_size size)
 {
+    pthread_mutex_lock(&mutex);
+
 #if (RT_POINTER - RT_ADDRESS) != 0
 
     munmap(ptr, size);
@@ -1329,6 +2260,213 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
     RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
 
 #endif /* RT_DEBUG */
+
+    pthread_mutex_unlock(&mutex);
+}
+
+/******************************************************************************/
+
+/* platform-specific pool
+ * of "thnum" threads */
+struct rt_THREAD_POOL
+{
+    rt_Platform        *pfm;
+    rt_si32             cmd; /* 0 - quit, 1 - update, 2 - render */
+    rt_si32             thnum;
+    rt_si32             tick; /* index of current run */
+    rt_si32             done; /* threads done in current run */
+    rt_pstr             estr; /* first exception in current run */
+    pthread_t          *pthr;
+    pthread_cond_t      cond[2]; /* 0 - run started, 1 - run done */
+};
+
+/* platform-specific thread */
+struct rt_THREAD
+{
+    rt_THREAD_POOL     *tpool;
+    rt_si32             index;
+};
+
+/*
+ * Worker thread's entry point.
+ */
+rt_pntr worker_thread(rt_pntr p)
+{
+    rt_THREAD *thread = (rt_THREAD *)p;
+    rt_THREAD_POOL *tpool = thread->tpool;
+    rt_si32 ti = thread->index, tick = 0;
+
+    pthread_mutex_lock(&mutex);
+
+    while (1)
+    {
+        /* every worker-thread waits signal from main thread */
+        while (tpool->tick == tick)
+        {
+            pthread_cond_wait(&tpool->cond[0], &mutex);
+        }
+
+        tick = tpool->tick;
+        rt_si32 cmd = tpool->cmd;
+
+        if (cmd == 0)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&mutex);
+
+        rt_pstr estr = RT_NULL;
+
+        try
+        {
+            rt_Scene *scene = tpool->pfm->get_cur_scene();
+
+            switch (cmd & 0x3)
+            {
+                case 1:
+                scene->update_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                case 2:
+                scene->render_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                default:
+                break;
+            };
+        }
+        catch (rt_Exception e)
+        {
+            estr = e.err;
+        }
+
+        pthread_mutex_lock(&mutex);
+
+        if (tpool->estr == RT_NULL)
+        {
+            tpool->estr = estr;
+        }
+
+        /* last worker-thread signals to main thread when done */
+        tpool->done++;
+        if (tpool->done == tpool->thnum)
+        {
+            pthread_cond_signal(&tpool->cond[1]);
+        }
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    delete thread;
+
+    return RT_NULL;
+}
+
+/*
+ * Signal all worker-threads with "cmd", block until finished,
+ * rethrow the first exception caught in worker-threads.
+ */
+static
+rt_void run_threads(rt_THREAD_POOL *tpool, rt_si32 cmd)
+{
+    pthread_mutex_lock(&mutex);
+
+    tpool->cmd = cmd;
+    tpool->done = 0;
+    tpool->tick++;
+    pthread_cond_broadcast(&tpool->cond[0]);
+
+    while (cmd != 0 && tpool->done < tpool->thnum)
+    {
+        pthread_cond_wait(&tpool->cond[1], &mutex);
+    }
+
+    rt_pstr estr = tpool->estr;
+    tpool->estr = RT_NULL;
+
+    pthread_mutex_unlock(&mutex);
+
+    if (estr != RT_NULL)
+    {
+        throw rt_Exception(estr);
+    }
+}
+
+/*
+ * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ */
+rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
+{
+    rt_si32 i;
+
+    /* no feedback, the number of threads is fixed from command-line */
+    thnum = thnum < 0 ? -thnum : thnum;
+
+    rt_THREAD_POOL *tpool = new rt_THREAD_POOL;
+
+    tpool->pfm = pfm;
+    tpool->cmd = 0;
+    tpool->thnum = thnum;
+    tpool->tick = 0;
+    tpool->done = 0;
+    tpool->estr = RT_NULL;
+    tpool->pthr = new pthread_t[thnum];
+
+    pthread_cond_init(&tpool->cond[0], NULL);
+    pthread_cond_init(&tpool->cond[1], NULL);
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_THREAD *thread = new rt_THREAD;
+
+        thread->tpool = tpool;
+        thread->index = i;
+        pthread_create(&tpool->pthr[i], NULL, worker_thread, thread);
+    }
+
+    return tpool;
+}
+
+/*
+ * Terminate platform-specific pool of "thnum" threads.
+ */
+rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
+{
+    rt_si32 i;
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to terminate */
+    run_threads(tpool, 0);
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        pthread_join(tpool->pthr[i], NULL);
+    }
+
+    pthread_cond_destroy(&tpool->cond[0]);
+    pthread_cond_destroy(&tpool->cond[1]);
+
+    delete [] tpool->pthr;
+    delete tpool;
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    run_threads((rt_THREAD_POOL *)tdata, 1 | ((phase & 0xFF) << 2));
+}
+
+/*
+ * Task platform-specific pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    run_threads((rt_THREAD_POOL *)tdata, 2 | ((phase & 0xFF) << 2));
 }
 
 #endif /* ------------- OS specific ----------------------------------------- */